@@ -0,0 +1,941 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <random>
+#include <sstream>
+
+// Option pricing headers
+#include "src/option_pricing/vanilla/vanilla_option.h"
+#include "src/option_pricing/vanilla/black_scholes.h"
+#include "src/option_pricing/vanilla/payoff.h"
+#include "src/option_pricing/exotic/asian.h"
+#include "src/option_pricing/exotic/asian_policy.h"
+#include "src/option_pricing/exotic/digital.h"
+#include "src/option_pricing/exotic/asian_approximation.h"
+#include "src/option_pricing/monte_carlo/path_generation.h"
+
+// Math library headers
+#include "src/math/statistics/statistics.h"
+#include "src/math/statistics/accumulators.h"
+
+// Implied volatility headers
+#include "src/implied_volatility/interval_bisection.h"
+#include "src/implied_volatility/newton_raphson.h"
+
+#include "src/benchmark/micro_benchmark.h"
+#include "src/benchmark/golden_values.h"
+#include "src/simd/simd_kernels.h"
+
+using namespace std;
+
+// Accuracy regression harness. Usage:
+//   ./accuracy [results.json]
+// Every implementation of a kernel is checked against the golden values in
+// src/benchmark/golden_values.h and timed with MicroBenchmark, giving one
+// error-versus-speed row per implementation. Exits with status 1 if any
+// implementation is outside its tolerance.
+
+struct AccuracyResult {
+    string kernel;
+    string implementation;
+    double max_abs_error;
+    double max_rel_error;
+    double tolerance;  // On max_abs_error
+    double ns_per_op;
+    bool passed;
+};
+
+class AccuracyReport {
+private:
+    vector<AccuracyResult> results;
+
+public:
+    void add(const string& kernel, const string& implementation, double max_abs_error,
+             double max_rel_error, double tolerance, const BenchmarkResult* timing) {
+        AccuracyResult r;
+        r.kernel = kernel;
+        r.implementation = implementation;
+        r.max_abs_error = max_abs_error;
+        r.max_rel_error = max_rel_error;
+        r.tolerance = tolerance;
+        r.ns_per_op = timing ? timing->median_ns : 0.0;
+        r.passed = max_abs_error <= tolerance;  // NaN errors fail
+        results.push_back(r);
+
+        cout << "  " << left << setw(16) << kernel << setw(34) << implementation << right
+             << scientific << setprecision(2) << setw(11) << max_abs_error << setw(11) << max_rel_error
+             << setw(11) << tolerance << fixed << setprecision(1) << setw(11) << r.ns_per_op
+             << "   " << (r.passed ? "ok" : "FAIL") << endl;
+    }
+
+    size_t num_failed() const {
+        size_t n = 0;
+        for (const AccuracyResult& r : results) n += r.passed ? 0 : 1;
+        return n;
+    }
+
+    bool write_json(const string& path) const {
+        ofstream out(path);
+        if (!out) {
+            cerr << "Cannot write accuracy results to " << path << "." << endl;
+            return false;
+        }
+        out << "{\n  \"compiler\": \"" << MICRO_BENCHMARK_COMPILER << "\",\n  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const AccuracyResult& r = results[i];
+            out << "    {\"kernel\": \"" << r.kernel << "\", \"implementation\": \"" << r.implementation
+                << "\", \"max_abs_error\": " << scientific << setprecision(3) << r.max_abs_error
+                << ", \"max_rel_error\": " << r.max_rel_error << ", \"tolerance\": " << r.tolerance
+                << ", \"ns_per_op\": " << fixed << setprecision(2) << r.ns_per_op
+                << ", \"passed\": " << (r.passed ? "true" : "false") << "}"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+};
+
+// Largest absolute and relative error of computed values against references
+struct ErrorStats {
+    double max_abs;
+    double max_rel;
+
+    ErrorStats() : max_abs(0.0), max_rel(0.0) {}
+
+    // A NaN result (e.g. a solver that failed) makes the whole row NaN
+    void add(double value, double reference, double scale = 1.0) {
+        double err = fabs(value - reference);
+        if (std::isnan(err) || std::isnan(max_abs)) {
+            max_abs = max_rel = err + max_abs;
+            return;
+        }
+        max_abs = max(max_abs, err / scale);
+        if (reference != 0.0) max_rel = max(max_rel, err / fabs(reference));
+    }
+};
+
+// Price as a function of volatility, for interval_bisection
+class PriceFunctor {
+public:
+    bool is_call;
+    double K, r, T, S;
+    PriceFunctor(bool _is_call, double _K, double _r, double _T, double _S)
+        : is_call(_is_call), K(_K), r(_r), T(_T), S(_S) {}
+
+    double operator()(double sigma) const {
+        VanillaOption opt(K, r, T, S, sigma);
+        return is_call ? opt.calc_call_price() : opt.calc_put_price();
+    }
+};
+
+void check_normal_cdf(MicroBenchmark& bench, AccuracyReport& report) {
+    const GoldenNormal* g = GOLDEN_NORMAL_CDF;
+    const size_t n = NUM_GOLDEN_NORMAL_CDF;
+    StandardNormalDistribution snd;
+
+    // Abramowitz & Stegun 26.2.17 has absolute error below 7.5e-8
+    ErrorStats as_n, as_cdf, erfc_cdf;
+    for (size_t i = 0; i < n; i++) {
+        as_n.add(N(g[i].x), g[i].value);
+        as_cdf.add(snd.cdf(g[i].x), g[i].value);
+        erfc_cdf.add(0.5 * erfc(-g[i].x / sqrt(2.0)), g[i].value);
+    }
+
+    report.add("normal cdf", "N() (A&S 26.2.17)", as_n.max_abs, as_n.max_rel, 1e-7,
+               bench.run("N", n, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n; i++) s += N(g[i].x);
+                   return s;
+               }));
+    report.add("normal cdf", "StandardNormalDistribution::cdf", as_cdf.max_abs, as_cdf.max_rel, 1e-7,
+               bench.run("StandardNormalDistribution::cdf", n, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n; i++) s += snd.cdf(g[i].x);
+                   return s;
+               }));
+    report.add("normal cdf", "0.5 erfc(-x/sqrt 2) (reference)", erfc_cdf.max_abs, erfc_cdf.max_rel, 1e-15,
+               bench.run("erfc", n, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n; i++) s += 0.5 * erfc(-g[i].x / sqrt(2.0));
+                   return s;
+               }));
+}
+
+void check_normal_inv_cdf(MicroBenchmark& bench, AccuracyReport& report) {
+    const GoldenNormal* g = GOLDEN_NORMAL_INV_CDF;
+    const size_t n = NUM_GOLDEN_NORMAL_INV_CDF;
+    StandardNormalDistribution snd;
+
+    vector<double> u(n), z(n);
+    for (size_t i = 0; i < n; i++) u[i] = g[i].x;
+
+    // The scalar Beasley-Springer-Moro routine reflects p < 0.5 through 1 - p,
+    // which loses the digits of very small p, so it is only checked on
+    // [1e-10, 1 - 1e-10]
+    ErrorStats moro, acklam, as241;
+    for (size_t i = 0; i < n; i++) {
+        if (min(u[i], 1.0 - u[i]) >= 1e-10) moro.add(snd.inv_cdf(u[i]), g[i].value);
+    }
+    snd.inv_cdf(&u[0], &z[0], n, INV_CDF_ACKLAM);
+    for (size_t i = 0; i < n; i++) acklam.add(z[i], g[i].value);
+    snd.inv_cdf(&u[0], &z[0], n, INV_CDF_AS241);
+    for (size_t i = 0; i < n; i++) as241.add(z[i], g[i].value);
+
+    report.add("normal inv cdf", "inv_cdf scalar (Moro)", moro.max_abs, moro.max_rel, 2e-8,
+               bench.run("inv_cdf scalar", n, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n; i++) s += snd.inv_cdf(u[i]);
+                   return s;
+               }));
+    report.add("normal inv cdf", "inv_cdf batch Acklam", acklam.max_abs, acklam.max_rel, 1e-8,
+               bench.run("inv_cdf batch Acklam", n, [&]() {
+                   snd.inv_cdf(&u[0], &z[0], n, INV_CDF_ACKLAM);
+                   return z[n / 3];
+               }));
+    report.add("normal inv cdf", "inv_cdf batch AS241", as241.max_abs, as241.max_rel, 1e-14,
+               bench.run("inv_cdf batch AS241", n, [&]() {
+                   snd.inv_cdf(&u[0], &z[0], n, INV_CDF_AS241);
+                   return z[n / 3];
+               }));
+}
+
+// Money-valued results (price, vega, theta, rho) are compared per unit of
+// spot and gamma is multiplied by spot, so one tolerance covers the SPX-sized
+// cases as well as the textbook ones
+void check_black_scholes(MicroBenchmark& bench, AccuracyReport& report) {
+    const GoldenBlackScholes* g = GOLDEN_BLACK_SCHOLES;
+    const size_t n = NUM_GOLDEN_BLACK_SCHOLES;
+
+    vector<double> phi(n), S(n), K(n), r(n), T(n), sigma(n), price(n);
+    for (size_t i = 0; i < n; i++) {
+        phi[i] = g[i].is_call ? 1.0 : -1.0;
+        S[i] = g[i].S; K[i] = g[i].K; r[i] = g[i].r; T[i] = g[i].T; sigma[i] = g[i].sigma;
+    }
+    calc_black_scholes_prices(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], &price[0], n);
+
+    ErrorStats vanilla, pricer, batch, greeks_price, delta, gamma, vega, theta, rho;
+    for (size_t i = 0; i < n; i++) {
+        VanillaOption opt(g[i].K, g[i].r, g[i].T, g[i].S, g[i].sigma);
+        vanilla.add(g[i].is_call ? opt.calc_call_price() : opt.calc_put_price(), g[i].price, g[i].S);
+        pricer.add(BlackScholesPricer(g[i].is_call, g[i].K, g[i].r, g[i].T, g[i].S).price(g[i].sigma), g[i].price, g[i].S);
+        batch.add(price[i], g[i].price, g[i].S);
+
+        BlackScholesGreeks b = calc_black_scholes_greeks(g[i].is_call, g[i].S, g[i].K, g[i].r, g[i].T, g[i].sigma);
+        greeks_price.add(b.price, g[i].price, g[i].S);
+        delta.add(b.delta, g[i].delta);
+        gamma.add(b.gamma * g[i].S, g[i].gamma * g[i].S);
+        vega.add(b.vega, g[i].vega, g[i].S);
+        theta.add(b.theta, g[i].theta, g[i].S);
+        rho.add(b.rho, g[i].rho, g[i].S);
+    }
+
+    const double tol = 2e-7;
+    report.add("bs price", "VanillaOption", vanilla.max_abs, vanilla.max_rel, tol,
+               bench.run("VanillaOption", n, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n; i++) {
+                       VanillaOption opt(g[i].K, g[i].r, g[i].T, g[i].S, g[i].sigma);
+                       s += g[i].is_call ? opt.calc_call_price() : opt.calc_put_price();
+                   }
+                   return s;
+               }));
+    report.add("bs price", "BlackScholesPricer::price", pricer.max_abs, pricer.max_rel, tol,
+               bench.run("BlackScholesPricer", n, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n; i++)
+                       s += BlackScholesPricer(g[i].is_call, g[i].K, g[i].r, g[i].T, g[i].S).price(g[i].sigma);
+                   return s;
+               }));
+    report.add("bs price", "calc_black_scholes_prices batch", batch.max_abs, batch.max_rel, tol,
+               bench.run("calc_black_scholes_prices", n, [&]() {
+                   calc_black_scholes_prices(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], &price[0], n);
+                   return price[n / 3];
+               }));
+    const BenchmarkResult* t = bench.run("calc_black_scholes_greeks", n, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < n; i++)
+            s += calc_black_scholes_greeks(g[i].is_call, g[i].S, g[i].K, g[i].r, g[i].T, g[i].sigma).gamma;
+        return s;
+    });
+    report.add("bs price", "calc_black_scholes_greeks", greeks_price.max_abs, greeks_price.max_rel, tol, t);
+    report.add("bs delta", "calc_black_scholes_greeks", delta.max_abs, delta.max_rel, tol, t);
+    report.add("bs gamma", "calc_black_scholes_greeks", gamma.max_abs, gamma.max_rel, tol, t);
+    report.add("bs vega", "calc_black_scholes_greeks", vega.max_abs, vega.max_rel, tol, t);
+    report.add("bs theta", "calc_black_scholes_greeks", theta.max_abs, theta.max_rel, tol, t);
+    report.add("bs rho", "calc_black_scholes_greeks", rho.max_abs, rho.max_rel, tol, t);
+}
+
+// All six Greeks into one error row, in units of the pay-off: price_scale is
+// 1 for unit cash and S for asset-or-nothing. Delta and gamma are scaled to
+// the change in value for a move of one spot
+template<typename Golden>
+void add_digital_greeks(ErrorStats& e, const BlackScholesGreeks& b, const Golden& g, double price_scale) {
+    e.add(b.price, g.price, price_scale);
+    e.add(b.delta * g.S, g.delta * g.S, price_scale);
+    e.add(b.gamma * g.S * g.S, g.gamma * g.S * g.S, price_scale);
+    e.add(b.vega, g.vega, price_scale);
+    e.add(b.theta, g.theta, price_scale);
+    e.add(b.rho, g.rho, price_scale);
+}
+
+void check_digitals(MicroBenchmark& bench, AccuracyReport& report) {
+    const GoldenBlackScholes* con = GOLDEN_CASH_OR_NOTHING;
+    const GoldenBlackScholes* aon = GOLDEN_ASSET_OR_NOTHING;
+    const GoldenBlackScholes* vanilla = GOLDEN_BLACK_SCHOLES;
+    const GoldenDoubleDigital* dd = GOLDEN_DOUBLE_DIGITAL;
+    const size_t n = NUM_GOLDEN_CASH_OR_NOTHING;
+    const size_t n_dd = NUM_GOLDEN_DOUBLE_DIGITAL;
+
+    vector<double> phi(n), S(n), K(n), r(n), T(n), sigma(n);
+    for (size_t i = 0; i < n; i++) {
+        phi[i] = con[i].is_call ? 1.0 : -1.0;
+        S[i] = con[i].S; K[i] = con[i].K; r[i] = con[i].r; T[i] = con[i].T; sigma[i] = con[i].sigma;
+    }
+    vector<double> dd_S(n_dd), dd_D(n_dd), dd_U(n_dd), dd_r(n_dd), dd_T(n_dd), dd_sigma(n_dd);
+    for (size_t i = 0; i < n_dd; i++) {
+        dd_S[i] = dd[i].S; dd_D[i] = dd[i].D; dd_U[i] = dd[i].U;
+        dd_r[i] = dd[i].r; dd_T[i] = dd[i].T; dd_sigma[i] = dd[i].sigma;
+    }
+    vector<double> price(n), delta(n), gamma(n), vega(n);
+
+    ErrorStats con_scalar, con_batch, aon_scalar, aon_batch, dd_scalar, dd_batch, parity;
+    for (size_t i = 0; i < n; i++) {
+        BlackScholesGreeks c = calc_cash_or_nothing_greeks(con[i].is_call, S[i], K[i], r[i], T[i], sigma[i]);
+        BlackScholesGreeks a = calc_asset_or_nothing_greeks(aon[i].is_call, S[i], K[i], r[i], T[i], sigma[i]);
+        add_digital_greeks(con_scalar, c, con[i], 1.0);
+        add_digital_greeks(aon_scalar, a, aon[i], S[i]);
+
+        // A vanilla is an asset-or-nothing less K cash-or-nothing, sign phi
+        parity.add(phi[i] * (a.price - K[i] * c.price), vanilla[i].price, S[i]);
+    }
+    for (size_t i = 0; i < n_dd; i++)
+        add_digital_greeks(dd_scalar, calc_double_digital_greeks(dd_S[i], dd_D[i], dd_U[i], dd_r[i], dd_T[i], dd_sigma[i]), dd[i], 1.0);
+
+    // The batch forms compute price, delta, gamma and vega
+    auto add_batch = [&](ErrorStats& e, const auto* g, size_t m, bool per_spot) {
+        for (size_t i = 0; i < m; i++) {
+            double scale = per_spot ? g[i].S : 1.0;
+            e.add(price[i], g[i].price, scale);
+            e.add(delta[i] * g[i].S, g[i].delta * g[i].S, scale);
+            e.add(gamma[i] * g[i].S * g[i].S, g[i].gamma * g[i].S * g[i].S, scale);
+            e.add(vega[i], g[i].vega, scale);
+        }
+    };
+    calc_cash_or_nothing_greeks(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], &price[0], &delta[0], &gamma[0], &vega[0], n);
+    add_batch(con_batch, con, n, false);
+    calc_asset_or_nothing_greeks(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], &price[0], &delta[0], &gamma[0], &vega[0], n);
+    add_batch(aon_batch, aon, n, true);
+    calc_double_digital_greeks(&dd_S[0], &dd_D[0], &dd_U[0], &dd_r[0], &dd_T[0], &dd_sigma[0],
+                               &price[0], &delta[0], &gamma[0], &vega[0], n_dd);
+    add_batch(dd_batch, dd, n_dd, false);
+
+    // Both sides evaluate N through erfc, so the remaining error is rounding
+    const double tol = 1e-12;
+    report.add("digital cash", "calc_cash_or_nothing_greeks", con_scalar.max_abs, con_scalar.max_rel, tol,
+               bench.run("calc_cash_or_nothing_greeks", n, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n; i++)
+                       s += calc_cash_or_nothing_greeks(con[i].is_call, S[i], K[i], r[i], T[i], sigma[i]).gamma;
+                   return s;
+               }));
+    report.add("digital cash", "calc_cash_or_nothing_greeks batch", con_batch.max_abs, con_batch.max_rel, tol,
+               bench.run("calc_cash_or_nothing_greeks batch", n, [&]() {
+                   calc_cash_or_nothing_greeks(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0],
+                                               &price[0], &delta[0], &gamma[0], &vega[0], n);
+                   return gamma[n / 3];
+               }));
+    report.add("digital asset", "calc_asset_or_nothing_greeks", aon_scalar.max_abs, aon_scalar.max_rel, tol,
+               bench.run("calc_asset_or_nothing_greeks", n, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n; i++)
+                       s += calc_asset_or_nothing_greeks(aon[i].is_call, S[i], K[i], r[i], T[i], sigma[i]).gamma;
+                   return s;
+               }));
+    report.add("digital asset", "calc_asset_or_nothing_greeks batch", aon_batch.max_abs, aon_batch.max_rel, tol,
+               bench.run("calc_asset_or_nothing_greeks batch", n, [&]() {
+                   calc_asset_or_nothing_greeks(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0],
+                                                &price[0], &delta[0], &gamma[0], &vega[0], n);
+                   return gamma[n / 3];
+               }));
+    report.add("double digital", "calc_double_digital_greeks", dd_scalar.max_abs, dd_scalar.max_rel, tol,
+               bench.run("calc_double_digital_greeks", n_dd, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n_dd; i++)
+                       s += calc_double_digital_greeks(dd_S[i], dd_D[i], dd_U[i], dd_r[i], dd_T[i], dd_sigma[i]).gamma;
+                   return s;
+               }));
+    report.add("double digital", "calc_double_digital_greeks batch", dd_batch.max_abs, dd_batch.max_rel, tol,
+               bench.run("calc_double_digital_greeks batch", n_dd, [&]() {
+                   calc_double_digital_greeks(&dd_S[0], &dd_D[0], &dd_U[0], &dd_r[0], &dd_T[0], &dd_sigma[0],
+                                              &price[0], &delta[0], &gamma[0], &vega[0], n_dd);
+                   return gamma[n_dd / 3];
+               }));
+    report.add("digital parity", "asset - K cash vs bs price", parity.max_abs, parity.max_rel, tol, nullptr);
+}
+
+// Round trip: solve the golden prices back for the volatility they came from
+void check_implied_vol(MicroBenchmark& bench, AccuracyReport& report) {
+    const GoldenBlackScholes* g = GOLDEN_BLACK_SCHOLES;
+    const size_t n = NUM_GOLDEN_BLACK_SCHOLES;
+    const double epsilon = 1e-10;  // Price tolerance handed to every solver
+
+    auto bisection = [&](size_t i) {
+        PriceFunctor f(g[i].is_call, g[i].K, g[i].r, g[i].T, g[i].S);
+        return interval_bisection(g[i].price, 0.01, 2.0, epsilon, f);
+    };
+    auto newton = [&](size_t i) {
+        BlackScholesPricer p(g[i].is_call, g[i].K, g[i].r, g[i].T, g[i].S);
+        return newton_raphson<BlackScholesPricer, &BlackScholesPricer::price,
+                              &BlackScholesPricer::vega>(g[i].price, 0.3, epsilon, p);
+    };
+    auto safeguarded = [&](size_t i) {
+        return calc_implied_vol(g[i].is_call, g[i].price, g[i].S, g[i].K, g[i].r, g[i].T, 0.3, epsilon);
+    };
+
+    vector<double> phi(n), price(n), S(n), K(n), r(n), T(n), sigma(n);
+    for (size_t i = 0; i < n; i++) {
+        phi[i] = g[i].is_call ? 1.0 : -1.0;
+        price[i] = g[i].price; S[i] = g[i].S; K[i] = g[i].K; r[i] = g[i].r; T[i] = g[i].T;
+    }
+    calc_implied_vols(&phi[0], &price[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], n, epsilon);
+
+    ErrorStats e_bisection, e_newton, e_safeguarded, e_batch;
+    for (size_t i = 0; i < n; i++) {
+        e_bisection.add(bisection(i), g[i].sigma);
+        e_newton.add(newton(i), g[i].sigma);
+        e_safeguarded.add(safeguarded(i), g[i].sigma);
+        e_batch.add(sigma[i], g[i].sigma);
+    }
+
+    // Vol errors are dominated by the A&S error in the price, divided by vega
+    const double tol = 1e-5;
+    report.add("implied vol", "interval_bisection", e_bisection.max_abs, e_bisection.max_rel, tol,
+               bench.run("interval_bisection", n, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n; i++) s += bisection(i);
+                   return s;
+               }));
+    report.add("implied vol", "newton_raphson", e_newton.max_abs, e_newton.max_rel, tol,
+               bench.run("newton_raphson", n, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n; i++) s += newton(i);
+                   return s;
+               }));
+    report.add("implied vol", "calc_implied_vol (safeguarded)", e_safeguarded.max_abs, e_safeguarded.max_rel, tol,
+               bench.run("calc_implied_vol", n, [&]() {
+                   double s = 0.0;
+                   for (size_t i = 0; i < n; i++) s += safeguarded(i);
+                   return s;
+               }));
+    report.add("implied vol", "calc_implied_vols batch", e_batch.max_abs, e_batch.max_rel, tol,
+               bench.run("calc_implied_vols", n, [&]() {
+                   calc_implied_vols(&phi[0], &price[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], n, epsilon);
+                   return sigma[n / 3];
+               }));
+}
+
+// Monte Carlo geometric Asian against the closed form. The tolerance is
+// four standard errors of the estimate, so a failure means a biased kernel.
+// The policy-based Asian options are compared with the virtual ones path by
+// path, per unit spot
+void check_geometric_asian(MicroBenchmark& bench, AccuracyReport& report) {
+    const size_t num_paths = 20000;
+    vector<double> path(GOLDEN_ASIAN_FIXINGS, GOLDEN_ASIAN_S);
+    PayOffCall pay_off(GOLDEN_ASIAN_K);
+    AsianOptionGeometric asian(&pay_off);
+    double df = exp(-GOLDEN_ASIAN_R * GOLDEN_ASIAN_T);
+
+    // The policy form prices the same paths; it only reorders the averaging
+    GeometricAsianOption<PayOffCall> asian_policy(pay_off);
+    AsianOptionArithmetic arithmetic(&pay_off);
+    ArithmeticAsianOption<PayOffCall> arithmetic_policy(pay_off);
+    ErrorStats policy_geometric, policy_arithmetic;
+
+    srand(42);
+    double sum = 0.0, sum_sq = 0.0;
+    for (size_t p = 0; p < num_paths; p++) {
+        calc_path_spot_prices(path, GOLDEN_ASIAN_R, GOLDEN_ASIAN_SIGMA, GOLDEN_ASIAN_T);
+        double x = df * asian.pay_off_price(path);
+        sum += x;
+        sum_sq += x * x;
+        policy_geometric.add(asian_policy.pay_off_price(path), asian.pay_off_price(path), GOLDEN_ASIAN_S);
+        policy_arithmetic.add(arithmetic_policy.pay_off_price(path), arithmetic.pay_off_price(path), GOLDEN_ASIAN_S);
+    }
+    double mean = sum / num_paths;
+    double std_error = sqrt((sum_sq / num_paths - mean * mean) / (num_paths - 1));
+
+    ErrorStats e;
+    e.add(mean, GOLDEN_ASIAN_GEOMETRIC_CALL);
+    report.add("geometric asian", "Monte Carlo, 20000 paths (per path)", e.max_abs, e.max_rel, 4.0 * std_error,
+               bench.run("geometric asian path", 64, [&]() {
+                   double s = 0.0;
+                   for (size_t p = 0; p < 64; p++) {
+                       calc_path_spot_prices(path, GOLDEN_ASIAN_R, GOLDEN_ASIAN_SIGMA, GOLDEN_ASIAN_T);
+                       s += asian.pay_off_price(path);
+                   }
+                   return s;
+               }));
+    report.add("asian payoff", "GeometricAsianOption<PayOffCall>", policy_geometric.max_abs,
+               policy_geometric.max_rel, 1e-13,
+               bench.run("GeometricAsianOption policy", 64, [&]() {
+                   double s = 0.0;
+                   for (size_t p = 0; p < 64; p++) s += asian_policy.pay_off_price(path);
+                   return s;
+               }));
+    report.add("asian payoff", "ArithmeticAsianOption<PayOffCall>", policy_arithmetic.max_abs,
+               policy_arithmetic.max_rel, 1e-13,
+               bench.run("ArithmeticAsianOption policy", 64, [&]() {
+                   double s = 0.0;
+                   for (size_t p = 0; p < 64; p++) s += arithmetic_policy.pay_off_price(path);
+                   return s;
+               }));
+}
+
+// Arithmetic Asian approximations. With a single fixing at expiry each one
+// reduces to Black-Scholes exactly. On the golden Asian case they are
+// compared with Monte Carlo, using the geometric Asian, whose price is known
+// exactly, as a control variate
+void check_asian_approximations(MicroBenchmark& bench, AccuracyReport& report) {
+    const AsianApproximation methods[] = {ASIAN_TURNBULL_WAKEMAN, ASIAN_LEVY, ASIAN_CURRAN};
+    const GoldenBlackScholes* g = GOLDEN_BLACK_SCHOLES;
+
+    for (AsianApproximation m : methods) {
+        ErrorStats e;
+        for (size_t i = 0; i < NUM_GOLDEN_BLACK_SCHOLES; i++) {
+            ArithmeticAsianApproximation a(g[i].S, g[i].r, g[i].sigma, g[i].T, vector<double>(1, g[i].T));
+            e.add(a.price(m, g[i].is_call, g[i].K), g[i].price, g[i].S);
+        }
+        report.add("asian bs limit", asian_approximation_name(m), e.max_abs, e.max_rel, 1e-12, nullptr);
+    }
+
+    const size_t num_paths = 20000;
+    vector<double> path(GOLDEN_ASIAN_FIXINGS, GOLDEN_ASIAN_S);
+    PayOffCall pay_off(GOLDEN_ASIAN_K);
+    ArithmeticAsianOption<PayOffCall> arithmetic(pay_off);
+    GeometricAsianOption<PayOffCall> geometric(pay_off);
+    double df = exp(-GOLDEN_ASIAN_R * GOLDEN_ASIAN_T);
+
+    srand(7);
+    double sum = 0.0, sum_sq = 0.0;
+    for (size_t p = 0; p < num_paths; p++) {
+        calc_path_spot_prices(path, GOLDEN_ASIAN_R, GOLDEN_ASIAN_SIGMA, GOLDEN_ASIAN_T);
+        double x = df * (arithmetic.pay_off_price(path) - geometric.pay_off_price(path)) + GOLDEN_ASIAN_GEOMETRIC_CALL;
+        sum += x;
+        sum_sq += x * x;
+    }
+    double mc_price = sum / num_paths;
+    double std_error = sqrt((sum_sq / num_paths - mc_price * mc_price) / (num_paths - 1));
+
+    // Strikes across the smile, for timing the batch form
+    const size_t num_strikes = 101;
+    vector<double> phi(num_strikes, 1.0), K(num_strikes), price(num_strikes);
+    for (size_t i = 0; i < num_strikes; i++) K[i] = GOLDEN_ASIAN_S * (0.75 + 0.5 * i / (num_strikes - 1));
+
+    // The lognormal fits are biased by a few cents at this volatility;
+    // Curran is within a few tenths of a cent
+    ArithmeticAsianApproximation approx(GOLDEN_ASIAN_S, GOLDEN_ASIAN_R, GOLDEN_ASIAN_SIGMA, GOLDEN_ASIAN_T,
+        ArithmeticAsianApproximation::path_fixing_times(GOLDEN_ASIAN_T, GOLDEN_ASIAN_FIXINGS));
+    for (AsianApproximation m : methods) {
+        ErrorStats e;
+        e.add(approx.price(m, true, GOLDEN_ASIAN_K), mc_price);
+        double bias = m == ASIAN_CURRAN ? 0.005 : 0.05;
+        report.add("asian approx", string(asian_approximation_name(m)) + " vs MC (per strike)",
+                   e.max_abs, e.max_rel, bias + 4.0 * std_error,
+                   bench.run(string("asian approximation ") + asian_approximation_name(m), num_strikes, [&]() {
+                       approx.prices(m, &phi[0], &K[0], &price[0], num_strikes);
+                       return price[num_strikes / 2];
+                   }));
+    }
+}
+
+// Single and mixed precision. The float Black-Scholes error is bounded by
+// black_scholes_float_error_bound, 16 float ulps of S + K*exp(-r*T)
+// (exp(-r*T) taken as 1 for r >= 0), whatever the expiry and volatility:
+// rounding d1 moves S N(d1) and K exp(-rT) N(d2) by the same amount, as
+// S n(d1) = K exp(-rT) n(d2). It is checked here as error / bound against
+// the double kernel on random contracts far wider than any market's, for
+// which it must stay below 1. The float normal cdf adds up to 2e-7 of
+// rounding to the 7.5e-8 of A&S. The mixed mode is checked at a tolerance
+// of one cent on spots from 10 to 5000, where the larger ones go to double
+void check_mixed_precision(MicroBenchmark& bench, AccuracyReport& report) {
+    StandardNormalDistribution snd;
+    const GoldenNormal* gn = GOLDEN_NORMAL_CDF;
+    const size_t nn = NUM_GOLDEN_NORMAL_CDF;
+    vector<float> fx(nn), fp(nn);
+    for (size_t i = 0; i < nn; i++) fx[i] = static_cast<float>(gn[i].x);
+    snd.cdf(&fx[0], &fp[0], nn);
+    ErrorStats cdf;
+    for (size_t i = 0; i < nn; i++) cdf.add(fp[i], gn[i].value);
+    report.add("normal cdf", "StandardNormalDistribution f32", cdf.max_abs, cdf.max_rel, 3e-7,
+               bench.run("StandardNormalDistribution::cdf f32", nn, [&]() {
+                   snd.cdf(&fx[0], &fp[0], nn);
+                   return fp[nn / 3];
+               }));
+
+    const GoldenBlackScholes* g = GOLDEN_BLACK_SCHOLES;
+    const size_t ng = NUM_GOLDEN_BLACK_SCHOLES;
+    vector<float> gphi(ng), gS(ng), gK(ng), gr(ng), gT(ng), gsigma(ng), gprice(ng);
+    for (size_t i = 0; i < ng; i++) {
+        gphi[i] = g[i].is_call ? 1.0f : -1.0f;
+        gS[i] = g[i].S; gK[i] = g[i].K; gr[i] = g[i].r; gT[i] = g[i].T; gsigma[i] = g[i].sigma;
+    }
+    calc_black_scholes_prices(&gphi[0], &gS[0], &gK[0], &gr[0], &gT[0], &gsigma[0], &gprice[0], ng);
+    ErrorStats golden;
+    for (size_t i = 0; i < ng; i++) golden.add(gprice[i], g[i].price, g[i].S);
+    report.add("bs price", "calc_black_scholes_prices f32", golden.max_abs, golden.max_rel, 1e-6, nullptr);
+
+    // Random contracts, in double and rounded to float
+    const size_t n = 65536;
+    mt19937_64 rng(2024);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    vector<double> phi(n), S(n), K(n), r(n), T(n), sigma(n), ref(n), mixed(n);
+    vector<float> f_phi(n), f_S(n), f_K(n), f_r(n), f_T(n), f_sigma(n), f_price(n);
+    for (size_t i = 0; i < n; i++) {
+        phi[i] = i % 2 ? -1.0 : 1.0;
+        S[i] = 10.0 * exp(unit(rng) * log(500.0));
+        K[i] = S[i] * exp((unit(rng) - 0.5) * 4.0);
+        r[i] = -0.05 + 0.25 * unit(rng);
+        T[i] = exp(log(1.0 / 3650.0) + unit(rng) * log(300.0 * 365.0));
+        sigma[i] = 0.01 + 3.0 * unit(rng);
+        f_phi[i] = phi[i]; f_S[i] = S[i]; f_K[i] = K[i]; f_r[i] = r[i]; f_T[i] = T[i]; f_sigma[i] = sigma[i];
+    }
+    calc_black_scholes_prices(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], &ref[0], n);
+    calc_black_scholes_prices(&f_phi[0], &f_S[0], &f_K[0], &f_r[0], &f_T[0], &f_sigma[0], &f_price[0], n);
+    // Prices reach 1e-280 deep out of the money, so these rows are absolute
+    ErrorStats bound;
+    for (size_t i = 0; i < n; i++) {
+        bound.add(fabs(f_price[i] - ref[i]) / black_scholes_float_error_bound(S[i], K[i], r[i], T[i]), 0.0);
+    }
+    report.add("bs price", "f32 error / bound, random", bound.max_abs, bound.max_rel, 1.0,
+               bench.run("calc_black_scholes_prices f32", n, [&]() {
+                   calc_black_scholes_prices(&f_phi[0], &f_S[0], &f_K[0], &f_r[0], &f_T[0], &f_sigma[0],
+                                             &f_price[0], n);
+                   return f_price[n / 3];
+               }));
+
+    const double cent = 0.01;
+    size_t repriced = calc_black_scholes_prices_mixed(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0],
+                                                      &mixed[0], n, cent);
+    ErrorStats mixed_error;
+    for (size_t i = 0; i < n; i++) mixed_error.add(fabs(mixed[i] - ref[i]), 0.0);
+    ostringstream label;
+    label << "mixed, 1 cent (" << fixed << setprecision(0) << 100.0 * repriced / n << "% in double)";
+    report.add("bs price", label.str(), mixed_error.max_abs, mixed_error.max_rel, cent,
+               bench.run("calc_black_scholes_prices_mixed", n, [&]() {
+                   calc_black_scholes_prices_mixed(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0],
+                                                   &mixed[0], n, cent);
+                   return mixed[n / 3];
+               }));
+}
+
+// Streaming accumulators on a P&L-like sample whose left tail is the long one
+// (minus a unit exponential: skewness -2, excess kurtosis 6). The moments of
+// a stream split four ways and merged must match the two-pass values to
+// rounding. Quantile estimators are checked by rank error: the fraction of
+// samples at or below the estimate minus the target probability, at
+// probabilities from 0.001 to 0.999
+void check_accumulators(MicroBenchmark& bench, AccuracyReport& report) {
+    const size_t n = 100000;
+    mt19937_64 rng(11);
+    exponential_distribution<double> loss(1.0);
+    vector<double> x(n);
+    for (size_t i = 0; i < n; i++) x[i] = -loss(rng);
+
+    // Two-pass reference moments
+    double mean = 0.0;
+    for (double v : x) mean += v;
+    mean /= n;
+    double s2 = 0.0, s3 = 0.0, s4 = 0.0;
+    for (double v : x) {
+        double d = v - mean;
+        s2 += d * d;
+        s3 += d * d * d;
+        s4 += d * d * d * d;
+    }
+    const double ref[4] = {mean, s2 / (n - 1), sqrt(double(n)) * s3 / pow(s2, 1.5), n * s4 / (s2 * s2) - 3.0};
+
+    // Uneven pieces, one of them empty
+    const size_t cuts[] = {0, 1, 1, 30000, n};
+    MomentAccumulator merged;
+    for (size_t c = 0; c + 1 < sizeof(cuts) / sizeof(cuts[0]); c++) {
+        MomentAccumulator part;
+        part.add(&x[cuts[c]], cuts[c + 1] - cuts[c]);
+        merged.merge(part);
+    }
+    MomentAccumulator single;
+    ErrorStats one_pass, split;
+    const BenchmarkResult* timing = bench.run("MomentAccumulator::add", n, [&]() {
+        single.reset();
+        single.add(&x[0], n);
+        return single.mean();
+    });
+    const double got_single[4] = {single.mean(), single.var(), single.skew(), single.kurtosis()};
+    const double got_merged[4] = {merged.mean(), merged.var(), merged.skew(), merged.kurtosis()};
+    for (int m = 0; m < 4; m++) {
+        one_pass.add(got_single[m], ref[m], fabs(ref[m]));
+        split.add(got_merged[m], ref[m], fabs(ref[m]));
+    }
+    bool counts = single.count() == n && merged.count() == n && merged.min() == single.min() &&
+                  merged.max() == single.max();
+    report.add("moments", "MomentAccumulator vs two-pass", one_pass.max_abs, one_pass.max_rel, 1e-10, timing);
+    report.add("moments", "merged 4-way split vs two-pass", counts ? split.max_abs : NAN, split.max_rel, 1e-10,
+               nullptr);
+
+    vector<double> sorted(x);
+    sort(sorted.begin(), sorted.end());
+    auto rank = [&](double v) {
+        return double(upper_bound(sorted.begin(), sorted.end(), v) - sorted.begin()) / n;
+    };
+    const double probs[] = {0.001, 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99, 0.999};
+
+    ErrorStats p2;
+    for (double q : probs) {
+        P2Quantile est(q);
+        for (double v : x) est.add(v);
+        p2.add(rank(est.quantile()), q);
+    }
+    P2Quantile p2_timed(0.01);
+    report.add("quantile", "P2Quantile rank error", p2.max_abs, p2.max_rel, 1e-3,
+               bench.run("P2Quantile::add", n, [&]() {
+                   p2_timed.reset();
+                   for (double v : x) p2_timed.add(v);
+                   return p2_timed.quantile();
+               }));
+
+    TDigest digest;
+    timing = bench.run("TDigest::add", n, [&]() {
+        digest.reset();
+        digest.add(&x[0], n);
+        return digest.quantile(0.01);
+    });
+    TDigest merged_digest;
+    for (size_t c = 0; c + 1 < sizeof(cuts) / sizeof(cuts[0]); c++) {
+        TDigest part;
+        part.add(&x[cuts[c]], cuts[c + 1] - cuts[c]);
+        merged_digest.merge(part);
+    }
+    ErrorStats td, td_merged, td_cdf;
+    for (double q : probs) {
+        td.add(rank(digest.quantile(q)), q);
+        td_merged.add(rank(merged_digest.quantile(q)), q);
+        td_cdf.add(digest.cdf(sorted[size_t(q * n) - 1]), q);
+    }
+    report.add("quantile", "TDigest rank error", td.max_abs, td.max_rel, 1e-3, timing);
+    report.add("quantile", "TDigest merged 4-way rank error", td_merged.max_abs, td_merged.max_rel, 1e-3, nullptr);
+    report.add("quantile", "TDigest::cdf error", td_cdf.max_abs, td_cdf.max_rel, 1e-3, nullptr);
+
+    // Expected shortfall style tail means, relative to the exact ones. At
+    // 0.1% the 100 samples in the tail share a handful of centroids, each
+    // taken as a point mass, so the mean is about 1% short of the exact one
+    ErrorStats tail, far_tail;
+    for (double q : {0.001, 0.01, 0.05, 0.5}) {
+        size_t k = size_t(q * n);
+        double exact = 0.0;
+        for (size_t i = 0; i < k; i++) exact += sorted[i];
+        exact /= k;
+        (q < 0.01 ? far_tail : tail).add(digest.lower_tail_mean(q), exact, fabs(exact));
+    }
+    report.add("tail mean", "TDigest::lower_tail_mean 1-50%", tail.max_abs, tail.max_rel, 5e-3, nullptr);
+    report.add("tail mean", "TDigest::lower_tail_mean 0.1%", far_tail.max_abs, far_tail.max_rel, 2e-2, nullptr);
+}
+
+// Every SIMD variant this CPU can run, against the golden values and against
+// the scalar variant on a wider grid. The vector variants replace libm with
+// inline polynomials, so they may differ from scalar by a few ulps only
+void check_simd_variants(MicroBenchmark& bench, AccuracyReport& report) {
+    const SimdKernels& scalar = SIMD_KERNELS_SCALAR;
+
+    // Golden inputs
+    const GoldenBlackScholes* gb = GOLDEN_BLACK_SCHOLES;
+    const size_t nb = NUM_GOLDEN_BLACK_SCHOLES;
+    vector<double> gphi(nb), gS(nb), gK(nb), gr(nb), gT(nb), gsigma(nb), gprice(nb);
+    for (size_t i = 0; i < nb; i++) {
+        gphi[i] = gb[i].is_call ? 1.0 : -1.0;
+        gS[i] = gb[i].S; gK[i] = gb[i].K; gr[i] = gb[i].r; gT[i] = gb[i].T; gsigma[i] = gb[i].sigma;
+    }
+    vector<double> gx(NUM_GOLDEN_NORMAL_CDF), gp(NUM_GOLDEN_NORMAL_CDF);
+    for (size_t i = 0; i < NUM_GOLDEN_NORMAL_CDF; i++) gx[i] = GOLDEN_NORMAL_CDF[i].x;
+    vector<double> gu(NUM_GOLDEN_NORMAL_INV_CDF), gz(NUM_GOLDEN_NORMAL_INV_CDF);
+    for (size_t i = 0; i < NUM_GOLDEN_NORMAL_INV_CDF; i++) gu[i] = GOLDEN_NORMAL_INV_CDF[i].x;
+
+    // Agreement grid: options from deep in to deep out of the money, and
+    // uniforms reaching into both tails
+    const size_t n = 4096;
+    vector<double> phi(n), S(n), K(n), r(n), T(n), sigma(n), x(n), u(n);
+    for (size_t i = 0; i < n; i++) {
+        phi[i] = i % 2 ? -1.0 : 1.0;
+        S[i] = 100.0;
+        K[i] = 40.0 + 160.0 * (i % 97) / 96.0;
+        r[i] = -0.01 + 0.09 * (i % 11) / 10.0;
+        T[i] = 0.01 + 3.0 * (i % 31) / 30.0;
+        sigma[i] = 0.05 + 0.95 * (i % 23) / 22.0;
+        x[i] = -9.0 + 18.0 * (i + 0.5) / n;
+        u[i] = (i + 0.5) / n;
+    }
+    u[0] = 1e-300;
+    u[1] = 1e-12;
+    u[n - 1] = 1.0 - 1e-12;
+    vector<double> ref(n), out(n), ref_S(n, 100.0), out_S(n, 100.0);
+
+    // The same in float
+    vector<float> f_gphi(gphi.begin(), gphi.end()), f_gS(gS.begin(), gS.end()), f_gK(gK.begin(), gK.end());
+    vector<float> f_gr(gr.begin(), gr.end()), f_gT(gT.begin(), gT.end()), f_gsigma(gsigma.begin(), gsigma.end());
+    vector<float> f_phi(phi.begin(), phi.end()), f_S(S.begin(), S.end()), f_K(K.begin(), K.end());
+    vector<float> f_r(r.begin(), r.end()), f_T(T.begin(), T.end()), f_sigma(sigma.begin(), sigma.end());
+    vector<float> f_x(x.begin(), x.end()), f_z(n), f_out(n), f_S_out(n), f_gprice(nb);
+
+    for (int isa = 0; isa < NUM_SIMD_ISAS; isa++) {
+        const SimdKernels* k = simd_kernels_for(SimdIsa(isa));
+        if (!k) continue;
+        string name = simd_isa_name(SimdIsa(isa));
+
+        ErrorStats cdf;
+        k->normal_cdf(&gx[0], &gp[0], gx.size());
+        for (size_t i = 0; i < gx.size(); i++) cdf.add(gp[i], GOLDEN_NORMAL_CDF[i].value);
+        report.add("normal cdf", "simd " + name, cdf.max_abs, cdf.max_rel, 1e-7,
+                   bench.run("simd normal_cdf " + name, n, [&]() {
+                       k->normal_cdf(&x[0], &out[0], n);
+                       return out[n / 3];
+                   }));
+
+        ErrorStats acklam, as241;
+        k->inv_cdf_acklam(&gu[0], &gz[0], gu.size());
+        for (size_t i = 0; i < gu.size(); i++) acklam.add(gz[i], GOLDEN_NORMAL_INV_CDF[i].value);
+        k->inv_cdf_as241(&gu[0], &gz[0], gu.size());
+        for (size_t i = 0; i < gu.size(); i++) as241.add(gz[i], GOLDEN_NORMAL_INV_CDF[i].value);
+        report.add("normal inv cdf", "simd " + name + " Acklam", acklam.max_abs, acklam.max_rel, 1e-8,
+                   bench.run("simd inv_cdf_acklam " + name, n, [&]() {
+                       k->inv_cdf_acklam(&u[0], &out[0], n);
+                       return out[n / 3];
+                   }));
+        report.add("normal inv cdf", "simd " + name + " AS241", as241.max_abs, as241.max_rel, 1e-14,
+                   bench.run("simd inv_cdf_as241 " + name, n, [&]() {
+                       k->inv_cdf_as241(&u[0], &out[0], n);
+                       return out[n / 3];
+                   }));
+
+        ErrorStats bs;
+        k->black_scholes_prices(&gphi[0], &gS[0], &gK[0], &gr[0], &gT[0], &gsigma[0], &gprice[0], nb);
+        for (size_t i = 0; i < nb; i++) bs.add(gprice[i], gb[i].price, gb[i].S);
+        report.add("bs price", "simd " + name, bs.max_abs, bs.max_rel, 2e-7,
+                   bench.run("simd black_scholes_prices " + name, n, [&]() {
+                       k->black_scholes_prices(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], &out[0], n);
+                       return out[n / 3];
+                   }));
+
+        // Agreement with the scalar variant
+        ErrorStats a_bs, a_cdf, a_acklam, a_as241, a_gbm, a_bm;
+        scalar.black_scholes_prices(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], &ref[0], n);
+        k->black_scholes_prices(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], &out[0], n);
+        for (size_t i = 0; i < n; i++) a_bs.add(out[i], ref[i], S[i]);
+        scalar.normal_cdf(&x[0], &ref[0], n);
+        k->normal_cdf(&x[0], &out[0], n);
+        for (size_t i = 0; i < n; i++) a_cdf.add(out[i], ref[i]);
+        scalar.inv_cdf_acklam(&u[0], &ref[0], n);
+        k->inv_cdf_acklam(&u[0], &out[0], n);
+        for (size_t i = 0; i < n; i++) a_acklam.add(out[i], ref[i]);
+        scalar.inv_cdf_as241(&u[0], &ref[0], n);
+        k->inv_cdf_as241(&u[0], &out[0], n);
+        for (size_t i = 0; i < n; i++) a_as241.add(out[i], ref[i]);
+        scalar.inv_cdf_as241(&u[0], &ref[0], n);  // Normal draws for the path step
+        fill(ref_S.begin(), ref_S.end(), 100.0);
+        fill(out_S.begin(), out_S.end(), 100.0);
+        scalar.gbm_step(&ref_S[0], &ref[0], &ref_S[0], n, 1.0001, 0.1);
+        k->gbm_step(&out_S[0], &ref[0], &out_S[0], n, 1.0001, 0.1);
+        for (size_t i = 0; i < n; i++) a_gbm.add(out_S[i], ref_S[i], 100.0);
+        scalar.box_muller(&u[0], &ref[0], n);
+        k->box_muller(&u[0], &out[0], n);
+        for (size_t i = 0; i < n; i++) a_bm.add(out[i], ref[i]);
+
+        // Absolute, and z reaches -37 at u = 1e-300
+        const double tol = 1e-12;
+        report.add("simd agreement", name + " black_scholes_prices", a_bs.max_abs, a_bs.max_rel, tol, nullptr);
+        report.add("simd agreement", name + " normal_cdf", a_cdf.max_abs, a_cdf.max_rel, tol, nullptr);
+        report.add("simd agreement", name + " inv_cdf_acklam", a_acklam.max_abs, a_acklam.max_rel, tol, nullptr);
+        report.add("simd agreement", name + " inv_cdf_as241", a_as241.max_abs, a_as241.max_rel, tol, nullptr);
+        report.add("simd agreement", name + " gbm_step", a_gbm.max_abs, a_gbm.max_rel, tol,
+                   bench.run("simd gbm_step " + name, n, [&]() {
+                       k->gbm_step(&out_S[0], &ref[0], &out_S[0], n, 1.0, 1e-3);
+                       return out_S[n / 3];
+                   }));
+        report.add("simd agreement", name + " box_muller", a_bm.max_abs, a_bm.max_rel, tol,
+                   bench.run("simd box_muller " + name, n, [&]() {
+                       k->box_muller(&u[0], &out[0], n);
+                       return out[n / 3];
+                   }));
+
+        // Float kernels against the golden values, and against the scalar
+        // double kernels on the grid, Black-Scholes as error / bound (see
+        // check_mixed_precision)
+        ErrorStats f_golden, f_bs, f_cdf, f_gbm;
+        k->black_scholes_prices_f32(&f_gphi[0], &f_gS[0], &f_gK[0], &f_gr[0], &f_gT[0], &f_gsigma[0],
+                                    &f_gprice[0], nb);
+        for (size_t i = 0; i < nb; i++) f_golden.add(f_gprice[i], gb[i].price, gb[i].S);
+        scalar.black_scholes_prices(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], &ref[0], n);
+        k->black_scholes_prices_f32(&f_phi[0], &f_S[0], &f_K[0], &f_r[0], &f_T[0], &f_sigma[0], &f_out[0], n);
+        for (size_t i = 0; i < n; i++) {
+            f_bs.add(fabs(f_out[i] - ref[i]) / black_scholes_float_error_bound(S[i], K[i], r[i], T[i]), 0.0);
+        }
+        scalar.normal_cdf(&x[0], &ref[0], n);
+        k->normal_cdf_f32(&f_x[0], &f_out[0], n);
+        for (size_t i = 0; i < n; i++) f_cdf.add(f_out[i], ref[i]);
+        scalar.inv_cdf_as241(&u[0], &ref[0], n);
+        for (size_t i = 0; i < n; i++) f_z[i] = static_cast<float>(ref[i]);
+        fill(ref_S.begin(), ref_S.end(), 100.0);
+        fill(f_S_out.begin(), f_S_out.end(), 100.0f);
+        scalar.gbm_step(&ref_S[0], &ref[0], &ref_S[0], n, 1.0001, 0.1);
+        k->gbm_step_f32(&f_S_out[0], &f_z[0], &f_S_out[0], n, 1.0001f, 0.1f);
+        for (size_t i = 0; i < n; i++) f_gbm.add(f_S_out[i], ref_S[i], 100.0);
+
+        report.add("bs price", "simd " + name + " f32", f_golden.max_abs, f_golden.max_rel, 1e-6,
+                   bench.run("simd black_scholes_prices_f32 " + name, n, [&]() {
+                       k->black_scholes_prices_f32(&f_phi[0], &f_S[0], &f_K[0], &f_r[0], &f_T[0], &f_sigma[0],
+                                                   &f_out[0], n);
+                       return f_out[n / 3];
+                   }));
+        report.add("f32 agreement", name + " bs error / bound", f_bs.max_abs, f_bs.max_rel, 1.0, nullptr);
+        report.add("f32 agreement", name + " normal_cdf", f_cdf.max_abs, f_cdf.max_rel, 3e-7,
+                   bench.run("simd normal_cdf_f32 " + name, n, [&]() {
+                       k->normal_cdf_f32(&f_x[0], &f_out[0], n);
+                       return f_out[n / 3];
+                   }));
+        report.add("f32 agreement", name + " gbm_step", f_gbm.max_abs, f_gbm.max_rel, 1e-6,
+                   bench.run("simd gbm_step_f32 " + name, n, [&]() {
+                       k->gbm_step_f32(&f_S_out[0], &f_z[0], &f_S_out[0], n, 1.0f, 1e-3f);
+                       return f_S_out[n / 3];
+                   }));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    MicroBenchmark bench(10, 101);
+    bench.set_verbose(false);
+    AccuracyReport report;
+
+    cout << "Accuracy against golden values (errors per unit spot for money amounts)\n\n";
+    cout << "  " << left << setw(16) << "Kernel" << setw(34) << "Implementation" << right
+         << setw(11) << "max abs" << setw(11) << "max rel" << setw(11) << "tolerance"
+         << setw(11) << "ns/op" << "   status\n";
+
+    check_normal_cdf(bench, report);
+    check_normal_inv_cdf(bench, report);
+    check_black_scholes(bench, report);
+    check_digitals(bench, report);
+    check_implied_vol(bench, report);
+    check_geometric_asian(bench, report);
+    check_asian_approximations(bench, report);
+    check_mixed_precision(bench, report);
+    check_accumulators(bench, report);
+    check_simd_variants(bench, report);
+
+    if (argc > 1 && !report.write_json(argv[1])) return 1;
+
+    size_t failed = report.num_failed();
+    cout << "\n" << (failed ? to_string(failed) + " implementation(s) outside tolerance" : "All implementations within tolerance") << endl;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,357 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+
+// Option pricing headers
+#include "src/option_pricing/vanilla/vanilla_option.h"
+#include "src/option_pricing/vanilla/black_scholes.h"
+#include "src/option_pricing/vanilla/payoff.h"
+#include "src/option_pricing/exotic/asian.h"
+#include "src/option_pricing/exotic/asian_policy.h"
+#include "src/option_pricing/exotic/digital.h"
+#include "src/option_pricing/exotic/asian_approximation.h"
+#include "src/option_pricing/monte_carlo/path_generation.h"
+
+// Math library headers
+#include "src/math/statistics/statistics.h"
+#include "src/math/random/linear_congruential_generator.h"
+
+// Implied volatility headers
+#include "src/implied_volatility/interval_bisection.h"
+#include "src/implied_volatility/newton_raphson.h"
+
+#include "src/benchmark/micro_benchmark.h"
+#include "src/instrumentation/allocation_tracker.h"
+#include "src/simd/simd_kernels.h"
+
+using namespace std;
+
+// Micro-benchmarks of the pricing kernels. Usage:
+//   ./benchmark [results.json] [name filter]
+// Each kernel is warmed up, then timed over repeated runs; the table and the
+// JSON give the median, 99th percentile and minimum time per operation, and
+// the heap allocations per operation.
+
+const size_t BATCH = 1024;  // Operations per timed run for the cheap kernels
+
+// A spread of options around the money, used by the pricing and IV kernels
+struct OptionInputs {
+    vector<double> S, K, r, T, sigma, phi, call_price;
+};
+
+OptionInputs make_inputs(size_t n) {
+    OptionInputs in;
+    for (size_t i = 0; i < n; i++) {
+        double S = 100.0;
+        double K = 90.0 + 20.0 * (i % 41) / 40.0;
+        double T = 0.25 + 0.75 * (i % 13) / 12.0;
+        double sigma = 0.15 + 0.25 * (i % 7) / 6.0;
+        in.S.push_back(S);
+        in.K.push_back(K);
+        in.r.push_back(0.04);
+        in.T.push_back(T);
+        in.sigma.push_back(sigma);
+        in.phi.push_back(i % 2 ? -1.0 : 1.0);
+        in.call_price.push_back(VanillaOption(K, 0.04, T, S, sigma).calc_call_price());
+    }
+    return in;
+}
+
+class CallPriceFunctor {
+public:
+    double K, r, T, S;
+    CallPriceFunctor(double _K, double _r, double _T, double _S)
+        : K(_K), r(_r), T(_T), S(_S) {}
+
+    double operator()(double sigma) const {
+        VanillaOption opt(K, r, T, S, sigma);
+        return opt.calc_call_price();
+    }
+};
+
+int main(int argc, char* argv[]) {
+    string json_path = argc > 1 ? argv[1] : "";
+    // Counting costs a flag test and a few increments per allocation, so only
+    // kernels that allocate pay for it
+    allocation_tracking_enable(true);
+    MicroBenchmark bench(20, 201, argc > 2 ? argv[2] : "");
+
+    OptionInputs in = make_inputs(BATCH);
+    vector<VanillaOption> options;
+    for (size_t i = 0; i < BATCH; i++) options.push_back(VanillaOption(in.K[i], in.r[i], in.T[i], in.S[i], in.sigma[i]));
+
+    vector<double> x(BATCH), u(BATCH), z(BATCH), prices(BATCH);
+    for (size_t i = 0; i < BATCH; i++) {
+        x[i] = -4.0 + 8.0 * (i + 0.5) / BATCH;
+        u[i] = (i + 0.5) / BATCH;
+    }
+    StandardNormalDistribution snd;
+
+    cout << "Micro-benchmarks (" << BATCH << " operations per run unless noted), SIMD kernels: "
+         << simd_isa_name(simd_kernels().isa) << "\n\n";
+    MicroBenchmark::print_header();
+
+    // Normal distribution
+    bench.run("N", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++) s += N(x[i]);
+        return s;
+    });
+    bench.run("inv_cdf scalar", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++) s += snd.inv_cdf(u[i]);
+        return s;
+    });
+    bench.run("inv_cdf batch Acklam", BATCH, [&]() {
+        snd.inv_cdf(&u[0], &z[0], BATCH, INV_CDF_ACKLAM);
+        return z[BATCH / 3];
+    });
+    bench.run("inv_cdf batch AS241", BATCH, [&]() {
+        snd.inv_cdf(&u[0], &z[0], BATCH, INV_CDF_AS241);
+        return z[BATCH / 3];
+    });
+    bench.run("random_draws", BATCH, [&]() {
+        snd.random_draws(u, z);
+        return z[BATCH / 3];
+    });
+
+    // Random numbers
+    LinearCongruentialGenerator lcg(BATCH);
+    bench.run("LinearCongruentialGenerator", BATCH, [&]() {
+        lcg.get_uniform_draws(u);
+        return u[BATCH / 3];
+    });
+    for (size_t i = 0; i < BATCH; i++) u[i] = (i + 0.5) / BATCH;
+    bench.run("gaussian_box_muller", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++) s += gaussian_box_muller();
+        return s;
+    });
+
+    // Vanilla pricing
+    bench.run("VanillaOption construct", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++) s += VanillaOption(in.K[i], in.r[i], in.T[i], in.S[i], in.sigma[i]).getK();
+        return s;
+    });
+    bench.run("calc_call_price", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++) s += options[i].calc_call_price();
+        return s;
+    });
+    bench.run("calc_put_price", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++) s += options[i].calc_put_price();
+        return s;
+    });
+    bench.run("calc_black_scholes_greeks", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++)
+            s += calc_black_scholes_greeks(in.phi[i] > 0.0, in.S[i], in.K[i], in.r[i], in.T[i], in.sigma[i]).gamma;
+        return s;
+    });
+    bench.run("calc_black_scholes_prices batch", BATCH, [&]() {
+        calc_black_scholes_prices(&in.phi[0], &in.S[0], &in.K[0], &in.r[0], &in.T[0], &in.sigma[0], &prices[0], BATCH);
+        return prices[BATCH / 3];
+    });
+
+    // Single precision, and mixed at a cent, where all of these stay in float
+    vector<float> f_phi(in.phi.begin(), in.phi.end()), f_S(in.S.begin(), in.S.end()), f_K(in.K.begin(), in.K.end());
+    vector<float> f_r(in.r.begin(), in.r.end()), f_T(in.T.begin(), in.T.end());
+    vector<float> f_sigma(in.sigma.begin(), in.sigma.end()), f_prices(BATCH);
+    bench.run("calc_black_scholes_prices batch f32", BATCH, [&]() {
+        calc_black_scholes_prices(&f_phi[0], &f_S[0], &f_K[0], &f_r[0], &f_T[0], &f_sigma[0], &f_prices[0], BATCH);
+        return f_prices[BATCH / 3];
+    });
+    bench.run("calc_black_scholes_prices_mixed", BATCH, [&]() {
+        calc_black_scholes_prices_mixed(&in.phi[0], &in.S[0], &in.K[0], &in.r[0], &in.T[0], &in.sigma[0],
+                                        &prices[0], BATCH, 0.01);
+        return prices[BATCH / 3];
+    });
+
+    // Digitals: price, delta, gamma and vega per option
+    vector<double> D(BATCH), U(BATCH), delta(BATCH), gamma(BATCH), vega(BATCH);
+    for (size_t i = 0; i < BATCH; i++) {
+        D[i] = in.K[i] * 0.95;
+        U[i] = in.K[i] * 1.05;
+    }
+    bench.run("calc_cash_or_nothing_greeks batch", BATCH, [&]() {
+        calc_cash_or_nothing_greeks(&in.phi[0], &in.S[0], &in.K[0], &in.r[0], &in.T[0], &in.sigma[0],
+                                    &prices[0], &delta[0], &gamma[0], &vega[0], BATCH);
+        return gamma[BATCH / 3];
+    });
+    bench.run("calc_asset_or_nothing_greeks batch", BATCH, [&]() {
+        calc_asset_or_nothing_greeks(&in.phi[0], &in.S[0], &in.K[0], &in.r[0], &in.T[0], &in.sigma[0],
+                                     &prices[0], &delta[0], &gamma[0], &vega[0], BATCH);
+        return gamma[BATCH / 3];
+    });
+    bench.run("calc_double_digital_greeks", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++)
+            s += calc_double_digital_greeks(in.S[i], D[i], U[i], in.r[i], in.T[i], in.sigma[i]).gamma;
+        return s;
+    });
+    bench.run("calc_double_digital_greeks batch", BATCH, [&]() {
+        calc_double_digital_greeks(&in.S[0], &D[0], &U[0], &in.r[0], &in.T[0], &in.sigma[0],
+                                   &prices[0], &delta[0], &gamma[0], &vega[0], BATCH);
+        return gamma[BATCH / 3];
+    });
+
+    // Each SIMD variant this CPU can run; the library itself uses the one
+    // reported by simd_kernels()
+    vector<double> draws(BATCH), spots(BATCH, 100.0);
+    vector<float> f_x(x.begin(), x.end()), f_z(BATCH), f_draws(BATCH), f_spots(BATCH, 100.0f);
+    simd_kernels().inv_cdf_as241(&u[0], &draws[0], BATCH);
+    for (size_t i = 0; i < BATCH; i++) f_draws[i] = static_cast<float>(draws[i]);
+    for (int isa = 0; isa < NUM_SIMD_ISAS; isa++) {
+        const SimdKernels* k = simd_kernels_for(SimdIsa(isa));
+        if (!k) continue;
+        string suffix = string(" [") + simd_isa_name(SimdIsa(isa)) + "]";
+        bench.run("black_scholes_prices" + suffix, BATCH, [&]() {
+            k->black_scholes_prices(&in.phi[0], &in.S[0], &in.K[0], &in.r[0], &in.T[0], &in.sigma[0], &prices[0], BATCH);
+            return prices[BATCH / 3];
+        });
+        bench.run("normal_cdf" + suffix, BATCH, [&]() {
+            k->normal_cdf(&x[0], &z[0], BATCH);
+            return z[BATCH / 3];
+        });
+        bench.run("inv_cdf_as241" + suffix, BATCH, [&]() {
+            k->inv_cdf_as241(&u[0], &draws[0], BATCH);
+            return draws[BATCH / 3];
+        });
+        bench.run("box_muller" + suffix, BATCH, [&]() {
+            k->box_muller(&u[0], &z[0], BATCH);
+            return z[BATCH / 3];
+        });
+        bench.run("gbm_step" + suffix, BATCH, [&]() {
+            k->gbm_step(&spots[0], &draws[0], &spots[0], BATCH, 1.0, 1e-3);
+            return spots[BATCH / 3];
+        });
+        bench.run("black_scholes_prices_f32" + suffix, BATCH, [&]() {
+            k->black_scholes_prices_f32(&f_phi[0], &f_S[0], &f_K[0], &f_r[0], &f_T[0], &f_sigma[0], &f_prices[0], BATCH);
+            return f_prices[BATCH / 3];
+        });
+        bench.run("normal_cdf_f32" + suffix, BATCH, [&]() {
+            k->normal_cdf_f32(&f_x[0], &f_z[0], BATCH);
+            return f_z[BATCH / 3];
+        });
+        bench.run("gbm_step_f32" + suffix, BATCH, [&]() {
+            k->gbm_step_f32(&f_spots[0], &f_draws[0], &f_spots[0], BATCH, 1.0f, 1e-3f);
+            return f_spots[BATCH / 3];
+        });
+    }
+
+    // Implied volatility, solving back the call prices of the input set
+    const size_t IV_BATCH = 128;
+    bench.run("implied vol interval_bisection", IV_BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < IV_BATCH; i++) {
+            CallPriceFunctor f(in.K[i], in.r[i], in.T[i], in.S[i]);
+            s += interval_bisection(in.call_price[i], 0.01, 1.0, 1e-6, f);
+        }
+        return s;
+    });
+    bench.run("implied vol newton_raphson", IV_BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < IV_BATCH; i++) {
+            BlackScholesPricer p(true, in.K[i], in.r[i], in.T[i], in.S[i]);
+            s += newton_raphson<BlackScholesPricer, &BlackScholesPricer::price, &BlackScholesPricer::vega>(
+                in.call_price[i], 0.3, 1e-6, p);
+        }
+        return s;
+    });
+    bench.run("implied vol safeguarded newton", IV_BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < IV_BATCH; i++)
+            s += calc_implied_vol(true, in.call_price[i], in.S[i], in.K[i], in.r[i], in.T[i], 0.3, 1e-6);
+        return s;
+    });
+    vector<double> calls(IV_BATCH, 1.0), vols(IV_BATCH);
+    bench.run("implied vol calc_implied_vols batch", IV_BATCH, [&]() {
+        calc_implied_vols(&calls[0], &in.call_price[0], &in.S[0], &in.K[0], &in.r[0], &in.T[0], &vols[0], IV_BATCH, 1e-6);
+        return vols[IV_BATCH / 3];
+    });
+
+    // Monte Carlo paths and Asian pay-offs, one year of daily fixings
+    const size_t NUM_STEPS = 252;
+    const size_t NUM_PATHS = 16;
+    vector<double> path(NUM_STEPS, 100.0);
+    bench.run("calc_path_spot_prices (per step)", NUM_STEPS * NUM_PATHS, [&]() {
+        double s = 0.0;
+        for (size_t p = 0; p < NUM_PATHS; p++) {
+            calc_path_spot_prices(path, 0.04, 0.2, 1.0);
+            s += path.back();
+        }
+        return s;
+    });
+    PayOffCall pay_off_call(100.0);
+    AsianOptionArithmetic arithmetic(&pay_off_call);
+    AsianOptionGeometric geometric(&pay_off_call);
+    bench.run("AsianOptionArithmetic (per path)", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++) s += arithmetic.pay_off_price(path);
+        return s;
+    });
+    bench.run("AsianOptionGeometric (per path)", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++) s += geometric.pay_off_price(path);
+        return s;
+    });
+
+    // The same pay-offs without virtual calls: the policy form of the Asian
+    // options and the batch evaluate() of the pay-off hierarchy
+    ArithmeticAsianOption<PayOffCall> arithmetic_policy(pay_off_call);
+    GeometricAsianOption<PayOffCall> geometric_policy(pay_off_call);
+    bench.run("ArithmeticAsianOption<PayOffCall> (per path)", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++) s += arithmetic_policy.pay_off_price(path);
+        return s;
+    });
+    bench.run("GeometricAsianOption<PayOffCall> (per path)", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++) s += geometric_policy.pay_off_price(path);
+        return s;
+    });
+    // Analytic approximations of the same arithmetic Asian, per strike once
+    // the fixing schedule has been set up
+    const size_t NUM_STRIKES = 64;
+    vector<double> approx_phi(NUM_STRIKES, 1.0), approx_K(NUM_STRIKES), approx_price(NUM_STRIKES);
+    for (size_t i = 0; i < NUM_STRIKES; i++) approx_K[i] = 80.0 + 40.0 * i / (NUM_STRIKES - 1);
+    vector<double> fixing_times = ArithmeticAsianApproximation::path_fixing_times(1.0, NUM_STEPS);
+    bench.run("ArithmeticAsianApproximation setup", 1, [&]() {
+        return ArithmeticAsianApproximation(100.0, 0.04, 0.2, 1.0, fixing_times).average_forward();
+    });
+    ArithmeticAsianApproximation approx(100.0, 0.04, 0.2, 1.0, fixing_times);
+    for (AsianApproximation m : {ASIAN_TURNBULL_WAKEMAN, ASIAN_LEVY, ASIAN_CURRAN}) {
+        bench.run(string("Asian ") + asian_approximation_name(m) + " (per strike)", NUM_STRIKES, [&]() {
+            approx.prices(m, &approx_phi[0], &approx_K[0], &approx_price[0], NUM_STRIKES);
+            return approx_price[NUM_STRIKES / 2];
+        });
+    }
+
+    const PayOff& pay_off_ref = pay_off_call;
+    bench.run("PayOff::operator() virtual", BATCH, [&]() {
+        double s = 0.0;
+        for (size_t i = 0; i < BATCH; i++) s += pay_off_ref(in.K[i]);
+        return s;
+    });
+    bench.run("PayOff::evaluate batch", BATCH, [&]() {
+        pay_off_ref.evaluate(&in.K[0], &prices[0], BATCH);
+        return prices[BATCH / 3];
+    });
+
+    for (const BenchmarkResult& r : bench.all_results()) {
+        if (r.name == "calc_call_price") {
+            cout << "\nVanilla call throughput: " << fixed << setprecision(0)
+                 << 1e9 / r.median_ns << " options/second (single thread)\n";
+        }
+    }
+
+    if (!json_path.empty()) {
+        if (!bench.write_json(json_path)) return 1;
+        cout << "Results written to " << json_path << endl;
+    }
+    return 0;
+}
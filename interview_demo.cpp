@@ -10,6 +10,7 @@
 #include "src/option_pricing/exotic/asian.h"
 #include "src/option_pricing/monte_carlo/path_generation.h"
 #include "src/implied_volatility/interval_bisection.h"
+#include "src/memory/scratch_arena.h"
 
 using namespace std;
 using namespace chrono;
@@ -234,8 +235,12 @@ public:
         double T = 0.25;
         double sigma = 0.16;
         
+        // The grid and the prices are scratch memory for this run: they come
+        // from the thread's arena, which is rewound when the scope closes
+        ScratchScope scratch;
+        
         // Generate strike grid
-        vector<double> strikes;
+        pmr::vector<double> strikes(scratch_resource());
         for (double k = 5800; k <= 7100; k += 10) {
             strikes.push_back(k);
         }
@@ -244,7 +249,9 @@ public:
         
         auto start = high_resolution_clock::now();
         
-        vector<double> call_prices, put_prices;
+        pmr::vector<double> call_prices(scratch_resource()), put_prices(scratch_resource());
+        call_prices.reserve(strikes.size());
+        put_prices.reserve(strikes.size());
         for (double K : strikes) {
             VanillaOption opt(K, r, T, spot, sigma);
             call_prices.push_back(opt.calc_call_price());
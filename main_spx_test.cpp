@@ -1,49 +1,71 @@
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <iomanip>
 #include <ctime>
 #include <map>
 #include <string>
 #include <cmath>
+#include <chrono>
+#include <sstream>
+#include <memory>
+#include <fstream>
+#include <limits>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <unistd.h>
 
 // Option pricing headers
 #include "src/option_pricing/vanilla/vanilla_option.h"
+#include "src/option_pricing/vanilla/black_scholes.h"
+#include "src/option_pricing/vanilla/lazy_option.h"
 #include "src/option_pricing/vanilla/payoff.h"
 #include "src/option_pricing/exotic/asian.h"
+#include "src/option_pricing/exotic/asian_policy.h"
+#include "src/option_pricing/exotic/digital.h"
+#include "src/option_pricing/exotic/asian_approximation.h"
+#include "src/option_pricing/exotic/payoff_double_digital.h"
 #include "src/option_pricing/monte_carlo/path_generation.h"
 
 // Math library headers
 #include "src/math/statistics/statistics.h"
+#include "src/math/statistics/accumulators.h"
 #include "src/math/random/linear_congruential_generator.h"
 
+// Market data headers
+#include "src/market_data/market_data.h"
+#include "src/market_data/csv_loader.h"
+#include "src/market_data/snapshot.h"
+#include "src/market_data/option_chain.h"
+#include "src/market_data/tick_replay.h"
+#include "src/market_data/yield_curve.h"
+#include "src/market_data/quote.h"
+
+// Volatility surface headers
+#include "src/volatility/svi.h"
+#include "src/volatility/vol_surface.h"
+
+// Risk headers
+#include "src/risk/position_set.h"
+#include "src/risk/scenarios.h"
+#include "src/risk/scenario_engine.h"
+#include "src/risk/portfolio.h"
+
+// Instrumentation (compiled out unless built with make INSTRUMENT=1)
+#include "src/instrumentation/instrumentation.h"
+#include "src/instrumentation/allocation_tracker.h"
+#include "src/memory/scratch_arena.h"
+#include "src/pipeline/snapshot_pipeline.h"
+#include "src/math/matrix/simplematrix.h"
+#include "src/simd/simd_kernels.h"
+
 // Implied volatility headers
 #include "src/implied_volatility/interval_bisection.h"
 #include "src/implied_volatility/newton_raphson.h"
 
 using namespace std;
 
-// Structure to hold option market data
-struct OptionData {
-    string expiry_date;
-    double days_to_expiry;
-    double strike;
-    double bid;
-    double ask;
-    double mid_price;
-    double volume;
-    double open_interest;
-    double implied_vol;
-    char type; // 'C' for call, 'P' for put
-};
-
-// Structure to hold SPX market data
-struct MarketData {
-    double spot_price;
-    double risk_free_rate;
-    string date;
-    map<string, vector<OptionData>> option_chains; // Key: expiry date
-};
-
 void print_separator() {
     cout << "\n" << string(80, '=') << "\n";
 }
@@ -197,38 +219,28 @@ void test_black_scholes_pricing(const MarketData& market) {
 }
 
 // Test implied volatility calculation
-void test_implied_volatility(const MarketData& market) {
+void test_implied_volatility(const OptionChain& chain) {
     print_separator();
     cout << "IMPLIED VOLATILITY CALCULATION TEST\n";
     print_separator();
     
     // Test with a specific option
-    string test_expiry = "2025-10-17"; // October monthly
-    auto& chain = market.option_chains.at(test_expiry);
+    int expiry = chain.find_expiry("2025-10-17"); // October monthly
     
     // Find an ATM call option
-    const OptionData* atm_call = nullptr;
-    double min_diff = 1e9;
-    for (const auto& opt : chain) {
-        if (opt.type == 'C') {
-            double diff = abs(opt.strike - market.spot_price);
-            if (diff < min_diff) {
-                min_diff = diff;
-                atm_call = &opt;
-            }
-        }
-    }
+    size_t atm_call = (expiry >= 0) ?
+        chain.nearest_strike(expiry, CHAIN_CALLS, chain.spot_price()) : chain.size();
     
-    if (atm_call) {
+    if (atm_call < chain.size()) {
         cout << "Testing ATM Call Option:\n";
-        cout << "  Expiry: " << atm_call->expiry_date << endl;
-        cout << "  Strike: $" << fixed << setprecision(0) << atm_call->strike << endl;
-        cout << "  Market Price: $" << fixed << setprecision(2) << atm_call->mid_price << endl;
+        cout << "  Expiry: " << chain.expiry_date(expiry) << endl;
+        cout << "  Strike: $" << fixed << setprecision(0) << chain.strike(atm_call) << endl;
+        cout << "  Market Price: $" << fixed << setprecision(2) << chain.mid_price(atm_call) << endl;
         cout << "  Market Impl Vol: " << fixed << setprecision(1) 
-             << atm_call->implied_vol * 100 << "%\n";
+             << chain.implied_vol(atm_call) * 100 << "%\n";
         
         // Calculate implied volatility using bisection method
-        double T = atm_call->days_to_expiry / 365.0;
+        double T = chain.days_to_expiry(expiry) / 365.0;
         
         class CallPriceFunctor {
         public:
@@ -242,25 +254,25 @@ void test_implied_volatility(const MarketData& market) {
             }
         };
         
-        CallPriceFunctor price_func(atm_call->strike, market.risk_free_rate, 
-                                   T, market.spot_price);
+        CallPriceFunctor price_func(chain.strike(atm_call), chain.zero_rate(expiry), 
+                                   T, chain.spot_price());
         
         double vol_lower = 0.01;
         double vol_upper = 1.0;
         double epsilon = 0.0001;
         
-        double calculated_iv = interval_bisection(atm_call->mid_price, vol_lower, 
+        double calculated_iv = interval_bisection(chain.mid_price(atm_call), vol_lower, 
                                                  vol_upper, epsilon, price_func);
         
         cout << "\nCalculated Impl Vol: " << fixed << setprecision(1) 
              << calculated_iv * 100 << "%\n";
         cout << "Difference: " << fixed << setprecision(2) 
-             << abs(calculated_iv - atm_call->implied_vol) * 100 << "%\n";
+             << abs(calculated_iv - chain.implied_vol(atm_call)) * 100 << "%\n";
     }
 }
 
 // Test volatility surface
-void test_volatility_surface(const MarketData& market) {
+void test_volatility_surface(const OptionChain& chain) {
     print_separator();
     cout << "VOLATILITY SURFACE ANALYSIS\n";
     print_separator();
@@ -283,24 +295,14 @@ void test_volatility_surface(const MarketData& market) {
     cout << "\n" << string(50, '-') << "\n";
     
     for (double level : strike_levels) {
-        double strike = market.spot_price * level;
+        double strike = chain.spot_price() * level;
         cout << setw(7) << fixed << setprecision(0) << level * 100 << "%  ";
         
         for (const auto& expiry : test_expiries) {
-            const auto& chain = market.option_chains.at(expiry);
-            
             // Find closest strike call option
-            double min_diff = 1e9;
-            double impl_vol = 0;
-            for (const auto& opt : chain) {
-                if (opt.type == 'C') {
-                    double diff = abs(opt.strike - strike);
-                    if (diff < min_diff) {
-                        min_diff = diff;
-                        impl_vol = opt.implied_vol;
-                    }
-                }
-            }
+            int e = chain.find_expiry(expiry);
+            size_t row = (e >= 0) ? chain.nearest_strike(e, CHAIN_CALLS, strike) : chain.size();
+            double impl_vol = (row < chain.size()) ? chain.implied_vol(row) : 0.0;
             
             cout << setw(6) << fixed << setprecision(1) << impl_vol * 100 << "%   ";
         }
@@ -312,8 +314,743 @@ void test_volatility_surface(const MarketData& market) {
     cout << "- Term structure shows slight increase with time\n";
 }
 
+// Calibrate an SVI slice per expiry, then recalibrate a shifted snapshot
+void test_svi_calibration(const OptionChain& chain) {
+    print_separator();
+    cout << "SVI VOLATILITY SURFACE CALIBRATION\n";
+    print_separator();
+    
+    SviSurface surface;
+    auto t0 = chrono::steady_clock::now();
+    surface.calibrate(chain);
+    auto t1 = chrono::steady_clock::now();
+    
+    cout << "Expiry       Points  Iter      a         b        rho       m       sigma   RMSE(vol)\n";
+    cout << "----------   ------  ----   -------   -------   ------   ------   ------   ---------\n";
+    int cold_iterations = 0;
+    for (size_t i = 0; i < surface.num_slices(); i++) {
+        const SviSlice& s = surface.slice(i);
+        cold_iterations += s.iterations;
+        cout << s.expiry_date << "   " << setw(6) << s.num_points << "  " << setw(4) << s.iterations
+             << "   " << setw(7) << fixed << setprecision(5) << s.params.a
+             << "   " << setw(7) << setprecision(4) << s.params.b
+             << "   " << setw(6) << setprecision(3) << s.params.rho
+             << "   " << setw(6) << setprecision(3) << s.params.m
+             << "   " << setw(6) << setprecision(3) << s.params.sigma
+             << "   " << setw(9) << scientific << setprecision(2) << s.rmse_vol << fixed << endl;
+    }
+    
+    // Next snapshot: vols up 1%, fitted from the previous parameters
+    OptionChain next = chain;
+    for (size_t row = 0; row < next.size(); row++) {
+        next.set_implied_vol(row, next.implied_vol(row) * 1.01);
+    }
+    auto t2 = chrono::steady_clock::now();
+    surface.calibrate(next);
+    auto t3 = chrono::steady_clock::now();
+    
+    int warm_iterations = 0;
+    for (size_t i = 0; i < surface.num_slices(); i++) warm_iterations += surface.slice(i).iterations;
+    
+    cout << "\nCold calibration: " << setprecision(3)
+         << chrono::duration<double, milli>(t1 - t0).count() << " ms, " << cold_iterations << " LM iterations\n";
+    cout << "Warm recalibration: " << setprecision(3)
+         << chrono::duration<double, milli>(t3 - t2).count() << " ms, " << warm_iterations << " LM iterations\n";
+}
+
+// Query the interpolated surface between and across listed expiries
+void test_vol_surface_queries(const OptionChain& chain) {
+    print_separator();
+    cout << "INTERPOLATED VOLATILITY SURFACE\n";
+    print_separator();
+    
+    SviSurface svi;
+    svi.calibrate(chain);
+    VolSurface svi_surface;
+    svi_surface.build(svi, chain.spot_price(), chain.yield_curve());
+    VolSurface market_surface;
+    market_surface.build(chain);
+    
+    double S = chain.spot_price();
+    double maturities[] = {10.0, 45.0, 60.0, 120.0};
+    double moneyness[] = {0.90, 0.95, 1.00, 1.05, 1.10};
+    
+    cout << "Implied vol (%) from SVI slices / market quotes:\n";
+    cout << "Days ";
+    for (double m : moneyness) cout << "      " << setw(3) << fixed << setprecision(0) << m * 100 << "%     ";
+    cout << endl;
+    for (double days : maturities) {
+        double T = days / 365.0;
+        cout << setw(4) << setprecision(0) << days << " ";
+        for (double m : moneyness) {
+            cout << "  " << setw(5) << setprecision(2) << svi_surface.vol(m * S, T) * 100
+                 << "/" << setw(5) << market_surface.vol(m * S, T) * 100 << " ";
+        }
+        cout << endl;
+    }
+    
+    // Batch lookups: one shared expiry, then independent (K, T) pairs
+    const size_t n = 1000000;
+    vector<double> K(n), T(n), vols(n);
+    for (size_t i = 0; i < n; i++) {
+        K[i] = S * (0.8 + 0.4 * i / n);
+        T[i] = (7.0 + (i % 180)) / 365.0;
+    }
+    
+    auto t0 = chrono::steady_clock::now();
+    svi_surface.vols(K.data(), 60.0 / 365.0, vols.data(), n);
+    auto t1 = chrono::steady_clock::now();
+    double sum_shared = 0.0;
+    for (double v : vols) sum_shared += v;
+    
+    auto t2 = chrono::steady_clock::now();
+    svi_surface.vols(K.data(), T.data(), vols.data(), n);
+    auto t3 = chrono::steady_clock::now();
+    double sum_pairs = 0.0;
+    for (double v : vols) sum_pairs += v;
+    
+    cout << "\nBatch lookups (" << n << " strikes):\n";
+    cout << "  Shared expiry: " << setprecision(1)
+         << chrono::duration<double, nano>(t1 - t0).count() / n << " ns/lookup (mean vol "
+         << setprecision(2) << sum_shared / n * 100 << "%)\n";
+    cout << "  (K, T) pairs:  " << setprecision(1)
+         << chrono::duration<double, nano>(t3 - t2).count() / n << " ns/lookup (mean vol "
+         << setprecision(2) << sum_pairs / n * 100 << "%)\n";
+}
+
+// Bootstrap a term structure and reprice the chain off its cached discount factors
+void test_yield_curve(const OptionChain& chain) {
+    print_separator();
+    cout << "YIELD CURVE BOOTSTRAP\n";
+    print_separator();
+    
+    // Deposits, 3-month futures and annual swaps, roughly an inverted USD curve
+    vector<CurveInstrument> instruments = {
+        {CURVE_DEPOSIT, 0.0, 1.0 / 12.0, 0.0445, 0},
+        {CURVE_DEPOSIT, 0.0, 0.25, 0.0440, 0},
+        {CURVE_FUTURE, 0.25, 0.50, 0.0420, 0},
+        {CURVE_FUTURE, 0.50, 0.75, 0.0405, 0},
+        {CURVE_SWAP, 0.0, 1.0, 0.0400, 1},
+        {CURVE_SWAP, 0.0, 2.0, 0.0385, 1},
+        {CURVE_SWAP, 0.0, 3.0, 0.0378, 1},
+        {CURVE_SWAP, 0.0, 5.0, 0.0378, 1},
+        {CURVE_SWAP, 0.0, 10.0, 0.0395, 1}
+    };
+    
+    YieldCurve linear_zero;
+    YieldCurve log_linear;
+    if (!linear_zero.bootstrap(instruments, CURVE_LINEAR_ZERO) ||
+        !log_linear.bootstrap(instruments, CURVE_LOG_LINEAR_DF)) {
+        cout << "Bootstrap failed\n";
+        return;
+    }
+    
+    cout << "Maturity   Zero (linear)   Zero (log-linear DF)   3M fwd (log-linear DF)\n";
+    cout << "--------   -------------   --------------------   ----------------------\n";
+    double maturities[] = {0.1, 0.25, 0.5, 1.0, 2.0, 3.0, 5.0, 7.0, 10.0};
+    for (double T : maturities) {
+        cout << setw(7) << fixed << setprecision(2) << T << "y   "
+             << setw(12) << setprecision(4) << linear_zero.zero_rate(T) * 100 << "%   "
+             << setw(19) << log_linear.zero_rate(T) * 100 << "%   "
+             << setw(21) << log_linear.forward_rate(T, T + 0.25) * 100 << "%\n";
+    }
+    
+    // Reprice every listed option, once evaluating exp(-rT) per option and
+    // once with the discount factors the chain cached for each expiry
+    OptionChain curved = chain;
+    curved.set_yield_curve(log_linear);
+    const int repeats = 200;
+    double sum_exp = 0.0;
+    double sum_cached = 0.0;
+    
+    auto t0 = chrono::steady_clock::now();
+    for (int rep = 0; rep < repeats; rep++) {
+        for (size_t e = 0; e < curved.num_expiries(); e++) {
+            double T = curved.days_to_expiry(e) / 365.0;
+            double r = curved.zero_rate(e);
+            for (int side = 0; side < CHAIN_NUM_SIDES; side++) {
+                ChainSide s = static_cast<ChainSide>(side);
+                for (size_t row = curved.begin(e, s); row < curved.end(e, s); row++) {
+                    sum_exp += calc_black_scholes_greeks(s == CHAIN_CALLS, curved.spot_price(), curved.strike(row),
+                                                         r, T, curved.implied_vol(row)).price;
+                }
+            }
+        }
+    }
+    auto t1 = chrono::steady_clock::now();
+    for (int rep = 0; rep < repeats; rep++) {
+        for (size_t e = 0; e < curved.num_expiries(); e++) {
+            double T = curved.days_to_expiry(e) / 365.0;
+            double r = curved.zero_rate(e);
+            double df = curved.discount_factor(e);
+            for (int side = 0; side < CHAIN_NUM_SIDES; side++) {
+                ChainSide s = static_cast<ChainSide>(side);
+                for (size_t row = curved.begin(e, s); row < curved.end(e, s); row++) {
+                    sum_cached += calc_black_scholes_greeks(s == CHAIN_CALLS, curved.spot_price(), curved.strike(row),
+                                                            r, T, curved.implied_vol(row), df).price;
+                }
+            }
+        }
+    }
+    auto t2 = chrono::steady_clock::now();
+    
+    size_t prices = repeats * curved.size();
+    cout << "\nExpiry       Days   Discount factor   Zero rate\n";
+    for (size_t e = 0; e < curved.num_expiries(); e++) {
+        cout << curved.expiry_date(e) << "   " << setw(4) << setprecision(0) << curved.days_to_expiry(e)
+             << "   " << setw(15) << setprecision(6) << curved.discount_factor(e)
+             << "   " << setw(8) << setprecision(4) << curved.zero_rate(e) * 100 << "%\n";
+    }
+    cout << "\nChain repricing (" << prices << " prices):\n";
+    cout << "  exp per option:        " << setprecision(1)
+         << chrono::duration<double, nano>(t1 - t0).count() / prices << " ns/price\n";
+    cout << "  Cached discount factor: " << setprecision(1)
+         << chrono::duration<double, nano>(t2 - t1).count() / prices << " ns/price"
+         << " (mean difference " << scientific << setprecision(1) << fabs(sum_exp - sum_cached) / prices
+         << fixed << ")\n";
+}
+
+// Historical and Monte Carlo VaR/ES of a large book by full revaluation
+void test_scenario_risk(const OptionChain& chain) {
+    print_separator();
+    cout << "SCENARIO VaR / EXPECTED SHORTFALL\n";
+    print_separator();
+    
+    // A book of random long and short positions in the listed options
+    srand(7);
+    PositionSet positions;
+    const size_t num_positions = 2000;
+    positions.reserve(num_positions);
+    while (positions.size() < num_positions) {
+        size_t row = rand() % chain.size();
+        size_t e = 0;
+        while (chain.end(e, CHAIN_PUTS) <= row) e++;
+        double T = chain.days_to_expiry(e) / 365.0;
+        if (T <= 0.0 || !(chain.implied_vol(row) > 0.0)) continue;
+        double contracts = (rand() % 41) - 20;
+        positions.add(0, row < chain.end(e, CHAIN_CALLS), chain.strike(row), T,
+                      chain.implied_vol(row), contracts * 100);
+    }
+    
+    vector<double> spots(1, chain.spot_price());
+    ScenarioEngine engine(positions, spots, chain.yield_curve());
+    
+    // One-day Monte Carlo scenarios: spot, vol and rate moves
+    McScenarioModel model;
+    model.spot_vols.assign(1, 0.18);
+    model.vol_of_vols.assign(1, 0.16);
+    model.spot_correlation = 1.0;
+    model.spot_vol_correlation = -0.7;
+    model.rate_vol = 0.01;
+    model.horizon = 1.0 / 252.0;
+    ScenarioSet mc;
+    mc_scenarios(model, 10000, 12345, mc);
+    
+    // Historical scenarios from two years of simulated daily closes
+    size_t days = 505;
+    vector<double> spot_history(days), vol_history(days), rate_history(days);
+    spot_history[0] = chain.spot_price();
+    vol_history[0] = 0.16;
+    rate_history[0] = chain.risk_free_rate();
+    for (size_t d = 1; d < days; d++) {
+        double z = ((rand() % 2001) - 1000) / 1000.0 * sqrt(3.0);
+        double vol_move = ((rand() % 2001) - 1000) / 1000.0 * sqrt(3.0);
+        spot_history[d] = spot_history[d-1] * exp(vol_history[d-1] / sqrt(252.0) * z);
+        vol_history[d] = max(0.08, vol_history[d-1] + 0.05 * (0.16 - vol_history[d-1])
+                             - 0.006 * z + 0.004 * vol_move);
+        rate_history[d] = rate_history[d-1] + 0.0005 * ((rand() % 2001) - 1000) / 1000.0;
+    }
+    ScenarioSet historical;
+    historical_scenarios(spot_history, vol_history, rate_history, 1, 1, historical);
+    
+    // Delta-gamma-vega within the default error budget, which falls back
+    // to full revaluation for the short-dated near-the-money positions, and
+    // with an unlimited budget, i.e. the expansion alone: O(underlyings) per
+    // scenario, at the cost of its error in the tail
+    RiskEngineOptions options;
+    RiskReport mc_report, hist_report, mc_approx, hist_approx, mc_expansion, hist_expansion;
+    engine.full_revaluation(mc, options, mc_report);
+    engine.full_revaluation(historical, options, hist_report);
+    engine.approximation(mc, options, mc_approx);
+    engine.approximation(historical, options, hist_approx);
+    RiskEngineOptions expansion_options = options;
+    expansion_options.approximation_tolerance = numeric_limits<double>::infinity();
+    expansion_options.contributions = false;
+    engine.approximation(mc, expansion_options, mc_expansion);
+    engine.approximation(historical, expansion_options, hist_expansion);
+    
+    cout << "Positions: " << positions.size() << "   Book value: $" << fixed << setprecision(0)
+         << engine.value() << endl;
+    cout << "\nMethod             Scenarios   Revalued    Mean P&L     St. dev.     99% VaR      99% ES     Time (ms)\n";
+    cout << "----------------   ---------   --------   ----------   ----------   ----------   ----------   ---------\n";
+    const RiskReport* reports[] = {&mc_report, &mc_approx, &mc_expansion,
+                                   &hist_report, &hist_approx, &hist_expansion};
+    const char* names[] = {"MC full", "MC delta-gamma", "MC expansion only",
+                           "Hist. full", "Hist. delta-gamma", "Hist. expansion"};
+    for (int m = 0; m < 6; m++) {
+        const RiskReport& r = *reports[m];
+        cout << left << setw(17) << names[m] << right << "  " << setw(9) << r.num_scenarios
+             << "   " << setw(8) << r.exact_positions
+             << "   " << setw(10) << setprecision(0) << r.mean_pnl << "   " << setw(10) << r.stdev_pnl
+             << "   " << setw(10) << r.var << "   " << setw(10) << r.es
+             << "   " << setw(9) << setprecision(1) << r.seconds * 1000.0 << endl;
+    }
+    cout << "(delta-gamma: expansion within a " << setprecision(0) << options.approximation_tolerance * 100
+         << "% error budget, the rest revalued; expansion only: no revaluation)\n";
+    cout << "Expansion only vs full: 99% VaR off by " << setprecision(1)
+         << 100.0 * fabs(mc_expansion.var - mc_report.var) / mc_report.var << "% (MC), "
+         << 100.0 * fabs(hist_expansion.var - hist_report.var) / hist_report.var << "% (hist.), "
+         << mc_report.seconds / mc_expansion.seconds << "x faster on the MC set\n";
+    cout << "\nMonte Carlo throughput: " << setprecision(1)
+         << mc_report.num_scenarios * positions.size() / mc_report.seconds / 1e6
+         << "M position revaluations/s on " << mc_report.threads << " thread(s)\n";
+    
+    // Largest contributors to the Monte Carlo expected shortfall
+    vector<size_t> order(positions.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    partial_sort(order.begin(), order.begin() + 5, order.end(),
+                 [&](size_t a, size_t b) { return mc_report.contributions[a] > mc_report.contributions[b]; });
+    double total_contribution = 0.0;
+    for (double c : mc_report.contributions) total_contribution += c;
+    
+    cout << "\nLargest ES contributions (worst " << mc_report.num_tail << " scenarios):\n";
+    cout << "Type  Strike   Days   Quantity   Contribution\n";
+    for (int k = 0; k < 5; k++) {
+        size_t i = order[k];
+        cout << (positions.is_call(i) ? "C     " : "P     ") << setw(6) << setprecision(0)
+             << positions.strike_column()[i] << "   " << setw(4) << positions.expiry_column()[i] * 365.0
+             << "   " << setw(8) << positions.quantity_column()[i] << "   " << setw(12)
+             << mc_report.contributions[i] << endl;
+    }
+    cout << "Sum of contributions: " << total_contribution << " (t-digest ES " << mc_report.es << ")\n";
+}
+
+// Keep book totals current through a stream of trades and amendments
+bool test_incremental_portfolio(const OptionChain& chain) {
+    print_separator();
+    cout << "INCREMENTAL PORTFOLIO AGGREGATION\n";
+    print_separator();
+    
+    // One expiry bucket per listed expiry, strike buckets in 5% moneyness steps
+    vector<double> expiry_edges, strike_edges;
+    for (size_t e = 0; e < chain.num_expiries(); e++) expiry_edges.push_back(chain.days_to_expiry(e) / 365.0);
+    for (double m = 0.85; m < 1.151; m += 0.05) strike_edges.push_back(m);
+    Portfolio book(vector<double>(1, chain.spot_price()), chain.yield_curve(), expiry_edges, strike_edges);
+    
+    srand(11);
+    auto random_trade = [&]() {
+        size_t row = rand() % chain.size();
+        size_t e = 0;
+        while (chain.end(e, CHAIN_PUTS) <= row) e++;
+        double sigma = chain.implied_vol(row) > 0.0 ? chain.implied_vol(row) : 0.2;
+        return book.add(0, row < chain.end(e, CHAIN_CALLS), chain.strike(row),
+                        chain.days_to_expiry(e) / 365.0, sigma, ((rand() % 41) - 20) * 100.0);
+    };
+    
+    const size_t num_positions = 50000;
+    vector<size_t> ids;
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i = 0; i < num_positions; i++) ids.push_back(random_trade());
+    auto t1 = chrono::steady_clock::now();
+    
+    // Intraday flow: amendments, vol remarks and replaced trades
+    const size_t num_updates = 200000;
+    auto t2 = chrono::steady_clock::now();
+    for (size_t n = 0; n < num_updates; n++) {
+        size_t& id = ids[rand() % ids.size()];
+        int action = rand() % 10;
+        if (action < 5) {
+            book.amend(id, ((rand() % 41) - 20) * 100.0);
+        } else if (action < 8) {
+            book.reprice(id, 0.10 + (rand() % 200) / 1000.0);
+        } else {
+            book.remove(id);
+            id = random_trade();
+        }
+    }
+    auto t3 = chrono::steady_clock::now();
+    
+    RiskTotals total = book.total();
+    auto t4 = chrono::steady_clock::now();
+    RiskTotals check = book.recompute_total();
+    auto t5 = chrono::steady_clock::now();
+    
+    cout << "Positions: " << book.size() << "   Cells: " << book.num_expiry_buckets() << " expiries x "
+         << book.num_strike_buckets() << " strike buckets\n";
+    cout << "  Initial load:      " << fixed << setprecision(0)
+         << chrono::duration<double, nano>(t1 - t0).count() / num_positions << " ns/position\n";
+    cout << "  Update stream:     " << chrono::duration<double, nano>(t3 - t2).count() / num_updates
+         << " ns/update (" << num_updates << " updates)\n";
+    cout << "  Total query:       " << chrono::duration<double, nano>(t4 - t3).count() << " ns\n";
+    cout << "  Full recompute:    " << chrono::duration<double, nano>(t5 - t4).count() << " ns\n";
+    cout << "  Drift vs recompute: value " << scientific << setprecision(1) << fabs(total.value - check.value)
+         << ", delta " << fabs(total.delta - check.delta) << fixed << endl;
+    
+    cout << "\nBy expiry (days)     Value ($)       Delta      Vega ($/vol pt)\n";
+    size_t groups[] = {0, 4, 8, 12, expiry_edges.size()};
+    for (int g = 0; g < 4; g++) {
+        size_t first = groups[g];
+        size_t last = groups[g + 1];
+        RiskTotals r = book.expiry_total(0, first, last);
+        cout << "  " << setw(4) << setprecision(0) << (first == 0 ? 0.0 : expiry_edges[first - 1] * 365.0 + 1)
+             << " - " << setw(4) << expiry_edges[last - 1] * 365.0 << "   " << setw(14) << r.value << "   " << setw(9) << r.delta
+             << "   " << setw(12) << r.vega / 100.0 << endl;
+    }
+    
+    cout << "\nBy moneyness          Value ($)       Delta      Vega ($/vol pt)\n";
+    for (size_t k = 0; k < book.num_strike_buckets(); k++) {
+        RiskTotals r = book.strike_total(0, k, k + 1);
+        string label = (k == 0) ? "        < 0.85" :
+                       (k == strike_edges.size()) ? "        > 1.15" : "";
+        if (label.empty()) {
+            ostringstream os;
+            os << fixed << setprecision(2) << strike_edges[k - 1] << " - " << strike_edges[k];
+            label = "  " + os.str();
+        }
+        cout << label << "   " << setw(14) << setprecision(0) << r.value << "   " << setw(9) << r.delta
+             << "   " << setw(12) << r.vega / 100.0 << endl;
+    }
+    
+    // Positions that would index past the trees or turn every total into
+    // NaN are rejected, and so are amendments and remarks of the same kind
+    double K = chain.spot_price(), nan = numeric_limits<double>::quiet_NaN();
+    size_t live = ids[0];
+    while (!book.is_active(live)) live = random_trade();
+    size_t rejected = (book.add(1, true, K, 0.25, 0.2, 100.0) == PORTFOLIO_INVALID_ID) +
+                      (book.add(0, true, K, 0.0, 0.2, 100.0) == PORTFOLIO_INVALID_ID) +
+                      (book.add(0, true, K, 0.25, 0.0, 100.0) == PORTFOLIO_INVALID_ID) +
+                      (book.add(0, true, K, 0.25, nan, 100.0) == PORTFOLIO_INVALID_ID) +
+                      (book.add(0, true, -K, 0.25, 0.2, 100.0) == PORTFOLIO_INVALID_ID) +
+                      (book.add(0, true, K, 0.25, 0.2, nan) == PORTFOLIO_INVALID_ID) +
+                      !book.amend(live, nan) + !book.reprice(live, -0.2);
+    RiskTotals after = book.total();
+    bool ok = rejected == 8 && book.size() == num_positions && after.value == total.value &&
+              after.vega == total.vega && book.underlying_total(1).value == 0.0;
+    cout << "\nInvalid positions and updates rejected: " << rejected << " of 8, totals unchanged "
+         << (ok ? "ok" : "FAILED") << endl;
+    return ok;
+}
+
+void test_lazy_instruments(const OptionChain& chain) {
+    print_separator();
+    cout << "LAZY INSTRUMENTS ON OBSERVABLE QUOTES\n";
+    print_separator();
+    
+    // Two underlyings: SPX and a second index at a tenth of its level with the
+    // same listed structure. Rates are shared, every vol node has its own quote
+    const size_t num_underlyings = 2;
+    const double scale[num_underlyings] = {1.0, 0.1};
+    vector<Quote> spots(num_underlyings);
+    vector<Quote> rates(chain.num_expiries());
+    vector<Quote> vols(num_underlyings * chain.size());
+    vector<unique_ptr<LazyVanillaOption> > options;
+    struct Inputs { size_t underlying, expiry, vol; };
+    vector<Inputs> inputs;
+    
+    for (size_t u = 0; u < num_underlyings; u++) spots[u].set_value(chain.spot_price() * scale[u]);
+    for (size_t e = 0; e < chain.num_expiries(); e++) rates[e].set_value(chain.zero_rate(e));
+    for (size_t u = 0; u < num_underlyings; u++) {
+        for (size_t e = 0; e < chain.num_expiries(); e++) {
+            for (int side = CHAIN_CALLS; side < CHAIN_NUM_SIDES; side++) {
+                for (size_t row = chain.begin(e, ChainSide(side)); row < chain.end(e, ChainSide(side)); row++) {
+                    Inputs in = {u, e, u * chain.size() + row};
+                    inputs.push_back(in);
+                    Quote& vol = vols[in.vol];
+                    vol.set_value(chain.implied_vol(row) > 0.0 ? chain.implied_vol(row) : 0.2);
+                    options.emplace_back(new LazyVanillaOption(side == CHAIN_CALLS, chain.strike(row) * scale[u],
+                                                               chain.days_to_expiry(e) / 365.0,
+                                                               spots[u], rates[e], vol));
+                }
+            }
+        }
+    }
+    
+    // Reads the whole book, returning its value, the time taken and how
+    // many options had to be recalculated
+    auto read_book = [&](double& value, double& ns, unsigned long& recalcs) {
+        unsigned long before = 0, after = 0;
+        for (auto& o : options) before += o->num_calculations();
+        auto t0 = chrono::steady_clock::now();
+        value = 0.0;
+        for (auto& o : options) value += o->price();
+        auto t1 = chrono::steady_clock::now();
+        for (auto& o : options) after += o->num_calculations();
+        ns = chrono::duration<double, nano>(t1 - t0).count();
+        recalcs = after - before;
+    };
+    
+    auto report = [&](const string& label) {
+        double value, ns;
+        unsigned long recalcs;
+        read_book(value, ns, recalcs);
+        cout << "  " << left << setw(34) << label << right << setw(8) << recalcs << setw(12) << fixed
+             << setprecision(1) << ns / 1000.0 << setw(16) << setprecision(2) << value << endl;
+    };
+    
+    cout << "Options: " << options.size() << " on " << num_underlyings << " underlyings, "
+         << spots[0].num_observers() << " observing the SPX spot\n\n";
+    cout << "  Event                             Repriced   Read (us)      Book value\n";
+    report("First read");
+    report("Read again, nothing changed");
+    spots[0].set_value(spots[0].value() * 1.001);
+    report("SPX spot tick");
+    spots[1].set_value(spots[1].value() * 0.999);
+    report("Second index spot tick");
+    vols[chain.nearest_strike(0, CHAIN_CALLS, chain.spot_price())].set_value(0.25);
+    report("One SPX vol node remarked");
+    for (int i = 0; i < 100; i++) spots[0].set_value(spots[0].value() * (i % 2 ? 1.0005 : 0.9995));
+    report("100 SPX ticks between reads");
+    rates[0].set_value(rates[0].value() + 0.0025);
+    report("Front expiry rate moved");
+    spots[0].set_value(spots[0].value());
+    report("SPX tick to the same level");
+    
+    // Without the graph every VanillaOption has to be rebuilt and repriced
+    auto t0 = chrono::steady_clock::now();
+    double eager_value = 0.0;
+    for (size_t i = 0; i < options.size(); i++) {
+        const LazyVanillaOption& o = *options[i];
+        VanillaOption v(o.strike(), rates[inputs[i].expiry].value(), o.expiry(),
+                        spots[inputs[i].underlying].value(), vols[inputs[i].vol].value());
+        eager_value += o.call() ? v.calc_call_price() : v.calc_put_price();
+    }
+    auto t1 = chrono::steady_clock::now();
+    cout << "\nRebuilding every VanillaOption instead: " << setprecision(1)
+         << chrono::duration<double, nano>(t1 - t0).count() / 1000.0 << " us (value " << setprecision(2)
+         << eager_value << ")\n";
+}
+
+// One end-of-day snapshot built entirely in scratch memory: the chain, the
+// pricing inputs, a vol matrix and the Monte Carlo path all come from the
+// thread's arena, which is rewound when the snapshot scope closes. Once the
+// arena has grown to fit a snapshot, repeating it takes nothing from the heap
+double price_scratch_snapshot(const MarketData& market) {
+    ScratchScope snapshot;
+    std::pmr::memory_resource* scratch = scratch_resource();
+
+    OptionChain chain(market, scratch);
+    size_t n = chain.size();
+    pmr::vector<double> phi(n, scratch), S(n, chain.spot_price(), scratch), K(n, scratch), r(n, scratch),
+                        T(n, scratch), sigma(n, scratch), price(n, scratch);
+    SimpleMatrix<double> atm_vols(static_cast<int>(chain.num_expiries()), CHAIN_NUM_SIDES, 0.0, scratch);
+    for (size_t e = 0; e < chain.num_expiries(); e++) {
+        for (int side = CHAIN_CALLS; side < CHAIN_NUM_SIDES; side++) {
+            for (size_t row = chain.begin(e, ChainSide(side)); row < chain.end(e, ChainSide(side)); row++) {
+                phi[row] = side == CHAIN_CALLS ? 1.0 : -1.0;
+                K[row] = chain.strike(row);
+                r[row] = chain.zero_rate(e);
+                T[row] = chain.days_to_expiry(e) / 365.0;
+                sigma[row] = chain.implied_vol(row) > 0.0 ? chain.implied_vol(row) : 0.2;
+            }
+            size_t atm = chain.nearest_strike(e, ChainSide(side), chain.spot_price());
+            if (atm < n) atm_vols.value(static_cast<int>(e), side) = sigma[atm];
+        }
+    }
+    calc_black_scholes_prices(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], &price[0], n);
+
+    pmr::vector<double> path(90, chain.spot_price(), scratch);
+    ArithmeticAsianOption<PayOffCall> asian(PayOffCall(chain.spot_price()));
+    double sum = 0.0;
+    for (int p = 0; p < 100; p++) {
+        calc_path_spot_prices(path, r[0], atm_vols.value(0, CHAIN_CALLS), 0.25);
+        sum += asian.pay_off_price(path);
+    }
+    for (size_t i = 0; i < n; i++) sum += price[i];
+    return sum;
+}
+
+void test_scratch_snapshots(const MarketData& market) {
+    print_separator();
+    cout << "SCRATCH MEMORY SNAPSHOTS\n";
+    print_separator();
+
+    cout << "Snapshot   Heap allocations   Arena peak (KB)   Arena capacity (KB)\n";
+    cout << "--------   ----------------   ---------------   -------------------\n";
+    double sink = 0.0;
+    for (int snap = 1; snap <= 5; snap++) {
+        AllocationStats stats;
+        {
+            AllocationScope scope("scratch snapshot");
+            sink += price_scratch_snapshot(market);
+            stats = scope.stats();
+        }
+        cout << setw(8) << snap << "   " << setw(16) << stats.allocations << "   "
+             << setw(15) << fixed << setprecision(1) << scratch_arena().peak_bytes_used() / 1024.0 << "   "
+             << setw(19) << scratch_arena().capacity() / 1024.0 << endl;
+    }
+    if (!allocation_tracking_enabled()) cout << "(allocation tracking is off, counts are zero)\n";
+    cout << "The first snapshot grows the arena; later ones reuse it\n";
+    cout << "  (checksum " << setprecision(2) << sink << ")\n";
+}
+
+// One snapshot from quotes to book risk as a per-expiry task graph: each
+// expiry runs parse -> IV -> SVI fit -> risk on its own, and only the
+// surface and the book total wait for all expiries
+bool test_snapshot_pipeline(const MarketData& market, const OptionChain& chain) {
+    print_separator();
+    cout << "SNAPSHOT PIPELINE (PER-EXPIRY TASK GRAPH)\n";
+    print_separator();
+    
+    // A book of random positions in the listed options
+    srand(11);
+    PositionSet positions;
+    while (positions.size() < 2000) {
+        size_t row = rand() % chain.size();
+        size_t e = 0;
+        while (chain.end(e, CHAIN_PUTS) <= row) e++;
+        double T = chain.days_to_expiry(e) / 365.0;
+        if (T <= 0.0 || !(chain.implied_vol(row) > 0.0)) continue;
+        positions.add(0, row < chain.end(e, CHAIN_CALLS), chain.strike(row), T,
+                      chain.implied_vol(row), ((rand() % 41) - 20) * 100.0);
+    }
+    
+    // The same snapshot with one thread, i.e. every stage one after
+    // another, and with one thread per core
+    SnapshotPipeline serial, pipeline;
+    if (!serial.run(market, positions, 1) || !pipeline.run(market, positions)) {
+        cout << "Snapshot pipeline FAILED\n";
+        return false;
+    }
+    
+    cout << "Expiry       Points  No IV  RMSE(vol)   Positions        Value        Delta         Vega\n";
+    cout << "----------   ------  -----  ---------   ---------   ----------   ----------   ----------\n";
+    for (size_t e = 0; e < pipeline.num_expiries(); e++) {
+        const SviSlice& s = pipeline.slice(e);
+        const ExpiryRisk& risk = pipeline.expiry_risk(e);
+        cout << pipeline.expiry_date(e) << "   " << setw(6) << s.num_points << "  " << setw(5)
+             << pipeline.failed_ivs(e) << "  " << setw(9) << scientific << setprecision(2) << s.rmse_vol
+             << fixed << "   " << setw(9) << risk.positions << "   " << setw(10) << setprecision(0)
+             << risk.value << "   " << setw(10) << risk.delta << "   " << setw(10) << risk.vega << endl;
+    }
+    const ExpiryRisk& book = pipeline.book_risk();
+    cout << "Book         " << setw(35) << book.positions << "   " << setw(10) << book.value
+         << "   " << setw(10) << book.delta << "   " << setw(10) << book.vega << endl;
+    cout << "Surface: " << pipeline.surface().num_expiries() << " expiries, ATM 3M vol "
+         << setprecision(2) << pipeline.surface().vol(chain.spot_price(), 0.25) * 100 << "%\n";
+    const ExpiryRisk& serial_book = serial.book_risk();
+    bool agree = serial_book.positions == book.positions && serial_book.value == book.value &&
+                 serial_book.delta == book.delta && serial_book.vega == book.vega;
+    cout << "Serial and task graph books agree: " << (agree ? "yes" : "NO (FAILED)") << endl;
+    
+    cout << "\nStage      Tasks   Time (ms)\n";
+    cout << "--------   -----   ---------\n";
+    for (int stage = 0; stage < PIPELINE_NUM_STAGES; stage++) {
+        cout << left << setw(8) << pipeline_stage_name(PipelineStage(stage)) << right << "   " << setw(5)
+             << pipeline.stage_tasks_run(PipelineStage(stage)) << "   " << setw(9) << setprecision(3)
+             << pipeline.stage_seconds(PipelineStage(stage)) * 1000.0 << endl;
+    }
+    
+    cout << "\nOne thread:\n";
+    serial.tasks().report(cout);
+    cout << "\nTask graph:\n";
+    pipeline.tasks().report(cout);
+    
+    // The next snapshot warm-starts every SVI fit
+    int cold_iterations = 0, warm_iterations = 0;
+    for (size_t e = 0; e < pipeline.num_expiries(); e++) cold_iterations += pipeline.slice(e).iterations;
+    bool warm_ok = pipeline.run(market, positions);
+    for (size_t e = 0; e < pipeline.num_expiries(); e++) warm_iterations += pipeline.slice(e).iterations;
+    cout << "\nNext snapshot: " << setprecision(3) << pipeline.tasks().wall_seconds() * 1000.0
+         << " ms wall, " << warm_iterations << " LM iterations (" << cold_iterations << " cold)"
+         << (warm_ok ? "" : ", FAILED") << "\n";
+    return agree && warm_ok;
+}
+
+// Allocation counts per test phase, and checks that the kernels meant to run
+// without touching the heap really do. Returns false if any of them allocates
+bool test_allocation_free_kernels(const OptionChain& chain) {
+    print_separator();
+    cout << "ALLOCATION ACCOUNTING\n";
+    print_separator();
+    
+    allocation_report(cout);
+    
+    // Inputs are set up before the scopes open
+    size_t n = chain.size();
+    vector<double> phi(n), S(n, chain.spot_price()), K(n), r(n), T(n), sigma(n), price(n), u(n), z(n);
+    for (size_t e = 0; e < chain.num_expiries(); e++) {
+        for (int side = CHAIN_CALLS; side < CHAIN_NUM_SIDES; side++) {
+            for (size_t row = chain.begin(e, ChainSide(side)); row < chain.end(e, ChainSide(side)); row++) {
+                phi[row] = side == CHAIN_CALLS ? 1.0 : -1.0;
+                K[row] = chain.strike(row);
+                r[row] = chain.zero_rate(e);
+                T[row] = chain.days_to_expiry(e) / 365.0;
+                sigma[row] = chain.implied_vol(row) > 0.0 ? chain.implied_vol(row) : 0.2;
+            }
+        }
+    }
+    for (size_t i = 0; i < n; i++) u[i] = (i + 0.5) / n;
+    StandardNormalDistribution snd;
+    vector<double> path(90, chain.spot_price());
+    PayOffCall pay_off(chain.spot_price());
+    AsianOptionArithmetic asian(&pay_off);
+    Quote spot(chain.spot_price()), rate(chain.zero_rate(0)), vol(0.2);
+    LazyVanillaOption lazy(true, chain.spot_price(), T[0], spot, rate, vol);
+    double sink = 0.0;
+    
+    // Takes a C string, so the label itself is not counted. Contrast rows
+    // are expected to allocate and never fail the run
+    bool passed = true;
+    auto check = [&passed](const char* name, const AllocationScope& scope, bool contrast = false) {
+        AllocationStats s = scope.stats();
+        const char* verdict = scope.allocation_free() ? "   allocation free"
+                            : contrast                ? "   allocates (expected)"
+                                                      : "   ALLOCATES (FAILED)";
+        cout << "  " << left << setw(40) << name << right << setw(8) << s.allocations << verdict << endl;
+        passed = passed && (contrast || scope.allocation_free());
+    };
+    
+    cout << "\nHot kernel                              allocations\n";
+    {
+        AllocationScope scope("hot: batch black-scholes");
+        calc_black_scholes_prices(&phi[0], &S[0], &K[0], &r[0], &T[0], &sigma[0], &price[0], n);
+        check("calc_black_scholes_prices (chain)", scope);
+    }
+    {
+        AllocationScope scope("hot: greeks");
+        for (size_t i = 0; i < n; i++) sink += calc_black_scholes_greeks(phi[i] > 0.0, S[i], K[i], r[i], T[i], sigma[i]).gamma;
+        check("calc_black_scholes_greeks (chain)", scope);
+    }
+    {
+        AllocationScope scope("hot: implied vol");
+        for (size_t i = 0; i < n; i++) {
+            double iv = calc_implied_vol(phi[i] > 0.0, price[i], S[i], K[i], r[i], T[i]);
+            if (iv == iv) sink += iv;  // NaN where the price is below intrinsic
+        }
+        check("calc_implied_vol (chain)", scope);
+    }
+    {
+        AllocationScope scope("hot: batch inv_cdf");
+        snd.inv_cdf(&u[0], &z[0], n);
+        check("inv_cdf batch", scope);
+    }
+    {
+        AllocationScope scope("hot: path and payoff");
+        for (int p = 0; p < 100; p++) {
+            calc_path_spot_prices(path, r[0], 0.2, 0.25);
+            sink += asian.pay_off_price(path);
+        }
+        check("calc_path_spot_prices + Asian pay-off", scope);
+    }
+    {
+        AllocationScope scope("hot: lazy reprice");
+        for (int i = 0; i < 100; i++) {
+            spot.set_value(chain.spot_price() * (1.0 + 0.0001 * i));
+            sink += lazy.price();
+        }
+        check("Quote tick + LazyVanillaOption::price", scope);
+    }
+    {
+        AllocationScope scope("generate_option_chain");
+        sink += generate_option_chain(chain.spot_price(), r[0], "2025-12-19", 120).size();
+        check("generate_option_chain (for contrast)", scope, true);
+    }
+    cout << "  (checksum " << setprecision(2) << sink << ")\n";
+    return passed;
+}
+
 // Test Monte Carlo pricing for exotic options
-void test_monte_carlo_asian(const MarketData& market) {
+void test_monte_carlo_asian(const MarketData& market, const YieldCurve& curve) {
     print_separator();
     cout << "MONTE CARLO ASIAN OPTION PRICING\n";
     print_separator();
@@ -333,37 +1070,152 @@ void test_monte_carlo_asian(const MarketData& market) {
     int num_paths = 10000;
     int num_steps = 90; // Daily observations
     
+    // The pay-off type is fixed here, so the policy form lets the whole path
+    // loop inline
     PayOffCall call_payoff(K);
-    AsianOptionArithmetic asian_arith(&call_payoff);
-    AsianOptionGeometric asian_geom(&call_payoff);
+    ArithmeticAsianOption<PayOffCall> asian_arith(call_payoff);
+    GeometricAsianOption<PayOffCall> asian_geom(call_payoff);
     
-    double arith_sum = 0.0;
-    double geom_sum = 0.0;
+    MomentAccumulator arith_stats;
+    MomentAccumulator geom_stats;
     
     srand(time(0));
     
-    for (int i = 0; i < num_paths; i++) {
-        vector<double> spot_prices(num_steps, market.spot_price);
-        calc_path_spot_prices(spot_prices, market.risk_free_rate, sigma, T);
-        
-        arith_sum += asian_arith.pay_off_price(spot_prices);
-        geom_sum += asian_geom.pay_off_price(spot_prices);
+    // One path buffer for the whole run, so the path loop never allocates
+    vector<double> spot_prices(num_steps, market.spot_price);
+    AllocationStats path_allocations;
+    {
+        AllocationScope path_loop("monte carlo path loop");
+        for (int i = 0; i < num_paths; i++) {
+            calc_path_spot_prices(spot_prices, market.risk_free_rate, sigma, T);
+            
+            arith_stats.add(asian_arith.pay_off_price(spot_prices));
+            geom_stats.add(asian_geom.pay_off_price(spot_prices));
+        }
+        path_allocations = path_loop.stats();
     }
     
-    double arith_price = (arith_sum / num_paths) * exp(-market.risk_free_rate * T);
-    double geom_price = (geom_sum / num_paths) * exp(-market.risk_free_rate * T);
+    double df = curve.discount(T);
+    double arith_price = arith_stats.mean() * df;
+    double geom_price = geom_stats.mean() * df;
     
     // Compare with vanilla
     VanillaOption vanilla(K, market.risk_free_rate, T, market.spot_price, sigma);
     double vanilla_price = vanilla.calc_call_price();
     
     cout << "\nMonte Carlo Results (" << num_paths << " paths):\n";
-    cout << "  Arithmetic Asian Call: $" << fixed << setprecision(2) << arith_price << endl;
-    cout << "  Geometric Asian Call:  $" << fixed << setprecision(2) << geom_price << endl;
+    cout << "  Arithmetic Asian Call: $" << fixed << setprecision(2) << arith_price
+         << " (std err " << arith_stats.std_error() * df << ")\n";
+    cout << "  Geometric Asian Call:  $" << fixed << setprecision(2) << geom_price
+         << " (std err " << geom_stats.std_error() * df << ")\n";
     cout << "  Vanilla European Call: $" << fixed << setprecision(2) << vanilla_price << endl;
+    if (allocation_tracking_enabled()) {
+        cout << "  Allocations in path loop: " << path_allocations.allocations << endl;
+    }
+
+    // Analytic approximations on the same fixings, as a check on the
+    // simulation and for indicative quotes across a strike strip
+    ArithmeticAsianApproximation approx(market.spot_price, market.risk_free_rate, sigma, T,
+                                        ArithmeticAsianApproximation::path_fixing_times(T, num_steps));
+    cout << "\nAnalytic Approximations (arithmetic call, ATM):\n";
+    for (AsianApproximation m : {ASIAN_TURNBULL_WAKEMAN, ASIAN_LEVY, ASIAN_CURRAN}) {
+        cout << "  " << left << setw(18) << asian_approximation_name(m) << right << "$" << fixed
+             << setprecision(2) << approx.price(m, true, K) << endl;
+    }
+
+    const size_t num_strikes = 41;
+    vector<double> phi(num_strikes, 1.0), strikes(num_strikes), quotes(num_strikes);
+    for (size_t i = 0; i < num_strikes; i++) strikes[i] = K * (0.9 + 0.2 * i / (num_strikes - 1));
+    auto start = chrono::high_resolution_clock::now();
+    approx.prices(ASIAN_CURRAN, &phi[0], &strikes[0], &quotes[0], num_strikes);
+    auto end = chrono::high_resolution_clock::now();
+    cout << "  Curran strip of " << num_strikes << " strikes (" << fixed << setprecision(0) << strikes[0]
+         << " to " << strikes[num_strikes - 1] << ") in "
+         << chrono::duration_cast<chrono::microseconds>(end - start).count() << " us\n";
+
     cout << "\nAsian options are cheaper due to averaging effect\n";
 }
 
+// Digital options and a range accrual marked in closed form, with Monte Carlo
+// on the same pay-offs as a cross-check
+void test_digital_options(const MarketData& market) {
+    print_separator();
+    cout << "DIGITAL AND RANGE ACCRUAL PRICING\n";
+    print_separator();
+
+    double S = market.spot_price;
+    double r = market.risk_free_rate;
+    double sigma = 0.16;
+    double T = 30.0 / 365.0;
+
+    cout << "Digitals expiring in 30 days, " << fixed << setprecision(0) << sigma * 100 << "% vol:\n";
+    cout << "Strike   Cash Call   Cash Put   Asset Call   Asset Put   Cash Delta   Cash Vega\n";
+    cout << "------   ---------   --------   ----------   ---------   ----------   ---------\n";
+    for (double moneyness : {0.95, 0.98, 1.0, 1.02, 1.05}) {
+        double K = round(S * moneyness / 5.0) * 5.0;
+        BlackScholesGreeks cash_call = calc_cash_or_nothing_greeks(true, S, K, r, T, sigma);
+        BlackScholesGreeks cash_put = calc_cash_or_nothing_greeks(false, S, K, r, T, sigma);
+        BlackScholesGreeks asset_call = calc_asset_or_nothing_greeks(true, S, K, r, T, sigma);
+        BlackScholesGreeks asset_put = calc_asset_or_nothing_greeks(false, S, K, r, T, sigma);
+        cout << setw(6) << fixed << setprecision(0) << K << "   "
+             << setw(9) << setprecision(4) << cash_call.price << "   "
+             << setw(8) << cash_put.price << "   "
+             << setw(10) << setprecision(2) << asset_call.price << "   "
+             << setw(9) << asset_put.price << "   "
+             << setw(10) << setprecision(6) << cash_call.delta << "   "
+             << setw(9) << setprecision(4) << cash_call.vega << endl;
+    }
+
+    // Range accrual: pays 1 for every daily fixing over the next 30 trading
+    // days that lands within 3% of spot. Each fixing is a double digital, so
+    // the whole note is one batch call
+    const size_t num_fixings = 30;
+    const double dt = 1.0 / 252.0;
+    double D = S * 0.97;
+    double U = S * 1.03;
+    vector<double> fix_S(num_fixings, S), fix_D(num_fixings, D), fix_U(num_fixings, U);
+    vector<double> fix_r(num_fixings, r), fix_T(num_fixings), fix_sigma(num_fixings, sigma);
+    for (size_t i = 0; i < num_fixings; i++) fix_T[i] = (i + 1) * dt;
+    vector<double> price(num_fixings), delta(num_fixings), gamma(num_fixings), vega(num_fixings);
+
+    auto start = chrono::high_resolution_clock::now();
+    calc_double_digital_greeks(&fix_S[0], &fix_D[0], &fix_U[0], &fix_r[0], &fix_T[0], &fix_sigma[0],
+                               &price[0], &delta[0], &gamma[0], &vega[0], num_fixings);
+    auto end = chrono::high_resolution_clock::now();
+    double note_price = 0.0, note_delta = 0.0, note_gamma = 0.0, note_vega = 0.0;
+    for (size_t i = 0; i < num_fixings; i++) {
+        note_price += price[i];
+        note_delta += delta[i];
+        note_gamma += gamma[i];
+        note_vega += vega[i];
+    }
+
+    // Monte Carlo on the same fixings: the path holds spot plus one price per
+    // fixing, one dt apart
+    const int num_paths = 20000;
+    PayoffDoubleDigital in_range(U, D);
+    vector<double> spot_prices(num_fixings + 1, S);
+    vector<double> fixing_df(num_fixings);
+    for (size_t i = 0; i < num_fixings; i++) fixing_df[i] = exp(-r * fix_T[i]);
+    MomentAccumulator mc_stats;
+    srand(42);
+    for (int p = 0; p < num_paths; p++) {
+        calc_path_spot_prices(spot_prices, r, sigma, (num_fixings + 1) * dt);
+        double accrued = 0.0;
+        for (size_t i = 0; i < num_fixings; i++) accrued += fixing_df[i] * in_range.value(spot_prices[i + 1]);
+        mc_stats.add(accrued);
+    }
+
+    cout << "\nRange accrual, " << num_fixings << " daily fixings in [" << fixed << setprecision(0)
+         << D << ", " << U << "]:\n";
+    cout << "  Closed form:  " << setprecision(4) << note_price << " fixings (PV)   computed in "
+         << chrono::duration_cast<chrono::nanoseconds>(end - start).count() << " ns\n";
+    cout << "  Monte Carlo:  " << mc_stats.mean() << " +/- " << mc_stats.std_error()
+         << " (" << num_paths << " paths)\n";
+    cout << "  Delta: " << scientific << setprecision(3) << note_delta
+         << "   Gamma: " << note_gamma << "   Vega: " << fixed << setprecision(4) << note_vega << endl;
+}
+
 // Test Greeks calculation
 void test_greeks(const MarketData& market) {
     print_separator();
@@ -473,53 +1325,600 @@ void test_portfolio_risk(const MarketData& market) {
     
     cout << "\nPortfolio Value: $" << fixed << setprecision(2) << total_value << endl;
     
-    // Scenario analysis
-    cout << "\nScenario Analysis:\n";
-    cout << "SPX Move    Portfolio P&L\n";
-    cout << "--------    -------------\n";
+    // Scenario ladders: full revaluation, the engine's delta-gamma-vega mode
+    // (expansion within its error budget, full revaluation for the rest) and
+    // the expansion alone. On the +-10% ladder the expansion is outside the
+    // budget for every position, so the engine revalues the whole book; on
+    // a one-day +-1% ladder it approximates
+    PositionSet positions;
+    for (const auto& pos : portfolio) {
+        positions.add(0, pos.type == 'C', pos.strike, pos.expiry_days / 365.0, sigma, pos.quantity * 100);
+    }
+    ScenarioEngine engine(positions, vector<double>(1, market.spot_price), YieldCurve(market.risk_free_rate));
+    double no_vol_shift = 0.0;
     
-    for (double pct_move = -0.10; pct_move <= 0.10; pct_move += 0.02) {
-        double new_spot = market.spot_price * (1 + pct_move);
-        double scenario_value = 0;
-        
-        for (const auto& pos : portfolio) {
-            double T = pos.expiry_days / 365.0;
-            VanillaOption opt(pos.strike, market.risk_free_rate, T, new_spot, sigma);
-            double price = (pos.type == 'C') ? opt.calc_call_price() : opt.calc_put_price();
-            scenario_value += price * pos.quantity * 100;
+    struct Ladder {
+        const char* name;
+        double step;
+        int steps;  // Each side of zero
+    };
+    const Ladder ladders[] = {{"+-10% in 2% steps", 0.02, 5}, {"+-1% in 0.25% steps (one day)", 0.0025, 4}};
+    for (const Ladder& l : ladders) {
+        ScenarioSet ladder;
+        vector<double> full_pnl;
+        for (int k = -l.steps; k <= l.steps; k++) {
+            double pct_move = k * l.step;
+            double new_spot = market.spot_price * (1 + pct_move);
+            double scenario_value = 0;
+            
+            for (const auto& pos : portfolio) {
+                double T = pos.expiry_days / 365.0;
+                VanillaOption opt(pos.strike, market.risk_free_rate, T, new_spot, sigma);
+                double price = (pos.type == 'C') ? opt.calc_call_price() : opt.calc_put_price();
+                scenario_value += price * pos.quantity * 100;
+            }
+            
+            full_pnl.push_back(scenario_value - total_value);
+            ladder.add(&pct_move, &no_vol_shift, 0.0);
         }
         
-        double pnl = scenario_value - total_value;
-        cout << setw(7) << fixed << setprecision(1) << pct_move * 100 << "%    $"
-             << setw(12) << fixed << setprecision(2) << pnl << endl;
+        RiskEngineOptions options;
+        options.contributions = false;
+        RiskReport mixed, expansion;
+        engine.approximation(ladder, options, mixed);
+        options.approximation_tolerance = numeric_limits<double>::infinity();
+        engine.approximation(ladder, options, expansion);
+        
+        cout << "\nScenario Analysis, " << l.name << ":\n";
+        cout << "SPX Move    Full revaluation    Engine (mixed)    Expansion only\n";
+        cout << "--------    ----------------    --------------    --------------\n";
+        for (size_t s = 0; s < ladder.size(); s++) {
+            cout << setw(7) << fixed << setprecision(2) << ladder.spot_returns_of(s)[0] * 100 << "%    $"
+                 << setw(15) << setprecision(2) << full_pnl[s] << "    $"
+                 << setw(13) << mixed.pnl[s] << "    $" << setw(13) << expansion.pnl[s] << endl;
+        }
+        cout << "Engine: " << positions.size() - mixed.exact_positions << " of " << positions.size()
+             << " positions by expansion, " << mixed.exact_positions << " fully revalued\n";
+    }
+}
+
+// Replay a synthetic quote stream and measure per-update latency
+void test_tick_replay(const MarketData& market) {
+    print_separator();
+    cout << "TICK REPLAY: INCREMENTAL IMPLIED VOL AND GREEKS\n";
+    print_separator();
+    
+    // The replay updates the chain in place, so work on a private copy
+    OptionChain chain(market);
+    TickReplay replay(chain);
+    
+    // One underlying move for every nine option quote updates
+    int num_updates = 20000;
+    vector<TickUpdate> updates;
+    updates.reserve(num_updates);
+    double spot = market.spot_price;
+    srand(42);
+    
+    for (int i = 0; i < num_updates; i++) {
+        TickUpdate update;
+        update.timestamp = i * 1000LL;
+        if (i % 10 == 0) {
+            spot *= 1.0 + 0.0001 * ((rand() % 21) - 10) / 10.0;
+            update.kind = TICK_UNDERLYING;
+            update.row = 0;
+            update.bid = spot;
+            update.ask = 0.0;
+        } else {
+            size_t row = rand() % chain.size();
+            double mid = chain.mid_price(row) * (1.0 + 0.002 * ((rand() % 21) - 10) / 10.0);
+            update.kind = TICK_QUOTE;
+            update.row = row;
+            update.bid = mid - 0.05;
+            update.ask = mid + 0.05;
+        }
+        updates.push_back(update);
+    }
+    
+    ReplayStats stats = replay.replay(updates);
+    
+    cout << "Options in chain:     " << chain.size() << endl;
+    cout << "Updates replayed:     " << stats.updates << " (" << stats.underlying_updates
+         << " underlying, " << stats.quote_updates << " quotes)\n";
+    cout << "Implied vol solves:   " << stats.iv_solves << " (" << stats.iv_failures << " rejected)\n";
+    cout << "Option reprices:      " << stats.reprices << endl;
+    cout << "Total time:           " << fixed << setprecision(2) << stats.seconds * 1000.0 << " ms\n";
+    cout << "\nPer-update latency (ns):\n";
+    cout << "  p50    p90    p99    p99.9    max\n";
+    cout << setprecision(0) << "  " << stats.p50_ns << "   " << stats.p90_ns << "   " << stats.p99_ns
+         << "   " << stats.p999_ns << "   " << stats.max_ns << endl;
+    
+    size_t atm = chain.nearest_strike(chain.find_expiry("2025-10-17"), CHAIN_CALLS, chain.spot_price());
+    const BlackScholesGreeks& g = replay.greeks_of(atm);
+    cout << "\nOct ATM call after replay: strike " << chain.strike(atm)
+         << ", vol " << setprecision(2) << chain.implied_vol(atm) * 100 << "%, price "
+         << g.price << ", delta " << setprecision(4) << g.delta << endl;
+}
+
+// Strike queries on a three-strike call segment and an empty put segment:
+// below the first strike, above the last, exact hits, ties and empty ranges
+bool test_chain_strike_queries() {
+    print_separator();
+    cout << "OPTION CHAIN STRIKE QUERIES\n";
+    print_separator();
+
+    MarketData market;
+    market.spot_price = 110.0;
+    market.risk_free_rate = 0.04;
+    market.date = "2025-11-19";
+    for (double K : {120.0, 100.0, 110.0}) {
+        OptionData opt = OptionData();
+        opt.expiry_date = "2025-12-19";
+        opt.days_to_expiry = 30.0;
+        opt.strike = K;
+        opt.type = 'C';
+        market.option_chains["2025-12-19"].push_back(opt);
+    }
+    OptionChain chain(market);
+    const size_t none = chain.size();
+    size_t k100 = chain.begin(0, CHAIN_CALLS), k110 = k100 + 1, k120 = k100 + 2;
+    typedef pair<size_t, size_t> Range;
+
+    struct Check {
+        const char* name;
+        bool ok;
+    };
+    const Check checks[] = {
+        {"find_expiry hit and miss", chain.find_expiry("2025-12-19") == 0 && chain.find_expiry("2025-12-20") == -1},
+        {"strikes sorted on build", chain.strike(k100) == 100.0 && chain.strike(k120) == 120.0},
+        {"nearest below first", chain.nearest_strike(0, CHAIN_CALLS, 50.0) == k100},
+        {"nearest above last", chain.nearest_strike(0, CHAIN_CALLS, 500.0) == k120},
+        {"nearest exact hit", chain.nearest_strike(0, CHAIN_CALLS, 110.0) == k110},
+        {"nearest tie goes down", chain.nearest_strike(0, CHAIN_CALLS, 105.0) == k100 &&
+                                  chain.nearest_strike(0, CHAIN_CALLS, 105.5) == k110},
+        {"nearest in empty side", chain.nearest_strike(0, CHAIN_PUTS, 110.0) == none},
+        {"find_option exact only", chain.find_option(0, CHAIN_CALLS, 120.0) == k120 &&
+                                   chain.find_option(0, CHAIN_CALLS, 119.0) == none},
+        {"range covering all", chain.strike_range(0, CHAIN_CALLS, 100.0, 120.0) == Range(k100, k120 + 1)},
+        {"range inside", chain.strike_range(0, CHAIN_CALLS, 105.0, 115.0) == Range(k110, k120)},
+        {"range of one strike", chain.strike_range(0, CHAIN_CALLS, 110.0, 110.0) == Range(k110, k120)},
+        {"range below first", chain.strike_range(0, CHAIN_CALLS, 50.0, 90.0) == Range(k100, k100)},
+        {"range above last", chain.strike_range(0, CHAIN_CALLS, 130.0, 200.0) == Range(k120 + 1, k120 + 1)},
+        {"range reversed", chain.strike_range(0, CHAIN_CALLS, 115.0, 105.0).first ==
+                           chain.strike_range(0, CHAIN_CALLS, 115.0, 105.0).second},
+        {"range in empty side", chain.strike_range(0, CHAIN_PUTS, 0.0, 1e9).first ==
+                                chain.strike_range(0, CHAIN_PUTS, 0.0, 1e9).second},
+        {"ISO keys in date order", chain.expiries_in_date_order()},
+    };
+
+    bool passed = true;
+    for (const Check& c : checks) {
+        cout << "  " << left << setw(28) << c.name << right << (c.ok ? "ok" : "FAILED") << endl;
+        passed = passed && c.ok;
+    }
+
+    // Month-first keys sort January 2026 before December 2025
+    MarketData us_dates = market;
+    us_dates.option_chains.clear();
+    us_dates.option_chains["12/19/2025"] = market.option_chains["2025-12-19"];
+    us_dates.option_chains["01/16/2026"] = market.option_chains["2025-12-19"];
+    for (OptionData& opt : us_dates.option_chains["01/16/2026"]) opt.days_to_expiry = 58.0;
+    OptionChain us_chain(us_dates);
+    bool ok = !us_chain.expiries_in_date_order();
+    cout << "  " << left << setw(28) << "month-first keys flagged" << right << (ok ? "ok" : "FAILED") << endl;
+    return passed && ok;
+}
+
+// Write a small tick file, load it against the chain and replay it; the
+// parsed updates, unmatched count and rejected lines must be exactly right
+bool test_tick_file(const MarketData& market) {
+    print_separator();
+    cout << "TICK FILE LOADER\n";
+    print_separator();
+
+    OptionChain chain(market);
+    int e = chain.find_expiry("2025-10-17");
+    size_t call = chain.nearest_strike(e, CHAIN_CALLS, market.spot_price);
+    size_t put = chain.nearest_strike(e, CHAIN_PUTS, market.spot_price);
+    ostringstream call_key, put_key;
+    call_key << chain.expiry_date(e) << "," << chain.strike(call);
+    put_key << chain.expiry_date(e) << "," << chain.strike(put);
+    const string path = "/tmp/qf_ticks_" + to_string(getpid()) + ".txt";
+
+    ofstream(path) << "# recorded ticks\n"
+                   << "\n"
+                   << "U,1000,6500.25\n"
+                   << "Q,2000," << call_key.str() << ",C,10.5,11.0\n"
+                   << "Q,3000," << put_key.str() << ",p,4.0,4.5\r\n"
+                   << "Q,4000," << chain.expiry_date(e) << ",1.5,C,1.0,1.2\n"
+                   << "Q,5000,2099-01-01," << chain.strike(call) << ",C,1.0,2.0\n"
+                   << "U,6000,6490";
+    vector<TickUpdate> updates;
+    unsigned long unmatched = 0;
+    bool ok = load_tick_file(path, chain, updates, &unmatched) && updates.size() == 4 && unmatched == 2;
+    ok = ok && updates[0].kind == TICK_UNDERLYING && updates[0].timestamp == 1000 && updates[0].bid == 6500.25 &&
+         updates[1].kind == TICK_QUOTE && updates[1].row == call && updates[1].bid == 10.5 && updates[1].ask == 11.0 &&
+         updates[2].kind == TICK_QUOTE && updates[2].row == put && updates[2].ask == 4.5 &&
+         updates[3].kind == TICK_UNDERLYING && updates[3].timestamp == 6000 && updates[3].bid == 6490.0;
+    cout << "  " << left << setw(26) << "valid file" << right << updates.size() << " updates, "
+         << unmatched << " unmatched   " << (ok ? "ok" : "FAILED") << endl;
+    bool passed = ok;
+
+    // Each file holds one good line, then the bad one
+    const string bad_lines[] = {
+        "U,1,-6500", "U,1,0", "U,1,nan", "U,1,inf", "U,x,6500", "V,1,6500",
+        "Q,1," + call_key.str() + ",X,1.0,2.0",
+        "Q,1," + call_key.str() + ",C,1.0",
+        "Q,1," + call_key.str() + ",C,nan,2.0",
+        "Q,1," + call_key.str() + ",C,-1.0,2.0",
+    };
+    int rejected = 0;
+    for (const string& line : bad_lines) {
+        ofstream(path) << "U,0,6500\n" << line << "\n";
+        vector<TickUpdate> bad;
+        if (!load_tick_file(path, chain, bad)) rejected++;
+    }
+    ok = rejected == static_cast<int>(sizeof(bad_lines) / sizeof(bad_lines[0]));
+    cout << "  " << left << setw(26) << "malformed lines" << right << rejected << " of "
+         << sizeof(bad_lines) / sizeof(bad_lines[0]) << " rejected   " << (ok ? "ok" : "FAILED") << endl;
+    passed = passed && ok;
+    remove(path.c_str());
+
+    // An invalid spot built in memory is ignored rather than poisoning the Greeks
+    TickReplay replay(chain);
+    replay.replay(updates);
+    TickUpdate bad_spot = updates[0];
+    bad_spot.bid = numeric_limits<double>::quiet_NaN();
+    replay.apply(bad_spot);
+    bad_spot.bid = -1.0;
+    replay.apply(bad_spot);
+    ok = replay.statistics().rejected == 2 && chain.spot_price() == 6490.0 &&
+         chain.bid(call) == 10.5 && std::isfinite(replay.greeks_of(call).delta) &&
+         std::isfinite(replay.greeks_of(put).gamma);
+    cout << "  " << left << setw(26) << "replay, bad spot ignored" << right << replay.statistics().rejected
+         << " rejected, spot " << fixed << setprecision(2) << chain.spot_price() << "   "
+         << (ok ? "ok" : "FAILED") << endl;
+    return passed && ok;
+}
+
+// Load a real end-of-day chain from CSV and report parser throughput
+bool test_csv_loader(const string& path, const MarketData& market, MarketData& loaded) {
+    print_separator();
+    cout << "CSV OPTION CHAIN LOADER\n";
+    print_separator();
+    
+    CsvLoadOptions options;
+    options.spot_price = market.spot_price;
+    options.risk_free_rate = market.risk_free_rate;
+    options.date = market.date;
+    
+    CsvLoadStats stats;
+    if (!load_option_chain_csv(path, options, loaded, &stats)) {
+        cout << "Failed to load " << path << endl;
+        return false;
+    }
+    
+    cout << "File: " << path << endl;
+    cout << "  Size:        " << fixed << setprecision(1) << stats.bytes / (1024.0 * 1024.0) << " MB\n";
+    cout << "  Rows loaded: " << stats.rows << " (" << stats.bad_rows << " skipped)\n";
+    cout << "  Expiries:    " << loaded.option_chains.size() << endl;
+    cout << "  Threads:     " << stats.threads << endl;
+    cout << "  Load time:   " << fixed << setprecision(3) << stats.seconds * 1000.0 << " ms\n";
+    cout << "  Throughput:  " << fixed << setprecision(0) << stats.rows_per_second << " rows/second\n";
+    return true;
+}
+
+// The same three quotes in files with the days column after the expiry,
+// before it, and absent (days then come from the ISO expiry date and the
+// quote date). Dates in other formats are kept as labels when a days column
+// exists, whatever the column order. Returns false on any mismatch
+bool test_csv_column_orders() {
+    print_separator();
+    cout << "CSV LOADER COLUMN ORDERS\n";
+    print_separator();
+
+    // Each case has three good rows, then any rows it expects to be skipped
+    struct CsvCase {
+        const char* name;
+        const char* text;
+        const char* expiry;
+        unsigned long bad_rows;
+    };
+    const CsvCase cases[] = {
+        {"expiry before days", "expiry_date,days_to_expiry,strike,type,bid,ask\n"
+                               "2025/12/19,30,6400,C,120.5,121.5\n"
+                               "2025/12/19,30,6400,P,60.0,61.0\n"
+                               "2025/12/19,30,6500,C,70.0,71.0\n", "2025/12/19", 0},
+        {"days before expiry", "days_to_expiry,strike,type,bid,ask,expiry_date\n"
+                               "30,6400,C,120.5,121.5,2025/12/19\n"
+                               "30,6400,P,60.0,61.0,2025/12/19\n"
+                               "30,6500,C,70.0,71.0,2025/12/19\n", "2025/12/19", 0},
+        {"no days column", "strike,type,bid,ask,expiry_date\n"
+                           "6400,C,120.5,121.5,2025-12-19\n"
+                           "6400,P,60.0,61.0,2025-12-19\n"
+                           "6500,C,70.0,71.0,2025-12-19\n", "2025-12-19", 0},
+        {"empty days field", "expiry_date,days_to_expiry,strike,type,bid,ask\n"
+                             "2025/12/19,30,6400,C,120.5,121.5\n"
+                             "2025/12/19,30,6400,P,60.0,61.0\n"
+                             "2025/12/19,30,6500,C,70.0,71.0\n"
+                             "2025/12/19,,6600,C,40.0,41.0\n"
+                             "2025/12/19, ,6700,C,20.0,21.0\n", "2025/12/19", 2},
+        {"bad calendar dates", "strike,type,bid,ask,expiry_date\n"
+                               "6400,C,120.5,121.5,2025-12-19\n"
+                               "6400,P,60.0,61.0,2025-12-19\n"
+                               "6500,C,70.0,71.0,2025-12-19\n"
+                               "6600,C,40.0,41.0,2024-13-45\n"
+                               "6600,C,40.0,41.0,2025-02-29\n"
+                               "6600,C,40.0,41.0,2025-00-10\n"
+                               "6600,C,40.0,41.0,2025-04-31\n", "2025-12-19", 4},
+    };
+    const string path = "/tmp/qf_csv_columns_" + to_string(getpid()) + ".csv";
+
+    CsvLoadOptions options;
+    options.spot_price = 6450.0;
+    options.date = "2025-11-19";  // 30 days before the expiry
+    options.num_threads = 1;
+
+    bool passed = true;
+    for (const CsvCase& c : cases) {
+        ofstream(path) << c.text;
+        MarketData loaded;
+        CsvLoadStats stats = CsvLoadStats();
+        bool ok = load_option_chain_csv(path, options, loaded, &stats);
+        const vector<OptionData>* chain = nullptr;
+        if (ok && loaded.option_chains.count(c.expiry)) chain = &loaded.option_chains[c.expiry];
+        ok = ok && stats.rows == 3 && stats.bad_rows == c.bad_rows && chain && chain->size() == 3 &&
+             loaded.option_chains.size() == 1;
+        for (size_t i = 0; ok && i < chain->size(); i++) {
+            ok = (*chain)[i].days_to_expiry == 30.0;
+        }
+        ok = ok && (*chain)[0].strike == 6400.0 && (*chain)[1].type == 'P' && (*chain)[2].mid_price == 70.5;
+        cout << "  " << left << setw(20) << c.name << right << stats.rows << " loaded, "
+             << stats.bad_rows << " skipped   " << (ok ? "ok" : "FAILED") << endl;
+        passed = passed && ok;
+    }
+    remove(path.c_str());
+    return passed;
+}
+
+// Write a columnar snapshot of the chain and time the zero-copy reload
+void test_snapshot(const MarketData& market, const string& path) {
+    print_separator();
+    cout << "BINARY COLUMNAR SNAPSHOT\n";
+    print_separator();
+    
+    auto t0 = chrono::steady_clock::now();
+    if (!write_market_snapshot(path, market)) {
+        cout << "Failed to write " << path << endl;
+        return;
+    }
+    auto t1 = chrono::steady_clock::now();
+    
+    MarketSnapshot snapshot;
+    if (!snapshot.open(path)) {
+        cout << "Failed to open " << path << endl;
+        return;
     }
+    auto t2 = chrono::steady_clock::now();
+    
+    // Touch every strike once so the reload time includes paging in a column
+    double strike_sum = 0.0;
+    for (double K : snapshot.column(SNAP_CALLS, SNAP_STRIKE)) strike_sum += K;
+    for (double K : snapshot.column(SNAP_PUTS, SNAP_STRIKE)) strike_sum += K;
+    auto t3 = chrono::steady_clock::now();
+    
+    size_t rows = 0;
+    for (const auto& chain : market.option_chains) rows += chain.second.size();
+    
+    cout << "File: " << path << endl;
+    cout << "  Expiries:      " << snapshot.num_expiries() << endl;
+    cout << "  Calls / Puts:  " << snapshot.num_rows(SNAP_CALLS) << " / " << snapshot.num_rows(SNAP_PUTS)
+         << " (" << rows << " rows in source)\n";
+    cout << "  Write time:    " << fixed << setprecision(3)
+         << chrono::duration<double, milli>(t1 - t0).count() << " ms\n";
+    cout << "  Open time:     " << fixed << setprecision(3)
+         << chrono::duration<double, milli>(t2 - t1).count() << " ms\n";
+    cout << "  Strike scan:   " << fixed << setprecision(3)
+         << chrono::duration<double, milli>(t3 - t2).count() << " ms (sum " << strike_sum << ")\n";
 }
 
-int main() {
+// Open hand-corrupted copies of a snapshot; each must be rejected rather
+// than mapped and read out of bounds
+bool test_corrupt_snapshots(const MarketData& market) {
+    print_separator();
+    cout << "CORRUPT SNAPSHOTS\n";
+    print_separator();
+
+    string path = "/tmp/qf_snapshot_" + to_string(getpid()) + ".snap";
+    if (!write_market_snapshot(path, market)) return false;
+    string good;
+    {
+        ifstream in(path, ios::binary);
+        good.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    SnapshotHeader header;
+    memcpy(&header, good.data(), sizeof(header));
+    size_t last = header.num_expiries - 1;
+    size_t expiry_at = header.expiry_offset + last * sizeof(SnapshotExpiry);
+    uint64_t rows = header.num_rows[SNAP_PUTS];
+    const uint64_t huge = numeric_limits<uint64_t>::max();
+    SnapshotExpiry second;
+    memcpy(&second, &good[header.expiry_offset + sizeof(SnapshotExpiry)], sizeof(second));
+    auto bits = [](double x) {
+        uint64_t b;
+        memcpy(&b, &x, sizeof(b));
+        return b;
+    };
+    uint64_t late_name;
+    memcpy(&late_name, "9999-12-", sizeof(late_name));
+
+    struct Corruption {
+        const char* name;
+        size_t offset;
+        uint64_t value;
+    };
+    const Corruption corruptions[] = {
+        {"none", 0, 0},
+        {"begin past the end", expiry_at + offsetof(SnapshotExpiry, begin[SNAP_PUTS]), rows + 1},
+        {"count one too many", expiry_at + offsetof(SnapshotExpiry, count[SNAP_PUTS]), rows + 1},
+        {"count wraps around", expiry_at + offsetof(SnapshotExpiry, count[SNAP_PUTS]), huge},
+        {"column offset wraps", offsetof(SnapshotHeader, column_offset[SNAP_CALLS][SNAP_STRIKE]), huge - 7},
+        {"row count wraps", offsetof(SnapshotHeader, num_rows[SNAP_CALLS]), (huge >> 3) + 2},
+        {"misaligned column", offsetof(SnapshotHeader, column_offset[SNAP_PUTS][SNAP_BID]),
+         header.column_offset[SNAP_PUTS][SNAP_BID] + 4},
+        {"gap between slices", header.expiry_offset + sizeof(SnapshotExpiry) + offsetof(SnapshotExpiry, begin[SNAP_CALLS]),
+         second.begin[SNAP_CALLS] + 1},
+        {"expiries out of order", header.expiry_offset + offsetof(SnapshotExpiry, name), late_name},
+        {"row of another expiry", header.expiry_index_offset[SNAP_CALLS], last},
+        {"strikes out of order", header.column_offset[SNAP_CALLS][SNAP_STRIKE], bits(1e9)},
+        {"NaN strike", header.column_offset[SNAP_PUTS][SNAP_STRIKE] + (rows - 1) * sizeof(double),
+         bits(numeric_limits<double>::quiet_NaN())},
+    };
+
+    bool passed = true;
+    for (const auto& c : corruptions) {
+        string bytes = good;
+        bool intact = c.offset == 0;
+        if (!intact) memcpy(&bytes[c.offset], &c.value, sizeof(c.value));
+        {
+            ofstream out(path, ios::binary | ios::trunc);
+            out.write(bytes.data(), static_cast<streamsize>(bytes.size()));
+        }
+        MarketSnapshot snapshot;
+        bool opened = snapshot.open(path);
+        bool ok = opened == intact;
+        cout << "  " << left << setw(24) << c.name << right << (opened ? "opened  " : "rejected")
+             << "   " << (ok ? "ok" : "FAILED") << endl;
+        passed = passed && ok;
+    }
+    remove(path.c_str());
+    return passed;
+}
+
+// Write a snapshot, open it and rebuild the MarketData; every option must
+// come back with the same fields, whatever order the source chains are in
+bool test_snapshot_round_trip(const MarketData& market) {
+    print_separator();
+    cout << "SNAPSHOT ROUND TRIP\n";
+    print_separator();
+
+    string path = "/tmp/qf_snapshot_" + to_string(getpid()) + ".snap";
+    MarketSnapshot snapshot;
+    bool ok = write_market_snapshot(path, market) && snapshot.open(path);
+    MarketData loaded;
+    if (ok) loaded = snapshot.to_market_data();
+    remove(path.c_str());
+
+    ok = ok && loaded.spot_price == market.spot_price && loaded.risk_free_rate == market.risk_free_rate &&
+         loaded.date == market.date && loaded.option_chains.size() == market.option_chains.size();
+    auto by_type_and_strike = [](const OptionData& a, const OptionData& b) {
+        return a.type != b.type ? a.type < b.type : a.strike < b.strike;
+    };
+    size_t options = 0, mismatches = 0;
+    for (const auto& chain : market.option_chains) {
+        auto it = loaded.option_chains.find(chain.first);
+        if (!ok || it == loaded.option_chains.end() || it->second.size() != chain.second.size()) {
+            ok = false;
+            break;
+        }
+        vector<OptionData> a(chain.second), b(it->second);
+        stable_sort(a.begin(), a.end(), by_type_and_strike);
+        stable_sort(b.begin(), b.end(), by_type_and_strike);
+        for (size_t i = 0; i < a.size(); i++) {
+            options++;
+            bool same = a[i].expiry_date == b[i].expiry_date && a[i].days_to_expiry == b[i].days_to_expiry &&
+                        a[i].strike == b[i].strike && a[i].bid == b[i].bid && a[i].ask == b[i].ask &&
+                        a[i].mid_price == b[i].mid_price && a[i].volume == b[i].volume &&
+                        a[i].open_interest == b[i].open_interest && a[i].implied_vol == b[i].implied_vol &&
+                        a[i].type == b[i].type;
+            mismatches += !same;
+        }
+    }
+    ok = ok && mismatches == 0;
+    cout << "  " << loaded.option_chains.size() << " expiries, " << options << " options, " << mismatches
+         << " differ   " << (ok ? "ok" : "FAILED") << endl;
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
     cout << "\n";
     cout << "============================================================\n";
     cout << "       SPX OPTIONS ANALYSIS WITH C++ QUANT LIBRARY         \n";
     cout << "                  Real Market Data Test                     \n";
     cout << "============================================================\n";
     
+    // Count allocations per test; each test below runs as a named phase
+    allocation_tracking_enable(true);
+    auto phase = [](const char* name, auto test) {
+        AllocationScope scope(name);
+        test();
+    };
+    
     // Initialize market data
-    MarketData market = initialize_spx_market_data();
+    MarketData market;
+    OptionChain chain;
+    phase("market data and chain", [&]() {
+        market = initialize_spx_market_data();
+        // Flat, strike-indexed view of the chains for nearest-strike queries
+        chain.build(market);
+    });
     
     cout << "\nMarket Date: " << market.date << endl;
     cout << "SPX Spot: $" << fixed << setprecision(2) << market.spot_price << endl;
     cout << "Risk-Free Rate: " << fixed << setprecision(2) 
          << market.risk_free_rate * 100 << "%\n";
     cout << "Option Chains Loaded: " << market.option_chains.size() << " expiries\n";
+    cout << "SIMD Kernels: " << simd_isa_name(simd_kernels().isa) << "\n";
     
     // Run all tests
-    test_black_scholes_pricing(market);
-    test_implied_volatility(market);
-    test_volatility_surface(market);
-    test_monte_carlo_asian(market);
-    test_greeks(market);
-    test_portfolio_risk(market);
+    phase("black scholes pricing", [&]() { test_black_scholes_pricing(market); });
+    phase("implied volatility", [&]() { test_implied_volatility(chain); });
+    phase("volatility surface", [&]() { test_volatility_surface(chain); });
+    phase("svi calibration", [&]() { test_svi_calibration(chain); });
+    phase("vol surface queries", [&]() { test_vol_surface_queries(chain); });
+    phase("yield curve", [&]() { test_yield_curve(chain); });
+    phase("monte carlo asian", [&]() { test_monte_carlo_asian(market, chain.yield_curve()); });
+    phase("digital options", [&]() { test_digital_options(market); });
+    phase("greeks", [&]() { test_greeks(market); });
+    phase("portfolio risk", [&]() { test_portfolio_risk(market); });
+    phase("scenario risk", [&]() { test_scenario_risk(chain); });
+    phase("lazy instruments", [&]() { test_lazy_instruments(chain); });
+    phase("tick replay", [&]() { test_tick_replay(market); });
+    phase("scratch snapshots", [&]() { test_scratch_snapshots(market); });
+
+    // Checks that fail the run, unlike the reports above
+    bool passed = true;
+    phase("csv column orders", [&]() { passed = test_csv_column_orders() && passed; });
+    phase("chain strike queries", [&]() { passed = test_chain_strike_queries() && passed; });
+    phase("tick file", [&]() { passed = test_tick_file(market) && passed; });
+    phase("corrupt snapshots", [&]() { passed = test_corrupt_snapshots(market) && passed; });
+    phase("snapshot round trip", [&]() { passed = test_snapshot_round_trip(market) && passed; });
+    phase("snapshot pipeline", [&]() { passed = test_snapshot_pipeline(market, chain) && passed; });
+    phase("incremental portfolio", [&]() { passed = test_incremental_portfolio(chain) && passed; });
+    
+    // Optionally load a recorded chain and snapshot it, e.g.
+    // ./main_spx_test spx_eod.csv spx_eod.snap
+    MarketData loaded;
+    if (argc > 1 && test_csv_loader(argv[1], market, loaded) && argc > 2) {
+        test_snapshot(loaded, argv[2]);
+    }
+    
+    passed = test_allocation_free_kernels(chain) && passed;
+    
+    if (instrumentation_enabled()) {
+        print_separator();
+        cout << "HOT-PATH INSTRUMENTATION\n";
+        print_separator();
+        instrumentation_report(cout);
+        if (instrumentation_write_json("instrumentation.json")) {
+            cout << "Written to instrumentation.json\n";
+        }
+    }
     
     print_separator();
+    if (!passed) {
+        cout << "SPX option tests FAILED\n" << endl;
+        return 1;
+    }
     cout << "All SPX option tests completed successfully!\n";
     cout << endl;
     
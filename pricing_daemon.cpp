@@ -0,0 +1,62 @@
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "src/service/pricing_server.h"
+
+using namespace std;
+
+// Pricing daemon: prices and implied vols over a Unix domain socket, see
+// src/service/pricing_protocol.h for the wire format. Runs until SIGINT or
+// SIGTERM, then prints batch sizes and latency percentiles.
+//
+//   ./pricing_daemon [socket_path] [--window-us N] [--max-batch N]
+
+static PricingServer* running_server = nullptr;
+
+static void handle_stop_signal(int) {
+    if (running_server) running_server->stop();
+}
+
+static void usage() {
+    cerr << "Usage: pricing_daemon [socket_path] [--window-us N] [--max-batch N]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    PricingServerOptions options;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--window-us") == 0 && i + 1 < argc) {
+            options.batch_window_ns = strtoull(argv[++i], nullptr, 10) * 1000;
+        } else if (strcmp(argv[i], "--max-batch") == 0 && i + 1 < argc) {
+            options.max_batch = strtoull(argv[++i], nullptr, 10);
+        } else if (argv[i][0] != '-') {
+            options.socket_path = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    PricingServer server(options);
+    if (!server.start()) return 1;
+
+    // No SA_RESTART, so a signal also cuts the poll short
+    running_server = &server;
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    cout << "Pricing daemon on " << options.socket_path << ", batch window "
+         << options.batch_window_ns / 1000 << " us, max batch " << options.max_batch << endl;
+    server.run();
+    running_server = nullptr;
+
+    cout << "Pricing daemon stopped" << endl;
+    server.report(cout);
+    return 0;
+}
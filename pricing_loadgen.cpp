@@ -0,0 +1,249 @@
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "src/option_pricing/vanilla/vanilla_option.h"
+#include "src/service/latency_histogram.h"
+#include "src/service/pricing_protocol.h"
+
+using namespace std;
+
+// Load generator for pricing_daemon. Each connection runs on its own thread
+// and keeps up to --depth requests in flight, a mix of price and implied vol
+// requests on random contracts. Every response is checked against
+// VanillaOption: prices directly, implied vols by repricing at the returned
+// volatility, as the solver converges on the price (sigma itself is poorly
+// determined where vega is small). Prints throughput and round-trip latency per request type; exits 1
+// if any response is missing, failed or wrong.
+//
+//   ./pricing_loadgen [socket_path] [--connections N] [--requests N]
+//                     [--depth N] [--iv-fraction F]
+
+static const double LOADGEN_PRICE_TOLERANCE = 1e-9;
+static const double LOADGEN_IV_PRICE_TOLERANCE = 1e-7;
+
+struct LoadgenOptions {
+    string socket_path;
+    size_t connections;
+    size_t requests;     // Per connection
+    size_t depth;
+    double iv_fraction;
+
+    LoadgenOptions()
+        : socket_path("/tmp/qf_pricing.sock"), connections(4), requests(100000), depth(32), iv_fraction(0.5) {}
+};
+
+struct LoadgenResult {
+    LatencyHistogram rtt[NUM_PRICING_REQUEST_TYPES];
+    size_t received;
+    size_t failures;  // Error status, wrong value or unknown id
+    bool connected;
+
+    LoadgenResult() : received(0), failures(0), connected(false) {}
+};
+
+static uint64_t loadgen_now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Retries for a second, so the daemon may still be starting
+static int connect_daemon(const string& path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return -1;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    for (int attempt = 0; attempt < 100; attempt++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+        close(fd);
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    return -1;
+}
+
+static bool write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static void run_connection(const LoadgenOptions& options, unsigned seed, LoadgenResult& result) {
+    int fd = connect_daemon(options.socket_path);
+    if (fd < 0) {
+        cerr << "Unable to connect to " << options.socket_path << ": " << strerror(errno) << endl;
+        return;
+    }
+    result.connected = true;
+
+    // Request i has id i
+    const size_t n = options.requests;
+    vector<uint64_t> sent_ns(n);
+    vector<PricingRequest> request(n);
+    vector<double> expected(n);  // Price for either type
+    vector<bool> answered(n, false);
+
+    mt19937_64 rng(seed);
+    uniform_real_distribution<double> moneyness(0.8, 1.2), rate(0.0, 0.05), maturity(0.1, 2.0), vol(0.1, 0.6);
+    bernoulli_distribution is_iv(options.iv_fraction), is_call(0.5);
+
+    vector<char> out;
+    vector<char> in(64 * 1024);
+    size_t in_used = 0;
+    size_t sent = 0;
+    while (result.received < n) {
+        out.clear();
+        while (sent < n && sent - result.received < options.depth) {
+            PricingRequest q;
+            q.id = static_cast<uint32_t>(sent);
+            q.is_call = is_call(rng);
+            q.reserved = 0;
+            q.S = 100.0;
+            q.K = q.S * moneyness(rng);
+            q.r = rate(rng);
+            q.T = maturity(rng);
+            double sigma = vol(rng);
+            VanillaOption option(q.K, q.r, q.T, q.S, sigma);
+            double price = q.is_call ? option.calc_call_price() : option.calc_put_price();
+            q.type = is_iv(rng) ? PRICING_IMPLIED_VOL : PRICING_PRICE;
+            q.value = q.type == PRICING_PRICE ? sigma : price;
+            request[sent] = q;
+            expected[sent] = price;
+            const char* bytes = reinterpret_cast<const char*>(&q);
+            out.insert(out.end(), bytes, bytes + sizeof(q));
+            sent++;
+        }
+        uint64_t now = loadgen_now_ns();
+        for (size_t i = sent - out.size() / sizeof(PricingRequest); i < sent; i++) sent_ns[i] = now;
+        if (!write_all(fd, out.data(), out.size())) {
+            cerr << "Connection to the daemon lost after " << result.received << " responses" << endl;
+            break;
+        }
+
+        ssize_t got = read(fd, in.data() + in_used, in.size() - in_used);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) {
+            cerr << "Connection to the daemon lost after " << result.received << " responses" << endl;
+            break;
+        }
+        in_used += static_cast<size_t>(got);
+        now = loadgen_now_ns();
+
+        size_t offset = 0;
+        PricingResponse response;
+        while (in_used - offset >= sizeof(PricingResponse)) {
+            memcpy(&response, in.data() + offset, sizeof(response));
+            offset += sizeof(response);
+            size_t id = response.id;
+            if (id >= sent || answered[id]) {
+                result.failures++;
+                continue;
+            }
+            answered[id] = true;
+            result.received++;
+            const PricingRequest& q = request[id];
+            result.rtt[q.type - 1].record(now - sent_ns[id]);
+            double price = response.result;
+            double tolerance = LOADGEN_PRICE_TOLERANCE;
+            if (q.type == PRICING_IMPLIED_VOL && response.status == PRICING_OK) {
+                VanillaOption option(q.K, q.r, q.T, q.S, response.result);
+                price = q.is_call ? option.calc_call_price() : option.calc_put_price();
+                tolerance = LOADGEN_IV_PRICE_TOLERANCE;
+            }
+            if (response.status != PRICING_OK || response.type != q.type
+                || !(fabs(price - expected[id]) <= tolerance)) {
+                if (result.failures++ == 0) {
+                    cerr << "Request " << id << " (" << pricing_request_name(q.type) << "): status "
+                         << int(response.status) << ", result " << response.result
+                         << ", price " << price << ", expected " << expected[id] << endl;
+                }
+            }
+        }
+        in_used -= offset;
+        if (offset > 0 && in_used > 0) memmove(in.data(), in.data() + offset, in_used);
+    }
+    close(fd);
+}
+
+static void usage() {
+    cerr << "Usage: pricing_loadgen [socket_path] [--connections N] [--requests N] [--depth N] [--iv-fraction F]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    LoadgenOptions options;
+    for (int i = 1; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--connections") == 0 && has_value) {
+            options.connections = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--requests") == 0 && has_value) {
+            options.requests = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--depth") == 0 && has_value) {
+            options.depth = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--iv-fraction") == 0 && has_value) {
+            options.iv_fraction = atof(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            options.socket_path = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (options.connections == 0 || options.depth == 0 || options.requests > UINT32_MAX
+        || !(options.iv_fraction >= 0.0 && options.iv_fraction <= 1.0)) {
+        usage();
+        return 1;
+    }
+
+    cout << "Load: " << options.connections << " connections x " << options.requests
+         << " requests, " << options.depth << " in flight each, "
+         << options.iv_fraction * 100.0 << "% implied vol" << endl;
+
+    vector<LoadgenResult> results(options.connections);
+    vector<thread> threads;
+    auto t0 = chrono::steady_clock::now();
+    for (size_t c = 0; c < options.connections; c++) {
+        threads.emplace_back(run_connection, cref(options), static_cast<unsigned>(12345 + c), ref(results[c]));
+    }
+    for (thread& t : threads) t.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    LoadgenResult total;
+    bool all_connected = true;
+    for (const LoadgenResult& result : results) {
+        for (int t = 0; t < NUM_PRICING_REQUEST_TYPES; t++) total.rtt[t].merge(result.rtt[t]);
+        total.received += result.received;
+        total.failures += result.failures;
+        all_connected = all_connected && result.connected;
+    }
+    size_t expected = options.connections * options.requests;
+
+    cout << "Responses: " << total.received << " of " << expected << " in " << seconds << " s, "
+         << total.received / seconds << " requests/s" << endl;
+    cout << "Round trip:" << endl;
+    LatencyHistogram::print_header(cout);
+    for (int t = 1; t <= NUM_PRICING_REQUEST_TYPES; t++) total.rtt[t - 1].print(cout, pricing_request_name(t));
+
+    if (!all_connected || total.received != expected || total.failures > 0) {
+        cout << "FAILED: " << total.failures << " bad responses, "
+             << expected - total.received << " missing" << endl;
+        return 1;
+    }
+    cout << "All responses correct" << endl;
+    return 0;
+}
@@ -0,0 +1,239 @@
+#ifndef __GOLDEN_VALUES_H
+#define __GOLDEN_VALUES_H
+
+#include <cstddef>
+
+// Reference values for the accuracy harness, computed with mpmath at 40
+// significant digits by make_golden_values.py. Do not edit by hand.
+
+struct GoldenNormal {
+    double x;
+    double value;
+};
+
+struct GoldenBlackScholes {
+    bool is_call;
+    double S, K, r, T, sigma;
+    double price, delta, gamma, vega, theta, rho;
+};
+
+struct GoldenDoubleDigital {
+    double S, D, U, r, T, sigma;
+    double price, delta, gamma, vega, theta, rho;
+};
+
+// Standard normal CDF
+const GoldenNormal GOLDEN_NORMAL_CDF[] = {
+    {-8.0, 6.22096057427178412352e-16},
+    {-6.0, 9.86587645037698140701e-10},
+    {-5.0, 2.86651571879193911674e-7},
+    {-4.0, 3.16712418331199212538e-5},
+    {-3.0, 0.00134989803163009452665},
+    {-2.5, 0.00620966532577613516698},
+    {-2.0, 0.0227501319481792072003},
+    {-1.5, 0.0668072012688580660045},
+    {-1.0, 0.158655253931457051415},
+    {-0.75, 0.226627352376868199327},
+    {-0.5, 0.308537538725986896362},
+    {-0.25, 0.401293674317076275759},
+    {-0.1, 0.460172162722971016331},
+    {0.0, 0.5},
+    {0.1, 0.539827837277028983669},
+    {0.25, 0.598706325682923724241},
+    {0.5, 0.691462461274013103638},
+    {0.75, 0.773372647623131800673},
+    {1.0, 0.841344746068542948585},
+    {1.5, 0.933192798731141933996},
+    {2.0, 0.9772498680518207928},
+    {2.5, 0.993790334674223864833},
+    {3.0, 0.998650101968369905473},
+    {4.0, 0.999968328758166880079},
+    {5.0, 0.999999713348428120806},
+    {6.0, 0.999999999013412354962},
+    {8.0, 0.999999999999999377904},
+};
+const size_t NUM_GOLDEN_NORMAL_CDF = sizeof(GOLDEN_NORMAL_CDF) / sizeof(GOLDEN_NORMAL_CDF[0]);
+
+// Standard normal inverse CDF
+const GoldenNormal GOLDEN_NORMAL_INV_CDF[] = {
+    {1e-12, -7.03448382530113193261},
+    {1e-10, -6.3613409024040561991},
+    {1e-08, -5.61200124417478872793},
+    {1e-06, -4.75342430882289895734},
+    {0.0001, -3.71901648545568055229},
+    {0.001, -3.09023230616781353536},
+    {0.01, -2.32634787404084109308},
+    {0.02425, -1.9729610513118848376},
+    {0.05, -1.64485362695147268795},
+    {0.1, -1.28155156554460043533},
+    {0.25, -0.674489750196081743202},
+    {0.4, -0.253347103135799741325},
+    {0.5, 0.0},
+    {0.6, 0.253347103135799741325},
+    {0.75, 0.674489750196081743202},
+    {0.9, 1.28155156554460059349},
+    {0.92, 1.40507156030963282479},
+    {0.95, 1.64485362695147228428},
+    {0.97575, 1.9729610513118849594},
+    {0.99, 2.32634787404084076764},
+    {0.999, 3.09023230616781327776},
+    {0.9999, 3.71901648545570838672},
+    {0.999999, 4.75342430881708776569},
+    {0.99999999, 5.6120012433055049826},
+    {0.9999999999, 6.36134088969742186416},
+};
+const size_t NUM_GOLDEN_NORMAL_INV_CDF = sizeof(GOLDEN_NORMAL_INV_CDF) / sizeof(GOLDEN_NORMAL_INV_CDF[0]);
+
+// Black-Scholes prices and Greeks (vega and rho per unit, theta per year)
+const GoldenBlackScholes GOLDEN_BLACK_SCHOLES[] = {
+    {true, 100.0, 100.0, 0.05, 1.0, 0.2,
+     10.450583572185567346, 0.636830651175619073306, 0.0187620173458468928408,
+     37.5240346916937877645, -6.41402754643819613173, 53.2324815453763399846},
+    {false, 100.0, 100.0, 0.05, 1.0, 0.2,
+     5.57352602225696799112, -0.363169348824380926694, 0.0187620173458468928408,
+     37.5240346916937877645, -1.65788042393462583546, -41.8904609046950606605},
+    {true, 100.0, 80.0, 0.03, 0.5, 0.25,
+     21.835076793998104576, 0.924432180240771983985, 0.00805375843663547426989,
+     10.0671980457943428374, -4.63504374835095844563, 35.3040706150395469113},
+    {false, 100.0, 80.0, 0.03, 0.5, 0.25,
+     0.644031962243117537773, -0.0755678197592280160145, 0.00805375843663547426989,
+     10.0671980457943428374, -2.27077509330360814427, -4.10040696908295956961},
+    {true, 100.0, 120.0, 0.03, 0.5, 0.25,
+     1.76690646021055128484, 0.195411635930290347123, 0.0156164521838836188997,
+     19.5205652298545236246, -5.41336902144818538925, 8.88712856640924171374},
+    {false, 100.0, 120.0, 0.03, 0.5, 0.25,
+     19.9803392125780707275, -0.804588364069709652877, 0.0156164521838836188997,
+     19.5205652298545236246, -1.86696603887715993721, -50.2195878097745180076},
+    {true, 6460.0, 6500.0, 0.043, 0.0821917808219178, 0.14,
+     95.2585352804504187405, 0.48178576797716697691, 0.00153703005272955255519,
+     738.080652229183866884, -758.333022426826419132, 247.978974727565595996},
+    {false, 6460.0, 6000.0, 0.043, 0.0821917808219178, 0.22,
+     20.7834688383127064958, -0.10405686763116860399, 4.43374724298219795255e-4,
+     334.570032476316938652, -417.967620946837404534, -56.9581507179996040933},
+    {true, 50.0, 55.0, 0.0, 2.0, 0.4,
+     9.35292633678944459893, 0.545522412595734867429, 0.0140128136871607866821,
+     28.02562737432157492, -2.80256273743215764757, 35.8463885859945975451},
+    {false, 50.0, 45.0, 0.0, 2.0, 0.4,
+     8.25629431260451855454, -0.319500669793352826066, 0.012635187296230773992,
+     25.2703745924615493867, -2.52703745924615507895, -48.4626556045443197157},
+    {true, 100.0, 100.0, 0.1, 5.0, 0.1,
+     39.4233099875240665409, 0.990559479921950604694, 0.00113344616637705269333,
+     5.66723083188526378125, -6.01993610878595236483, 298.163190023354969642},
+    {false, 100.0, 95.0, 0.02, 0.05, 0.6,
+     3.05491816763517882348, -0.323888266780712256434, 0.0267887193101432468408,
+     8.03661579304297420095, -47.5108198613437126404, -1.77218724228532032172},
+};
+const size_t NUM_GOLDEN_BLACK_SCHOLES = sizeof(GOLDEN_BLACK_SCHOLES) / sizeof(GOLDEN_BLACK_SCHOLES[0]);
+
+// Cash-or-nothing (unit cash) digital prices and Greeks
+const GoldenBlackScholes GOLDEN_CASH_OR_NOTHING[] = {
+    {true, 100.0, 100.0, 0.05, 1.0, 0.2,
+     0.532324815453763399846, 0.0187620173458468928408, -3.28335303552320611694e-4,
+     -0.656670607104641259841, -0.00152678524608216831207, 1.34387691913092588423},
+    {false, 100.0, 100.0, 0.05, 1.0, 0.2,
+     0.418904609046950606605, -0.0187620173458468928408, 3.28335303552320611694e-4,
+     0.656670607104641259841, 0.0490882564711178712748, -2.29510634363163989068},
+    {true, 100.0, 80.0, 0.03, 0.5, 0.25,
+     0.882601765375988672782, 0.0100671980457943428374, -8.1751624443983163503e-4,
+     -1.02189530554978954379, 0.251750285211344017756, 0.0620590196017228054775},
+    {false, 100.0, 80.0, 0.03, 0.5, 0.25,
+     0.10251017422707398924, -0.0100671980457943428374, 8.1751624443983163503e-4,
+     1.02189530554978954379, -0.222196927023252138989, -0.554614989403254136489},
+    {true, 100.0, 120.0, 0.03, 0.5, 0.25,
+     0.148118809440154028562, 0.0130137101532363490831, 6.31723206835354175195e-4,
+     0.789654008544192718993, -0.23201106831255260486, 0.576626102941740439873},
+    {false, 100.0, 120.0, 0.03, 0.5, 0.25,
+     0.83699313016290863346, -0.0130137101532363490831, -6.31723206835354175195e-4,
+     -0.789654008544192718993, 0.261564426500644483627, -1.06918207274327177088},
+    {true, 6460.0, 6500.0, 0.043, 0.0821917808219178, 0.14,
+     0.464165773208007423399, 0.00152757140625121684716, 2.69078213358496319285e-7,
+     0.129211151638586265373, -0.514414487792714650155, 0.772927028315741333195},
+    {false, 6460.0, 6000.0, 0.043, 0.0821917808219178, 0.22,
+     0.115498472289276981378, -4.77366786494416646225e-4, 1.47478559573610758003e-6,
+     1.11287143271873487746, -1.35182355386104897935, -0.262955170935058219594},
+    {true, 50.0, 55.0, 0.0, 2.0, 0.4,
+     0.325876259872678159501, 0.0127389215337825333474, -5.15049089692003993873e-5,
+     -0.103009817938400804493, 0.0103009817938400810211, 0.622139633632897015738},
+    {false, 50.0, 45.0, 0.0, 2.0, 0.4,
+     0.538473951161603552397, -0.0140390969958119711022, 2.32838876136181536247e-4,
+     0.465677752272363098344, -0.0465677752272363124194, -2.48085760190440421501},
+    {true, 100.0, 100.0, 0.1, 5.0, 0.1,
+     0.596326380046709939285, 0.00113344616637705269333, -1.19011847469590526508e-4,
+     -0.595059237347952665571, 0.0542487687143799966623, -2.41490881704502334976},
+    {false, 100.0, 95.0, 0.02, 0.05, 0.6,
+     0.373092051007435836494, -0.028198651905413944043, 9.60215706983666489558e-4,
+     0.288064712095099952198, -1.66452912773962294713, -0.159647862077441520902},
+};
+const size_t NUM_GOLDEN_CASH_OR_NOTHING = sizeof(GOLDEN_CASH_OR_NOTHING) / sizeof(GOLDEN_CASH_OR_NOTHING[0]);
+
+// Asset-or-nothing digital prices and Greeks
+const GoldenBlackScholes GOLDEN_ASSET_OR_NOTHING[] = {
+    {true, 100.0, 100.0, 0.05, 1.0, 0.2,
+     63.6830651175619073306, 2.51303238576030835738, -0.0140715130093851683287,
+     -28.1430260187703382196, -6.56670607104641296294, 187.620173458468928408},
+    {false, 100.0, 100.0, 0.05, 1.0, 0.2,
+     36.3169348824380926694, -1.51303238576030835738, 0.0140715130093851683287,
+     28.1430260187703382196, 6.56670607104641296294, -187.620173458468928408},
+    {true, 100.0, 80.0, 0.03, 0.5, 0.25,
+     92.4432180240771983985, 1.72980802390431941097, -0.0573475411185510565325,
+     -71.6844263981888206656, 15.5049790685565629748, 40.2687921831773713495},
+    {false, 100.0, 80.0, 0.03, 0.5, 0.25,
+     7.55678197592280160145, -0.729808023904319410975, 0.0573475411185510565325,
+     71.6844263981888206656, -15.5049790685565629748, -40.2687921831773713495},
+    {true, 100.0, 120.0, 0.03, 0.5, 0.25,
+     19.5411635930290347123, 1.75705685431865223709, 0.0914232370041261199231,
+     114.279046255157649904, -33.2546972189544979725, 78.0822609194180944986},
+    {false, 100.0, 120.0, 0.03, 0.5, 0.25,
+     80.4588364069709652877, -0.757056854318652237094, -0.0914232370041261199231,
+     -114.279046255157649904, 33.2546972189544979725, -78.0822609194180944986},
+    {true, 6460.0, 6500.0, 0.043, 0.0821917808219178, 0.14,
+     3112.33606113249867084, 10.4109999086100764834, 0.00328603843955977863054,
+     1577.95313787999459181, -4102.02719307947164514, 5272.00465877988426176},
+    {false, 6460.0, 6000.0, 0.043, 0.0821917808219178, 0.22,
+     672.207364897349181775, -2.76014385133533127336, 0.00840533885011842568491,
+     6342.65856383609232612, -7692.97370221945647159, -1520.77287489234971347},
+    {true, 50.0, 55.0, 0.0, 2.0, 0.4,
+     27.2761206297867433715, 1.24616309695377420154, 0.0111800436938547647158,
+     22.3600873877095306729, -2.23600873877095319141, 70.0640684358039334107},
+    {false, 50.0, 45.0, 0.0, 2.0, 0.4,
+     15.9750334896676413033, -0.312258695018185873532, -0.00215743787010260486086,
+     -4.31487574020520996124, 0.431487574020521020076, -63.1759364811538699598},
+    {true, 100.0, 100.0, 0.1, 5.0, 0.1,
+     99.0559479921950604694, 1.10390409655965587403, -0.0107677385805819999574,
+     -53.8386929029100027759, -0.595059237347952698604, 56.6723083188526346665},
+    {false, 100.0, 95.0, 0.02, 0.05, 0.6,
+     32.3888266780712256434, -2.35498366423361242765, 0.0644317728533050696672,
+     19.3295318559915212578, -110.619447273920467337, -13.3943596550716241639},
+};
+const size_t NUM_GOLDEN_ASSET_OR_NOTHING = sizeof(GOLDEN_ASSET_OR_NOTHING) / sizeof(GOLDEN_ASSET_OR_NOTHING[0]);
+
+// Double digital on [D, U] prices and Greeks
+const GoldenDoubleDigital GOLDEN_DOUBLE_DIGITAL[] = {
+    {100.0, 90.0, 110.0, 0.05, 1.0, 0.2,
+     0.360259686822752582217, -0.00289879080456817477382, -7.75388578749119218333e-4,
+     -1.55077715749823852275, 0.187584654113802365668, -0.650138767279570059599},
+    {100.0, 100.0, 120.0, 0.03, 0.5, 0.25,
+     0.343047688518729473881, 0.00921774669782709740687, -8.49591483975775946847e-4,
+     -1.06198935496971993356, 0.248135529304510576028, 0.289363490631990133403},
+    {6460.0, 6300.0, 6600.0, 0.043, 0.0821917808219178, 0.14,
+     0.433722367191974303716, -1.69283605959592920923e-4, -5.66937522974869789904e-6,
+     -2.72242963621555955239, 2.38427623536296251285, -0.125531051645831053816},
+    {50.0, 30.0, 45.0, 0.0, 2.0, 0.4,
+     0.270903630754585816824, -0.00240197057380393134964, -2.55066285794270584789e-4,
+     -0.510132571588541197896, 0.0510132571588541226214, -0.782004318889564768612},
+    {100.0, 99.0, 101.0, 0.02, 0.05, 0.6,
+     0.059254446048793282349, 2.61222738983270888422e-4, -3.30042795620618051015e-4,
+     -0.0990128386861854171367, 0.594739675560121771741, -0.0016566086075233097673},
+};
+const size_t NUM_GOLDEN_DOUBLE_DIGITAL = sizeof(GOLDEN_DOUBLE_DIGITAL) / sizeof(GOLDEN_DOUBLE_DIGITAL[0]);
+
+// Geometric Asian call on the fixings of calc_path_spot_prices
+const double GOLDEN_ASIAN_S = 100.0;
+const double GOLDEN_ASIAN_K = 100.0;
+const double GOLDEN_ASIAN_R = 0.04;
+const double GOLDEN_ASIAN_T = 1.0;
+const double GOLDEN_ASIAN_SIGMA = 0.2;
+const size_t GOLDEN_ASIAN_FIXINGS = 252;
+const double GOLDEN_ASIAN_GEOMETRIC_CALL = 5.29675560559625346365;
+
+#endif
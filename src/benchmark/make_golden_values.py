@@ -0,0 +1,182 @@
+# Regenerates golden_values.h with mpmath at 40 significant digits. Every
+# reference is computed at the exact double value of its input, so the
+# tables measure kernel error only.
+#   python3 src/benchmark/make_golden_values.py > src/benchmark/golden_values.h
+from mpmath import mp, mpf, sqrt, log, exp, ncdf, npdf, erfinv, diff
+
+mp.dps = 40
+
+def d(x):
+    # Inputs print as the shortest string that round-trips, outputs to 21 digits
+    return repr(x) if isinstance(x, float) else mp.nstr(x, 21, min_fixed=-4, max_fixed=6)
+
+def inv_ncdf(p):
+    return -sqrt(2) * erfinv(1 - 2 * p)
+
+def black_scholes(is_call, S, K, r, T, sigma):
+    S, K, r, T, sigma = map(mpf, (S, K, r, T, sigma))
+    sqrt_T = sqrt(T)
+    d1 = (log(S / K) + (r + sigma * sigma / 2) * T) / (sigma * sqrt_T)
+    d2 = d1 - sigma * sqrt_T
+    df_K = K * exp(-r * T)
+    gamma = npdf(d1) / (S * sigma * sqrt_T)
+    vega = S * npdf(d1) * sqrt_T
+    if is_call:
+        price = S * ncdf(d1) - df_K * ncdf(d2)
+        delta = ncdf(d1)
+        theta = -S * npdf(d1) * sigma / (2 * sqrt_T) - r * df_K * ncdf(d2)
+        rho = T * df_K * ncdf(d2)
+    else:
+        price = df_K * ncdf(-d2) - S * ncdf(-d1)
+        delta = -ncdf(-d1)
+        theta = -S * npdf(d1) * sigma / (2 * sqrt_T) + r * df_K * ncdf(-d2)
+        rho = -T * df_K * ncdf(-d2)
+    return price, delta, gamma, vega, theta, rho
+
+# Digital prices in closed form, Greeks by numerical differentiation of the
+# price so that they check the analytic Greeks independently
+def cash_or_nothing_price(is_call, S, K, r, T, sigma):
+    d2 = (log(S / K) + (r - sigma * sigma / 2) * T) / (sigma * sqrt(T))
+    return exp(-r * T) * ncdf(d2 if is_call else -d2)
+
+def asset_or_nothing_price(is_call, S, K, r, T, sigma):
+    d1 = (log(S / K) + (r + sigma * sigma / 2) * T) / (sigma * sqrt(T))
+    return S * ncdf(d1 if is_call else -d1)
+
+def double_digital_price(S, D, U, r, T, sigma):
+    return cash_or_nothing_price(True, S, D, r, T, sigma) - cash_or_nothing_price(True, S, U, r, T, sigma)
+
+def greeks(price, S, K, r, T, sigma):
+    S, K, r, T, sigma = map(mpf, (S, K, r, T, sigma))
+    return (price(S, K, r, T, sigma),
+            diff(lambda x: price(x, K, r, T, sigma), S),
+            diff(lambda x: price(x, K, r, T, sigma), S, 2),
+            diff(lambda x: price(S, K, r, T, x), sigma),
+            -diff(lambda x: price(S, K, r, x, sigma), T),
+            diff(lambda x: price(S, K, x, T, sigma), r))
+
+# Discretely monitored geometric Asian call with the fixings produced by
+# calc_path_spot_prices: n prices at t_i = i T / n, i = 0..n-1
+def geometric_asian_call(S, K, r, T, sigma, n):
+    S, K, r, T, sigma = map(mpf, (S, K, r, T, sigma))
+    dt = T / n
+    mu = log(S) + (r - sigma * sigma / 2) * dt * (n - 1) / 2
+    var = sigma * sigma * dt * mpf((n - 1) * n * (2 * n - 1)) / 6 / (n * n)
+    sd = sqrt(var)
+    d2 = (mu - log(K)) / sd
+    d1 = d2 + sd
+    return exp(-r * T) * (exp(mu + var / 2) * ncdf(d1) - K * ncdf(d2))
+
+cdf_x = [-8.0, -6.0, -5.0, -4.0, -3.0, -2.5, -2.0, -1.5, -1.0, -0.75, -0.5, -0.25, -0.1,
+         0.0, 0.1, 0.25, 0.5, 0.75, 1.0, 1.5, 2.0, 2.5, 3.0, 4.0, 5.0, 6.0, 8.0]
+
+inv_p = [1e-12, 1e-10, 1e-8, 1e-6, 1e-4, 1e-3, 0.01, 0.02425, 0.05, 0.1, 0.25, 0.4, 0.5,
+         0.6, 0.75, 0.9, 0.92, 0.95, 0.97575, 0.99, 0.999, 1 - 1e-4, 1 - 1e-6, 1 - 1e-8, 1 - 1e-10]
+
+bs_cases = [
+    (True, 100.0, 100.0, 0.05, 1.0, 0.2),
+    (False, 100.0, 100.0, 0.05, 1.0, 0.2),
+    (True, 100.0, 80.0, 0.03, 0.5, 0.25),
+    (False, 100.0, 80.0, 0.03, 0.5, 0.25),
+    (True, 100.0, 120.0, 0.03, 0.5, 0.25),
+    (False, 100.0, 120.0, 0.03, 0.5, 0.25),
+    (True, 6460.0, 6500.0, 0.043, 30.0 / 365.0, 0.14),
+    (False, 6460.0, 6000.0, 0.043, 30.0 / 365.0, 0.22),
+    (True, 50.0, 55.0, 0.0, 2.0, 0.4),
+    (False, 50.0, 45.0, 0.0, 2.0, 0.4),
+    (True, 100.0, 100.0, 0.1, 5.0, 0.1),
+    (False, 100.0, 95.0, 0.02, 0.05, 0.6),
+]
+
+double_digital_cases = [
+    (100.0, 90.0, 110.0, 0.05, 1.0, 0.2),
+    (100.0, 100.0, 120.0, 0.03, 0.5, 0.25),
+    (6460.0, 6300.0, 6600.0, 0.043, 30.0 / 365.0, 0.14),
+    (50.0, 30.0, 45.0, 0.0, 2.0, 0.4),
+    (100.0, 99.0, 101.0, 0.02, 0.05, 0.6),
+]
+
+asian_case = (100.0, 100.0, 0.04, 1.0, 0.2, 252)
+
+print("#ifndef __GOLDEN_VALUES_H")
+print("#define __GOLDEN_VALUES_H")
+print("")
+print("#include <cstddef>")
+print("")
+print("// Reference values for the accuracy harness, computed with mpmath at 40")
+print("// significant digits by make_golden_values.py. Do not edit by hand.")
+print("")
+print("struct GoldenNormal {")
+print("    double x;")
+print("    double value;")
+print("};")
+print("")
+print("struct GoldenBlackScholes {")
+print("    bool is_call;")
+print("    double S, K, r, T, sigma;")
+print("    double price, delta, gamma, vega, theta, rho;")
+print("};")
+print("")
+print("struct GoldenDoubleDigital {")
+print("    double S, D, U, r, T, sigma;")
+print("    double price, delta, gamma, vega, theta, rho;")
+print("};")
+print("")
+print("// Standard normal CDF")
+print("const GoldenNormal GOLDEN_NORMAL_CDF[] = {")
+for x in cdf_x:
+    print("    {%s, %s}," % (d(x), d(ncdf(mpf(x)))))
+print("};")
+print("const size_t NUM_GOLDEN_NORMAL_CDF = sizeof(GOLDEN_NORMAL_CDF) / sizeof(GOLDEN_NORMAL_CDF[0]);")
+print("")
+print("// Standard normal inverse CDF")
+print("const GoldenNormal GOLDEN_NORMAL_INV_CDF[] = {")
+for p in inv_p:
+    print("    {%s, %s}," % (d(p), d(inv_ncdf(mpf(p)))))
+print("};")
+print("const size_t NUM_GOLDEN_NORMAL_INV_CDF = sizeof(GOLDEN_NORMAL_INV_CDF) / sizeof(GOLDEN_NORMAL_INV_CDF[0]);")
+print("")
+print("// Black-Scholes prices and Greeks (vega and rho per unit, theta per year)")
+print("const GoldenBlackScholes GOLDEN_BLACK_SCHOLES[] = {")
+for c in bs_cases:
+    g = black_scholes(*c)
+    print("    {%s, %s, %s, %s, %s, %s," % ((("true" if c[0] else "false"),) + tuple(d(v) for v in c[1:])))
+    print("     %s, %s, %s," % tuple(d(v) for v in g[:3]))
+    print("     %s, %s, %s}," % tuple(d(v) for v in g[3:]))
+print("};")
+print("const size_t NUM_GOLDEN_BLACK_SCHOLES = sizeof(GOLDEN_BLACK_SCHOLES) / sizeof(GOLDEN_BLACK_SCHOLES[0]);")
+print("")
+for name, title, price in (("CASH_OR_NOTHING", "Cash-or-nothing (unit cash)", cash_or_nothing_price),
+                           ("ASSET_OR_NOTHING", "Asset-or-nothing", asset_or_nothing_price)):
+    print("// %s digital prices and Greeks" % title)
+    print("const GoldenBlackScholes GOLDEN_%s[] = {" % name)
+    for c in bs_cases:
+        g = greeks(lambda *a: price(c[0], *a), *c[1:])
+        print("    {%s, %s, %s, %s, %s, %s," % ((("true" if c[0] else "false"),) + tuple(d(v) for v in c[1:])))
+        print("     %s, %s, %s," % tuple(d(v) for v in g[:3]))
+        print("     %s, %s, %s}," % tuple(d(v) for v in g[3:]))
+    print("};")
+    print("const size_t NUM_GOLDEN_%s = sizeof(GOLDEN_%s) / sizeof(GOLDEN_%s[0]);" % (name, name, name))
+    print("")
+print("// Double digital on [D, U] prices and Greeks")
+print("const GoldenDoubleDigital GOLDEN_DOUBLE_DIGITAL[] = {")
+for c in double_digital_cases:
+    S, D, U, r, T, sigma = c
+    g = greeks(lambda S, K, r, T, sigma: double_digital_price(S, D, U, r, T, sigma), S, 0.0, r, T, sigma)
+    print("    {%s, %s, %s, %s, %s, %s," % tuple(d(v) for v in c))
+    print("     %s, %s, %s," % tuple(d(v) for v in g[:3]))
+    print("     %s, %s, %s}," % tuple(d(v) for v in g[3:]))
+print("};")
+print("const size_t NUM_GOLDEN_DOUBLE_DIGITAL = sizeof(GOLDEN_DOUBLE_DIGITAL) / sizeof(GOLDEN_DOUBLE_DIGITAL[0]);")
+print("")
+S, K, r, T, sigma, n = asian_case
+print("// Geometric Asian call on the fixings of calc_path_spot_prices")
+print("const double GOLDEN_ASIAN_S = %s;" % d(S))
+print("const double GOLDEN_ASIAN_K = %s;" % d(K))
+print("const double GOLDEN_ASIAN_R = %s;" % d(r))
+print("const double GOLDEN_ASIAN_T = %s;" % d(T))
+print("const double GOLDEN_ASIAN_SIGMA = %s;" % d(sigma))
+print("const size_t GOLDEN_ASIAN_FIXINGS = %d;" % n)
+print("const double GOLDEN_ASIAN_GEOMETRIC_CALL = %s;" % d(geometric_asian_call(S, K, r, T, sigma, n)))
+print("")
+print("#endif")
@@ -0,0 +1,128 @@
+#ifndef __MICRO_BENCHMARK_H
+#define __MICRO_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../instrumentation/allocation_tracker.h"
+
+#if defined(__clang__)
+#define MICRO_BENCHMARK_COMPILER "clang " __clang_version__
+#elif defined(__GNUC__)
+#define MICRO_BENCHMARK_COMPILER "g++ " __VERSION__
+#else
+#define MICRO_BENCHMARK_COMPILER "unknown"
+#endif
+
+// Timing of one kernel. Every run executes ops_per_run operations and the
+// statistics are over the per-operation time of each run
+struct BenchmarkResult {
+    std::string name;
+    size_t ops_per_run;
+    size_t runs;
+    double median_ns;
+    double p99_ns;
+    double min_ns;
+    double mean_ns;
+    double allocs_per_op;  // Heap allocations per operation, 0 unless tracking is enabled
+};
+
+// Runs kernels with a warm-up phase followed by repeated timed runs. A kernel
+// is a callable returning a double that depends on all of its work; results
+// are folded into a volatile sink so the optimiser cannot drop the loop.
+class MicroBenchmark {
+private:
+    size_t warmup_runs;
+    size_t timed_runs;
+    std::string filter;  // Only kernels whose name contains this are run
+    bool verbose;        // Print a table row per kernel
+    std::vector<BenchmarkResult> results;
+    volatile double sink;
+
+public:
+    MicroBenchmark(size_t _warmup_runs = 20, size_t _timed_runs = 201, const std::string& _filter = "")
+        : warmup_runs(_warmup_runs), timed_runs(_timed_runs), filter(_filter), verbose(true), sink(0.0) {}
+
+    void set_verbose(bool _verbose) { verbose = _verbose; }
+
+    // Returns the timing, valid until the next run(), or nullptr if the
+    // kernel was filtered out
+    template<typename F>
+    const BenchmarkResult* run(const std::string& name, size_t ops_per_run, F kernel) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) return nullptr;
+
+        for (size_t i = 0; i < warmup_runs; i++) sink = sink + kernel();
+
+        std::vector<double> ns(timed_runs);
+        AllocationStats allocs_before = allocation_thread_stats();
+        for (size_t i = 0; i < timed_runs; i++) {
+            auto t0 = std::chrono::steady_clock::now();
+            double x = kernel();
+            auto t1 = std::chrono::steady_clock::now();
+            sink = sink + x;
+            ns[i] = std::chrono::duration<double, std::nano>(t1 - t0).count() / ops_per_run;
+        }
+
+        AllocationStats allocs_after = allocation_thread_stats();
+
+        BenchmarkResult r;
+        r.name = name;
+        r.ops_per_run = ops_per_run;
+        r.runs = timed_runs;
+        r.allocs_per_op = static_cast<double>(allocs_after.allocations - allocs_before.allocations)
+                          / (timed_runs * ops_per_run);
+        r.mean_ns = 0.0;
+        for (double t : ns) r.mean_ns += t / timed_runs;
+        std::sort(ns.begin(), ns.end());
+        r.min_ns = ns.front();
+        r.median_ns = ns[timed_runs / 2];
+        r.p99_ns = ns[std::min(timed_runs - 1, static_cast<size_t>(0.99 * timed_runs))];
+        results.push_back(r);
+        if (!verbose) return &results.back();
+
+        std::cout << "  " << std::left << std::setw(40) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << r.median_ns << std::setw(12) << r.p99_ns
+                  << std::setw(12) << r.min_ns << std::setprecision(2) << std::setw(12) << r.allocs_per_op
+                  << std::endl;
+        return &results.back();
+    }
+
+    const std::vector<BenchmarkResult>& all_results() const { return results; }
+
+    static void print_header() {
+        std::cout << "  " << std::left << std::setw(40) << "Kernel" << std::right << std::setw(12)
+                  << "median ns" << std::setw(12) << "p99 ns" << std::setw(12) << "min ns" << std::setw(12) << "allocs/op" << std::endl;
+    }
+
+    // Writes every result as JSON so that runs from different builds can be
+    // diffed. Returns false if the file cannot be written
+    bool write_json(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "Cannot write benchmark results to " << path << "." << std::endl;
+            return false;
+        }
+        out << "{\n  \"compiler\": \"" << MICRO_BENCHMARK_COMPILER << "\",\n"
+            << "  \"warmup_runs\": " << warmup_runs << ",\n"
+            << "  \"timed_runs\": " << timed_runs << ",\n"
+            << "  \"benchmarks\": [\n";
+        out << std::setprecision(2) << std::fixed;
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchmarkResult& r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"ops_per_run\": " << r.ops_per_run
+                << ", \"runs\": " << r.runs << ", \"median_ns\": " << r.median_ns
+                << ", \"p99_ns\": " << r.p99_ns << ", \"min_ns\": " << r.min_ns
+                << ", \"mean_ns\": " << r.mean_ns << ", \"allocs_per_op\": " << r.allocs_per_op << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+};
+
+#endif
@@ -2,21 +2,25 @@
 #define __INTERVAL_BISECTION_H
 
 #include <cmath>
+#include "../instrumentation/instrumentation.h"
 
 // Creating a function template
 // Trying to find an x such that |g(x) - y| < epsilon,
-// starting with the interval (m, n).
+// starting with the interval (m, n). The number of
+// halvings is returned through iterations if non-null.
 template<typename T>
 double interval_bisection(double y_target,  // Target y value
                          double m,          // Left interval value
                          double n,          // Right interval value
                          double epsilon,    // Tolerance
-                         T g) {             // Function object of type T, named g
+                         T g,               // Function object of type T, named g
+                         int* iterations = nullptr) {
 
     // Create the initial x mid-point value
     // Find the mapped y value of g(x)
     double x = 0.5 * (m + n);
     double y = g(x);
+    int iter = 0;
 
     // While the difference between y and the y_target
     // value is greater than epsilon, keep subdividing
@@ -33,8 +37,11 @@ double interval_bisection(double y_target,  // Target y value
 
         x = 0.5 * (m + n);
         y = g(x);
+        iter++;
     } while (fabs(y-y_target) > epsilon);
 
+    QF_COUNT(COUNTER_BISECTION_ITERATIONS, iter);
+    if (iterations) *iterations = iter;
     return x;
 }
 
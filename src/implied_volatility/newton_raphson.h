@@ -2,23 +2,33 @@
 #define __NEWTON_RAPHSON_H
 
 #include <cmath>
+#include "../instrumentation/instrumentation.h"
 
+// Plain Newton-Raphson from init, with no bracket or iteration limit (see
+// safeguarded_newton.h). The number of steps taken is returned through
+// iterations if non-null.
 template<typename T,
     double (T::*g)(double) const,
     double (T::*g_prime)(double) const>
 double newton_raphson(double y_target,       // Target y value
                       double init,           // Initial x value
                       double epsilon,        // Tolerance
-                      const T& root_func) {  // Function object
+                      const T& root_func,    // Function object
+                      int* iterations = nullptr) {
     
     double y = (root_func.*g)(init);
     double x = init;
+    int iter = 0;
 
     while (fabs(y-y_target) > epsilon) {
         double d_x = (root_func.*g_prime)(x);
         x += (y_target-y)/d_x;
         y = (root_func.*g)(x);
+        iter++;
     }
+
+    QF_COUNT(COUNTER_NEWTON_ITERATIONS, iter);
+    if (iterations) *iterations = iter;
     return x;
 }
 
@@ -0,0 +1,57 @@
+#ifndef __SAFEGUARDED_NEWTON_H
+#define __SAFEGUARDED_NEWTON_H
+
+#include <cmath>
+#include "../instrumentation/instrumentation.h"
+
+// Newton-Raphson kept inside a bracketing interval (m, n) around the root of
+// g(x) - y_target, where g is increasing. Any step that would leave the
+// bracket, or that has a vanishing derivative, is replaced by a bisection
+// step, so the iteration always converges. Stops once |g(x) - y_target| <=
+// epsilon or after max_iter iterations, returning the number of iterations
+// taken through iterations if it is non-null.
+template<typename T,
+    double (T::*g)(double) const,
+    double (T::*g_prime)(double) const>
+double safeguarded_newton(double y_target,       // Target y value
+                          double init,           // Initial x value
+                          double m,              // Left bracket value
+                          double n,              // Right bracket value
+                          double epsilon,        // Tolerance
+                          const T& root_func,    // Function object
+                          int max_iter = 100,
+                          int* iterations = nullptr) {
+
+    double x = (init > m && init < n) ? init : 0.5 * (m + n);
+    double y = (root_func.*g)(x);
+    int iter = 0;
+
+    while (fabs(y - y_target) > epsilon && iter < max_iter) {
+        // Shrink the bracket using the sign of the residual
+        if (y < y_target) {
+            m = x;
+        } else {
+            n = x;
+        }
+
+        // Take the Newton step if it stays inside the bracket, else bisect
+        double x_new = 0.5 * (m + n);
+        double d_x = (root_func.*g_prime)(x);
+        if (d_x > 0.0) {
+            double x_newton = x + (y_target - y) / d_x;
+            if (x_newton > m && x_newton < n) {
+                x_new = x_newton;
+            }
+        }
+
+        x = x_new;
+        y = (root_func.*g)(x);
+        iter++;
+    }
+
+    QF_COUNT(COUNTER_SAFEGUARDED_NEWTON_ITERATIONS, iter);
+    if (iterations) *iterations = iter;
+    return x;
+}
+
+#endif
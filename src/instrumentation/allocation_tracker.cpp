@@ -0,0 +1,213 @@
+#ifndef __ALLOCATION_TRACKER_CPP
+#define __ALLOCATION_TRACKER_CPP
+
+#include "allocation_tracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Every block carries a header holding its requested size, so that delete
+// can account for it whether or not the caller passes the size. The header
+// is as large as the alignment, keeping the returned pointer aligned.
+static const size_t ALLOC_DEFAULT_ALIGN = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+static std::atomic<bool> alloc_tracking(false);
+
+// Constant-initialised, so reading it from inside operator new never
+// allocates or runs a constructor
+struct ThreadAllocations {
+    unsigned long allocations;
+    unsigned long deallocations;
+    unsigned long bytes;
+    long live;
+    long peak;
+    bool busy;  // Set while the tracker itself allocates
+};
+
+static thread_local ThreadAllocations alloc_thread = {0, 0, 0, 0, 0, false};
+
+static inline void alloc_record(size_t size) {
+    if (!alloc_tracking.load(std::memory_order_relaxed) || alloc_thread.busy) return;
+    alloc_thread.allocations++;
+    alloc_thread.bytes += size;
+    alloc_thread.live += static_cast<long>(size);
+    alloc_thread.peak = std::max(alloc_thread.peak, alloc_thread.live);
+}
+
+static inline void alloc_record_free(size_t size) {
+    if (!alloc_tracking.load(std::memory_order_relaxed) || alloc_thread.busy) return;
+    alloc_thread.deallocations++;
+    alloc_thread.live -= static_cast<long>(size);
+}
+
+static void* alloc_block(size_t size, size_t align) {
+    size_t header = std::max(align, ALLOC_DEFAULT_ALIGN);
+    for (;;) {
+        void* base = (align <= ALLOC_DEFAULT_ALIGN)
+            ? malloc(size + header)
+            : aligned_alloc(align, (size + header + align - 1) / align * align);
+        if (base) {
+            char* p = static_cast<char*>(base) + header;
+            reinterpret_cast<size_t*>(p)[-1] = size;
+            alloc_record(size);
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) return nullptr;
+        handler();
+    }
+}
+
+static void free_block(void* p, size_t align) {
+    if (!p) return;
+    alloc_record_free(reinterpret_cast<size_t*>(p)[-1]);
+    free(static_cast<char*>(p) - std::max(align, ALLOC_DEFAULT_ALIGN));
+}
+
+static void* alloc_or_throw(size_t size, size_t align) {
+    void* p = alloc_block(size, align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+// ==============================
+// Replacement operator new/delete
+// ==============================
+
+void* operator new(size_t size) { return alloc_or_throw(size, ALLOC_DEFAULT_ALIGN); }
+void* operator new[](size_t size) { return alloc_or_throw(size, ALLOC_DEFAULT_ALIGN); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return alloc_block(size, ALLOC_DEFAULT_ALIGN); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return alloc_block(size, ALLOC_DEFAULT_ALIGN); }
+
+void* operator new(size_t size, std::align_val_t align) { return alloc_or_throw(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return alloc_or_throw(size, static_cast<size_t>(align)); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return alloc_block(size, static_cast<size_t>(align));
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return alloc_block(size, static_cast<size_t>(align));
+}
+
+void operator delete(void* p) noexcept { free_block(p, ALLOC_DEFAULT_ALIGN); }
+void operator delete[](void* p) noexcept { free_block(p, ALLOC_DEFAULT_ALIGN); }
+void operator delete(void* p, size_t) noexcept { free_block(p, ALLOC_DEFAULT_ALIGN); }
+void operator delete[](void* p, size_t) noexcept { free_block(p, ALLOC_DEFAULT_ALIGN); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free_block(p, ALLOC_DEFAULT_ALIGN); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free_block(p, ALLOC_DEFAULT_ALIGN); }
+
+void operator delete(void* p, std::align_val_t align) noexcept { free_block(p, static_cast<size_t>(align)); }
+void operator delete[](void* p, std::align_val_t align) noexcept { free_block(p, static_cast<size_t>(align)); }
+void operator delete(void* p, size_t, std::align_val_t align) noexcept { free_block(p, static_cast<size_t>(align)); }
+void operator delete[](void* p, size_t, std::align_val_t align) noexcept { free_block(p, static_cast<size_t>(align)); }
+void operator delete(void* p, std::align_val_t align, const std::nothrow_t&) noexcept {
+    free_block(p, static_cast<size_t>(align));
+}
+void operator delete[](void* p, std::align_val_t align, const std::nothrow_t&) noexcept {
+    free_block(p, static_cast<size_t>(align));
+}
+
+// ======
+// Phases
+// ======
+
+struct AllocationPhase {
+    std::string name;
+    unsigned long entries;
+    AllocationStats totals;  // peak_bytes is the largest over all entries
+};
+
+static std::mutex alloc_phases_mutex;
+static std::vector<AllocationPhase> alloc_phases;
+
+void allocation_tracking_enable(bool enable) {
+    alloc_tracking.store(enable, std::memory_order_relaxed);
+}
+
+bool allocation_tracking_enabled() {
+    return alloc_tracking.load(std::memory_order_relaxed);
+}
+
+AllocationStats allocation_thread_stats() {
+    AllocationStats s;
+    s.allocations = alloc_thread.allocations;
+    s.deallocations = alloc_thread.deallocations;
+    s.bytes = alloc_thread.bytes;
+    s.peak_bytes = static_cast<unsigned long>(std::max(alloc_thread.peak, 0L));
+    return s;
+}
+
+AllocationScope::AllocationScope(const char* _name)
+    : name(_name),
+      start_allocations(alloc_thread.allocations),
+      start_deallocations(alloc_thread.deallocations),
+      start_bytes(alloc_thread.bytes),
+      start_live(alloc_thread.live),
+      outer_peak(alloc_thread.peak) {
+    alloc_thread.peak = alloc_thread.live;
+}
+
+AllocationStats AllocationScope::stats() const {
+    AllocationStats s;
+    s.allocations = alloc_thread.allocations - start_allocations;
+    s.deallocations = alloc_thread.deallocations - start_deallocations;
+    s.bytes = alloc_thread.bytes - start_bytes;
+    s.peak_bytes = static_cast<unsigned long>(std::max(alloc_thread.peak - start_live, 0L));
+    return s;
+}
+
+AllocationScope::~AllocationScope() {
+    AllocationStats s = stats();
+    alloc_thread.peak = std::max(outer_peak, alloc_thread.peak);
+
+    alloc_thread.busy = true;
+    {
+        std::lock_guard<std::mutex> lock(alloc_phases_mutex);
+        auto it = std::find_if(alloc_phases.begin(), alloc_phases.end(),
+                               [&](const AllocationPhase& p) { return p.name == name; });
+        if (it == alloc_phases.end()) {
+            alloc_phases.push_back(AllocationPhase());
+            it = alloc_phases.end() - 1;
+            it->name = name;
+            it->entries = 0;
+        }
+        it->entries++;
+        it->totals.allocations += s.allocations;
+        it->totals.deallocations += s.deallocations;
+        it->totals.bytes += s.bytes;
+        it->totals.peak_bytes = std::max(it->totals.peak_bytes, s.peak_bytes);
+    }
+    alloc_thread.busy = false;
+}
+
+void allocation_report(std::ostream& out) {
+    if (!allocation_tracking_enabled()) {
+        out << "Allocation tracking is disabled" << std::endl;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(alloc_phases_mutex);
+    out << "  " << std::left << std::setw(30) << "Phase" << std::right << std::setw(8) << "runs"
+        << std::setw(14) << "allocations" << std::setw(14) << "frees" << std::setw(14) << "MB requested"
+        << std::setw(12) << "peak KB" << "\n";
+    for (const AllocationPhase& p : alloc_phases) {
+        out << "  " << std::left << std::setw(30) << p.name << std::right << std::setw(8) << p.entries
+            << std::setw(14) << p.totals.allocations << std::setw(14) << p.totals.deallocations
+            << std::fixed << std::setprecision(2) << std::setw(14) << p.totals.bytes / 1048576.0
+            << std::setprecision(1) << std::setw(12) << p.totals.peak_bytes / 1024.0 << "\n";
+    }
+    out << std::flush;
+}
+
+void allocation_reset_report() {
+    std::lock_guard<std::mutex> lock(alloc_phases_mutex);
+    alloc_thread.busy = true;
+    alloc_phases.clear();
+    alloc_thread.busy = false;
+}
+
+#endif
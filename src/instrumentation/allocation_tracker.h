@@ -0,0 +1,58 @@
+#ifndef __ALLOCATION_TRACKER_H
+#define __ALLOCATION_TRACKER_H
+
+#include <iosfwd>
+#include <string>
+
+// Allocation accounting through replacement global operator new/delete.
+// The replacements live in allocation_tracker.o, which only the drivers that
+// want them link in; counting is further off until
+// allocation_tracking_enable(true) is called, so the cost while disabled is
+// one flag test per allocation.
+//
+// Counts are kept per thread. An AllocationScope measures a named phase on
+// the thread that opened it: allocations, bytes requested and the peak of
+// live bytes above the level at entry. Scopes nest, and when one closes its
+// numbers are added to a per-name total for allocation_report().
+
+struct AllocationStats {
+    unsigned long allocations;
+    unsigned long deallocations;
+    unsigned long bytes;       // Total bytes requested
+    unsigned long peak_bytes;  // Peak live bytes above the starting level
+
+    AllocationStats() : allocations(0), deallocations(0), bytes(0), peak_bytes(0) {}
+};
+
+void allocation_tracking_enable(bool enable);
+bool allocation_tracking_enabled();
+
+// Totals of the calling thread since tracking was first enabled
+AllocationStats allocation_thread_stats();
+
+class AllocationScope {
+private:
+    std::string name;
+    unsigned long start_allocations;
+    unsigned long start_deallocations;
+    unsigned long start_bytes;
+    long start_live;
+    long outer_peak;  // Peak of the enclosing scope, restored on exit
+
+public:
+    AllocationScope(const char* _name);  // Copied before counting starts
+    ~AllocationScope();
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+    // Counts since the scope was opened
+    AllocationStats stats() const;
+    bool allocation_free() const { return stats().allocations == 0; }
+};
+
+// Per-phase totals of every closed scope, in order of first use
+void allocation_report(std::ostream& out);
+void allocation_reset_report();
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef __INSTRUMENTATION_CPP
+#define __INSTRUMENTATION_CPP
+
+#include "instrumentation.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#ifdef QF_PERF_EVENTS
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* COUNTER_NAMES[NUM_INSTRUMENT_COUNTERS] = {
+    "normal_cdf",
+    "normal_inv_cdf",
+    "black_scholes_prices",
+    "implied_vol_solves",
+    "bisection_iterations",
+    "newton_iterations",
+    "safeguarded_newton_iterations",
+    "paths",
+    "path_steps",
+    "payoffs",
+    "scenarios",
+    "position_revaluations"
+};
+
+static const char* TIMER_NAMES[NUM_INSTRUMENT_TIMERS] = {
+    "implied_vol",
+    "path_generation",
+    "payoff",
+    "scenario_block",
+    "tail_contributions"
+};
+
+static const char* HW_NAMES[NUM_HW_COUNTERS] = {
+    "cycles",
+    "instructions",
+    "cache_misses",
+    "branch_misses"
+};
+
+const char* instrument_counter_name(InstrumentCounter c) { return COUNTER_NAMES[c]; }
+const char* instrument_timer_name(InstrumentTimer t) { return TIMER_NAMES[t]; }
+
+#ifdef QF_INSTRUMENT
+
+static std::atomic<InstrumentBlock*> instrument_blocks(nullptr);
+
+#ifdef QF_PERF_EVENTS
+// Opens the four hardware counters of the calling thread as one group, user
+// space only so that the default perf_event_paranoid setting allows it
+static int instrument_open_perf_group() {
+    const uint64_t configs[NUM_HW_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    int leader = -1;
+    for (int h = 0; h < NUM_HW_COUNTERS; h++) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[h];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+        if (fd < 0) {
+            if (leader >= 0) close(leader);  // Closing the leader ends the group
+            return -1;
+        }
+        if (leader < 0) leader = fd;
+    }
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return leader;
+}
+#endif
+
+InstrumentBlock* instrument_acquire_block() {
+    InstrumentBlock* block = nullptr;
+
+    // Reuse the block of a thread that has exited
+    for (InstrumentBlock* b = instrument_blocks.load(std::memory_order_acquire); b; b = b->next) {
+        bool expected = false;
+        if (b->in_use.compare_exchange_strong(expected, true)) {
+            block = b;
+            break;
+        }
+    }
+
+    if (!block) {
+        block = new InstrumentBlock();
+        for (auto& c : block->counters) c.store(0, std::memory_order_relaxed);
+        for (int t = 0; t < NUM_INSTRUMENT_TIMERS; t++) {
+            block->timer_calls[t].store(0, std::memory_order_relaxed);
+            block->timer_ticks[t].store(0, std::memory_order_relaxed);
+            for (auto& h : block->timer_hw[t]) h.store(0, std::memory_order_relaxed);
+        }
+        block->in_use.store(true, std::memory_order_relaxed);
+        block->next = instrument_blocks.load(std::memory_order_relaxed);
+        while (!instrument_blocks.compare_exchange_weak(block->next, block,
+                                                        std::memory_order_release, std::memory_order_relaxed)) {}
+    }
+
+    block->perf_fd = -1;
+#ifdef QF_PERF_EVENTS
+    block->perf_fd = instrument_open_perf_group();
+#endif
+    return block;
+}
+
+void instrument_release_block(InstrumentBlock* block) {
+#ifdef QF_PERF_EVENTS
+    // The counters belong to the exiting thread, so they cannot be reused
+    if (block->perf_fd >= 0) close(block->perf_fd);
+#endif
+    block->perf_fd = -1;
+    block->in_use.store(false, std::memory_order_release);
+}
+
+bool instrument_read_hardware(const InstrumentBlock& block, uint64_t* values) {
+#ifdef QF_PERF_EVENTS
+    if (block.perf_fd < 0) return false;
+    uint64_t buf[1 + NUM_HW_COUNTERS];  // nr, then one value per event
+    if (read(block.perf_fd, buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf))) return false;
+    for (int h = 0; h < NUM_HW_COUNTERS; h++) values[h] = buf[1 + h];
+    return true;
+#else
+    (void)block;
+    (void)values;
+    return false;
+#endif
+}
+
+// Totals of every block
+struct InstrumentTotals {
+    uint64_t counters[NUM_INSTRUMENT_COUNTERS];
+    uint64_t timer_calls[NUM_INSTRUMENT_TIMERS];
+    uint64_t timer_ticks[NUM_INSTRUMENT_TIMERS];
+    uint64_t timer_hw[NUM_INSTRUMENT_TIMERS][NUM_HW_COUNTERS];
+    size_t threads;
+    bool have_hw;
+};
+
+static InstrumentTotals instrument_totals() {
+    InstrumentTotals tot = InstrumentTotals();
+    for (InstrumentBlock* b = instrument_blocks.load(std::memory_order_acquire); b; b = b->next) {
+        tot.threads++;
+        for (int c = 0; c < NUM_INSTRUMENT_COUNTERS; c++) tot.counters[c] += b->counters[c].load(std::memory_order_relaxed);
+        for (int t = 0; t < NUM_INSTRUMENT_TIMERS; t++) {
+            tot.timer_calls[t] += b->timer_calls[t].load(std::memory_order_relaxed);
+            tot.timer_ticks[t] += b->timer_ticks[t].load(std::memory_order_relaxed);
+            for (int h = 0; h < NUM_HW_COUNTERS; h++) tot.timer_hw[t][h] += b->timer_hw[t][h].load(std::memory_order_relaxed);
+        }
+    }
+    for (int t = 0; t < NUM_INSTRUMENT_TIMERS; t++) tot.have_hw = tot.have_hw || tot.timer_hw[t][HW_CYCLES] > 0;
+    return tot;
+}
+
+// Nanoseconds per tick, measured once against steady_clock
+static double instrument_ns_per_tick() {
+#if defined(__x86_64__) || defined(__i386__)
+    static double ns_per_tick = 0.0;
+    if (ns_per_tick == 0.0) {
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t c0 = instrument_ticks();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto t1 = std::chrono::steady_clock::now();
+        uint64_t c1 = instrument_ticks();
+        ns_per_tick = std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(c1 - c0);
+    }
+    return ns_per_tick;
+#else
+    return 1.0;
+#endif
+}
+
+void instrumentation_reset() {
+    for (InstrumentBlock* b = instrument_blocks.load(std::memory_order_acquire); b; b = b->next) {
+        for (auto& c : b->counters) c.store(0, std::memory_order_relaxed);
+        for (int t = 0; t < NUM_INSTRUMENT_TIMERS; t++) {
+            b->timer_calls[t].store(0, std::memory_order_relaxed);
+            b->timer_ticks[t].store(0, std::memory_order_relaxed);
+            for (auto& h : b->timer_hw[t]) h.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void instrumentation_report(std::ostream& out) {
+    InstrumentTotals tot = instrument_totals();
+    double ns_per_tick = instrument_ns_per_tick();
+
+    out << "Counters (" << tot.threads << " thread blocks)\n";
+    for (int c = 0; c < NUM_INSTRUMENT_COUNTERS; c++) {
+        if (tot.counters[c] == 0) continue;
+        out << "  " << std::left << std::setw(32) << COUNTER_NAMES[c] << std::right
+            << std::setw(16) << tot.counters[c] << "\n";
+    }
+
+    out << "\nTimers                               calls        total ms     ns/call";
+    if (tot.have_hw) out << "   cycles/call   IPC   cache miss/call";
+    out << "\n";
+    for (int t = 0; t < NUM_INSTRUMENT_TIMERS; t++) {
+        uint64_t calls = tot.timer_calls[t];
+        if (calls == 0) continue;
+        double ns = tot.timer_ticks[t] * ns_per_tick;
+        out << "  " << std::left << std::setw(28) << TIMER_NAMES[t] << std::right << std::setw(12) << calls
+            << std::fixed << std::setprecision(2) << std::setw(16) << ns * 1e-6
+            << std::setprecision(1) << std::setw(12) << ns / calls;
+        if (tot.have_hw) {
+            const uint64_t* hw = tot.timer_hw[t];
+            out << std::setw(14) << static_cast<double>(hw[HW_CYCLES]) / calls << std::setprecision(2)
+                << std::setw(6) << (hw[HW_CYCLES] ? static_cast<double>(hw[HW_INSTRUCTIONS]) / hw[HW_CYCLES] : 0.0)
+                << std::setprecision(1) << std::setw(18) << static_cast<double>(hw[HW_CACHE_MISSES]) / calls;
+        }
+        out << "\n";
+    }
+    if (!tot.have_hw) {
+#ifdef QF_PERF_EVENTS
+        out << "Hardware counters unavailable (perf_event_open failed, see /proc/sys/kernel/perf_event_paranoid)\n";
+#endif
+    }
+    out << std::flush;
+}
+
+bool instrumentation_write_json(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write instrumentation to " << path << "." << std::endl;
+        return false;
+    }
+
+    InstrumentTotals tot = instrument_totals();
+    double ns_per_tick = instrument_ns_per_tick();
+
+    out << "{\n  \"enabled\": true,\n  \"threads\": " << tot.threads
+        << ",\n  \"hardware_counters\": " << (tot.have_hw ? "true" : "false") << ",\n  \"counters\": {\n";
+    for (int c = 0; c < NUM_INSTRUMENT_COUNTERS; c++) {
+        out << "    \"" << COUNTER_NAMES[c] << "\": " << tot.counters[c]
+            << (c + 1 < NUM_INSTRUMENT_COUNTERS ? "," : "") << "\n";
+    }
+    out << "  },\n  \"timers\": {\n" << std::fixed << std::setprecision(1);
+    for (int t = 0; t < NUM_INSTRUMENT_TIMERS; t++) {
+        out << "    \"" << TIMER_NAMES[t] << "\": {\"calls\": " << tot.timer_calls[t]
+            << ", \"total_ns\": " << tot.timer_ticks[t] * ns_per_tick;
+        if (tot.have_hw) {
+            for (int h = 0; h < NUM_HW_COUNTERS; h++) out << ", \"" << HW_NAMES[h] << "\": " << tot.timer_hw[t][h];
+        }
+        out << "}" << (t + 1 < NUM_INSTRUMENT_TIMERS ? "," : "") << "\n";
+    }
+    out << "  }\n}\n";
+    return static_cast<bool>(out);
+}
+
+#else
+
+void instrumentation_reset() {}
+
+void instrumentation_report(std::ostream& out) {
+    (void)HW_NAMES;
+    out << "Instrumentation is compiled out (build with make INSTRUMENT=1)" << std::endl;
+}
+
+bool instrumentation_write_json(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write instrumentation to " << path << "." << std::endl;
+        return false;
+    }
+    out << "{\n  \"enabled\": false\n}\n";
+    return static_cast<bool>(out);
+}
+
+#endif
+
+#endif
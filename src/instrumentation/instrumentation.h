@@ -0,0 +1,167 @@
+#ifndef __INSTRUMENTATION_H
+#define __INSTRUMENTATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+// Hot-path instrumentation: event counters and scoped timers, optionally
+// with hardware counters. Unless QF_INSTRUMENT is defined (make
+// INSTRUMENT=1), QF_COUNT and QF_TIMED_SCOPE expand to nothing and release
+// kernels are unchanged. QF_PERF_EVENTS (make PERF_EVENTS=1, Linux only)
+// adds cycles, instructions, cache misses and branch misses to every timed
+// scope through perf_event_open.
+//
+// Each thread writes only to its own block of counters, so recording is a
+// plain load and store with no locking or atomic read-modify-write. The
+// report walks every block and sums them.
+
+enum InstrumentCounter {
+    COUNTER_NORMAL_CDF,                      // N() and StandardNormalDistribution::cdf
+    COUNTER_NORMAL_INV_CDF,                  // Scalar and batch inverse CDF values
+    COUNTER_BLACK_SCHOLES_PRICES,            // Batch closed-form prices
+    COUNTER_IMPLIED_VOL_SOLVES,
+    COUNTER_BISECTION_ITERATIONS,
+    COUNTER_NEWTON_ITERATIONS,
+    COUNTER_SAFEGUARDED_NEWTON_ITERATIONS,
+    COUNTER_PATHS,
+    COUNTER_PATH_STEPS,
+    COUNTER_PAYOFFS,
+    COUNTER_SCENARIOS,
+    COUNTER_POSITION_REVALUATIONS,
+    NUM_INSTRUMENT_COUNTERS
+};
+
+// Timers are inclusive: a timed scope inside another one counts in both
+enum InstrumentTimer {
+    TIMER_IMPLIED_VOL,
+    TIMER_PATH_GENERATION,
+    TIMER_PAYOFF,
+    TIMER_SCENARIO_BLOCK,
+    TIMER_TAIL_CONTRIBUTIONS,
+    NUM_INSTRUMENT_TIMERS
+};
+
+enum InstrumentHardwareCounter {
+    HW_CYCLES,
+    HW_INSTRUCTIONS,
+    HW_CACHE_MISSES,
+    HW_BRANCH_MISSES,
+    NUM_HW_COUNTERS
+};
+
+const char* instrument_counter_name(InstrumentCounter c);
+const char* instrument_timer_name(InstrumentTimer t);
+
+#ifdef QF_INSTRUMENT
+constexpr bool instrumentation_enabled() { return true; }
+#else
+constexpr bool instrumentation_enabled() { return false; }
+#endif
+
+// Zero every counter. Only meaningful while no instrumented code is running
+void instrumentation_reset();
+
+// Totals over all threads, as a table or as JSON
+void instrumentation_report(std::ostream& out);
+bool instrumentation_write_json(const std::string& path);
+
+#ifdef QF_INSTRUMENT
+
+#include <atomic>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// One thread's counters. Blocks live in a lock-free list and are never
+// freed; when a thread exits its block is released for reuse by the next
+// new thread, keeping its totals
+struct InstrumentBlock {
+    std::atomic<uint64_t> counters[NUM_INSTRUMENT_COUNTERS];
+    std::atomic<uint64_t> timer_calls[NUM_INSTRUMENT_TIMERS];
+    std::atomic<uint64_t> timer_ticks[NUM_INSTRUMENT_TIMERS];
+    std::atomic<uint64_t> timer_hw[NUM_INSTRUMENT_TIMERS][NUM_HW_COUNTERS];
+    std::atomic<bool> in_use;
+    InstrumentBlock* next;
+    int perf_fd;  // perf_event_open group leader, -1 if unavailable
+};
+
+InstrumentBlock* instrument_acquire_block();
+void instrument_release_block(InstrumentBlock* block);
+bool instrument_read_hardware(const InstrumentBlock& block, uint64_t* values);
+
+struct InstrumentBlockHolder {
+    InstrumentBlock* block;
+    InstrumentBlockHolder() : block(instrument_acquire_block()) {}
+    ~InstrumentBlockHolder() { instrument_release_block(block); }
+};
+
+inline InstrumentBlock& instrument_block() {
+    static thread_local InstrumentBlockHolder holder;
+    return *holder.block;
+}
+
+// Only the owning thread writes a slot, so no read-modify-write is needed
+inline void instrument_add(std::atomic<uint64_t>& slot, uint64_t n) {
+    slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// Time stamp counter where there is one, otherwise steady_clock nanoseconds
+inline uint64_t instrument_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+class InstrumentScope {
+private:
+    InstrumentBlock& block;
+    InstrumentTimer timer;
+    uint64_t start;
+#ifdef QF_PERF_EVENTS
+    bool have_hw;
+    uint64_t hw_start[NUM_HW_COUNTERS];
+#endif
+
+public:
+    InstrumentScope(InstrumentTimer _timer) : block(instrument_block()), timer(_timer) {
+#ifdef QF_PERF_EVENTS
+        have_hw = instrument_read_hardware(block, hw_start);
+#endif
+        start = instrument_ticks();
+    }
+
+    ~InstrumentScope() {
+        uint64_t ticks = instrument_ticks() - start;
+        instrument_add(block.timer_ticks[timer], ticks);
+        instrument_add(block.timer_calls[timer], 1);
+#ifdef QF_PERF_EVENTS
+        uint64_t hw_end[NUM_HW_COUNTERS];
+        if (have_hw && instrument_read_hardware(block, hw_end)) {
+            for (int h = 0; h < NUM_HW_COUNTERS; h++) instrument_add(block.timer_hw[timer][h], hw_end[h] - hw_start[h]);
+        }
+#endif
+    }
+
+    InstrumentScope(const InstrumentScope&) = delete;
+    InstrumentScope& operator=(const InstrumentScope&) = delete;
+};
+
+#define QF_INSTRUMENT_CONCAT2(a, b) a##b
+#define QF_INSTRUMENT_CONCAT(a, b) QF_INSTRUMENT_CONCAT2(a, b)
+#define QF_COUNT(counter, n) instrument_add(instrument_block().counters[counter], (n))
+#define QF_TIMED_SCOPE(timer) InstrumentScope QF_INSTRUMENT_CONCAT(qf_scope_, __LINE__)(timer)
+
+#else
+
+#define QF_COUNT(counter, n) ((void)0)
+#define QF_TIMED_SCOPE(timer) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef __ARRAY_VIEW_H
+#define __ARRAY_VIEW_H
+
+#include <cstddef>
+
+// Read-only, non-owning view of a contiguous array (a C++17 stand-in for
+// std::span<const T>). Used to expose columns of memory-mapped or pooled data
+// without copying them.
+template<typename T>
+class ArrayView {
+private:
+    const T* ptr;
+    size_t n;
+
+public:
+    ArrayView() : ptr(nullptr), n(0) {}
+    ArrayView(const T* _ptr, size_t _n) : ptr(_ptr), n(_n) {}
+
+    const T* data() const { return ptr; }
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+
+    const T& operator[](size_t i) const { return ptr[i]; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + n; }
+
+    // View of elements [offset, offset + count)
+    ArrayView<T> subview(size_t offset, size_t count) const {
+        return ArrayView<T>(ptr + offset, count);
+    }
+};
+
+#endif
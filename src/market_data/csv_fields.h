@@ -0,0 +1,74 @@
+#ifndef __CSV_FIELDS_H
+#define __CSV_FIELDS_H
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+// Allocation-free parsing of delimited text fields held in a [first, last)
+// character range, shared by the chain and tick file loaders
+
+// Strip surrounding whitespace and quotes from the field [first, last)
+inline void csv_trim(const char*& first, const char*& last) {
+    while (first < last && (*first == ' ' || *first == '"')) first++;
+    while (last > first && (last[-1] == ' ' || last[-1] == '"' || last[-1] == '\r')) last--;
+}
+
+inline bool csv_parse_double(const char* first, const char* last, double& value) {
+    if (first < last && *first == '+') first++;
+#if defined(__cpp_lib_to_chars)
+    std::from_chars_result res = std::from_chars(first, last, value);
+    return res.ec == std::errc() && res.ptr == last;
+#else
+    // Standard libraries without floating-point from_chars fall back to strtod
+    char buf[64];
+    size_t len = static_cast<size_t>(last - first);
+    if (len == 0 || len >= sizeof(buf)) return false;
+    memcpy(buf, first, len);
+    buf[len] = '\0';
+    char* end_ptr = nullptr;
+    value = strtod(buf, &end_ptr);
+    return end_ptr == buf + len;
+#endif
+}
+
+inline bool csv_parse_int(const char* first, const char* last, int& value) {
+    std::from_chars_result res = std::from_chars(first, last, value);
+    return res.ec == std::errc() && res.ptr == last;
+}
+
+inline bool csv_parse_long(const char* first, const char* last, long long& value) {
+    std::from_chars_result res = std::from_chars(first, last, value);
+    return res.ec == std::errc() && res.ptr == last;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's algorithm)
+inline long days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    long era = (y >= 0 ? y : y - 399) / 400;
+    long yoe = y - era * 400;
+    long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+inline int days_in_month(int y, int m) {
+    static const int days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    return (m == 2 && leap) ? 29 : days[m - 1];
+}
+
+// Parses the leading YYYY-MM-DD of a field into a day number. Months and
+// days outside the calendar, e.g. 2024-13-45 or 2025-02-29, are rejected
+inline bool csv_parse_date(const char* first, const char* last, long& day) {
+    int y, m, d;
+    if (last - first < 10 || first[4] != '-' || first[7] != '-') return false;
+    if (!csv_parse_int(first, first + 4, y)) return false;
+    if (!csv_parse_int(first + 5, first + 7, m)) return false;
+    if (!csv_parse_int(first + 8, first + 10, d)) return false;
+    if (m < 1 || m > 12 || d < 1 || d > days_in_month(y, m)) return false;
+    day = days_from_civil(y, m, d);
+    return true;
+}
+
+#endif
@@ -0,0 +1,290 @@
+#ifndef __CSV_LOADER_CPP
+#define __CSV_LOADER_CPP
+
+#include "csv_loader.h"
+#include "mapped_file.h"
+#include "csv_fields.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+// Chunks smaller than this are not worth a thread of their own
+const size_t CSV_MIN_CHUNK_BYTES = 1 << 20;
+
+enum CsvField {
+    CSV_SKIP,
+    CSV_EXPIRY,
+    CSV_DAYS,
+    CSV_STRIKE,
+    CSV_TYPE,
+    CSV_BID,
+    CSV_ASK,
+    CSV_MID,
+    CSV_VOLUME,
+    CSV_OPEN_INTEREST,
+    CSV_IMPLIED_VOL
+};
+
+// Rows parsed by one thread, grouped by expiry. A chain file only has a few
+// dozen expiries, so a linear search beats hashing the key on every row
+struct CsvChunkResult {
+    std::vector<std::pair<std::string, std::vector<OptionData> > > chains;
+    unsigned long rows;
+    unsigned long bad_rows;
+
+    CsvChunkResult() : rows(0), bad_rows(0) {}
+};
+
+static CsvField csv_field_from_name(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    if (name == "expiry_date" || name == "expiration" || name == "expiry") return CSV_EXPIRY;
+    if (name == "days_to_expiry" || name == "dte") return CSV_DAYS;
+    if (name == "strike") return CSV_STRIKE;
+    if (name == "type" || name == "option_type" || name == "call_put") return CSV_TYPE;
+    if (name == "bid") return CSV_BID;
+    if (name == "ask") return CSV_ASK;
+    if (name == "mid" || name == "mid_price") return CSV_MID;
+    if (name == "volume") return CSV_VOLUME;
+    if (name == "open_interest" || name == "oi") return CSV_OPEN_INTEREST;
+    if (name == "implied_vol" || name == "iv" || name == "implied_volatility") return CSV_IMPLIED_VOL;
+    return CSV_SKIP;
+}
+
+static std::vector<OptionData>& csv_chain_for(CsvChunkResult& result, const char* first,
+                                              const char* last, size_t& last_idx) {
+    size_t len = static_cast<size_t>(last - first);
+    auto matches = [&](size_t i) {
+        const std::string& key = result.chains[i].first;
+        return key.size() == len && memcmp(key.data(), first, len) == 0;
+    };
+
+    // Rows are usually grouped by expiry, so try the previous chain first
+    if (last_idx < result.chains.size() && matches(last_idx)) {
+        return result.chains[last_idx].second;
+    }
+    for (size_t i=0; i<result.chains.size(); i++) {
+        if (matches(i)) {
+            last_idx = i;
+            return result.chains[i].second;
+        }
+    }
+    result.chains.emplace_back(std::string(first, len), std::vector<OptionData>());
+    last_idx = result.chains.size() - 1;
+    return result.chains.back().second;
+}
+
+// Parse every line in [begin, end). Both ends lie on line boundaries. Days
+// to expiry come from the expiry date only in files without a days column,
+// which the header decides, not the order of the columns
+static void csv_parse_chunk(const char* begin, const char* end,
+                            const std::vector<CsvField>& columns,
+                            bool have_days_column, long quote_day,
+                            CsvChunkResult& result) {
+    size_t last_idx = 0;
+    const char* p = begin;
+
+    while (p < end) {
+        const char* line_end = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+
+        const char* line_start = p;
+        p = line_end + 1;
+        if (line_end - line_start <= 1) continue; // Blank line
+
+        OptionData opt = OptionData();
+        const char* expiry_first = nullptr;
+        const char* expiry_last = nullptr;
+        bool have_mid = false;
+        bool ok = true;
+        int required = 0;
+        // With a days column, a row without days is as malformed as one
+        // without a strike, rather than expiring today
+        const int num_required = have_days_column ? 6 : 5;
+
+        const char* field = line_start;
+        for (size_t col=0; col<columns.size() && field <= line_end; col++) {
+            const char* field_end = static_cast<const char*>(memchr(field, ',', line_end - field));
+            if (!field_end) field_end = line_end;
+
+            const char* first = field;
+            const char* last = field_end;
+            field = field_end + 1;
+
+            csv_trim(first, last);
+            if (first == last) continue; // Empty fields keep their defaults
+
+            switch (columns[col]) {
+            case CSV_EXPIRY:
+                expiry_first = first;
+                expiry_last = last;
+                required++;
+                if (!have_days_column) {
+                    long expiry_day = 0;
+                    ok = ok && csv_parse_date(first, last, expiry_day);
+                    opt.days_to_expiry = static_cast<double>(expiry_day - quote_day);
+                }
+                break;
+            case CSV_DAYS:
+                ok = ok && csv_parse_double(first, last, opt.days_to_expiry);
+                required++;
+                break;
+            case CSV_STRIKE:
+                ok = ok && csv_parse_double(first, last, opt.strike);
+                required++;
+                break;
+            case CSV_TYPE:
+                opt.type = static_cast<char>(std::toupper(static_cast<unsigned char>(*first)));
+                ok = ok && (opt.type == 'C' || opt.type == 'P');
+                required++;
+                break;
+            case CSV_BID:
+                ok = ok && csv_parse_double(first, last, opt.bid);
+                required++;
+                break;
+            case CSV_ASK:
+                ok = ok && csv_parse_double(first, last, opt.ask);
+                required++;
+                break;
+            case CSV_MID:
+                ok = ok && csv_parse_double(first, last, opt.mid_price);
+                have_mid = true;
+                break;
+            case CSV_VOLUME:
+                ok = ok && csv_parse_double(first, last, opt.volume);
+                break;
+            case CSV_OPEN_INTEREST:
+                ok = ok && csv_parse_double(first, last, opt.open_interest);
+                break;
+            case CSV_IMPLIED_VOL:
+                ok = ok && csv_parse_double(first, last, opt.implied_vol);
+                break;
+            case CSV_SKIP:
+                break;
+            }
+        }
+
+        if (!ok || required != num_required) {
+            result.bad_rows++;
+            continue;
+        }
+        if (!have_mid) opt.mid_price = 0.5 * (opt.bid + opt.ask);
+
+        std::vector<OptionData>& chain = csv_chain_for(result, expiry_first, expiry_last, last_idx);
+        opt.expiry_date = result.chains[last_idx].first;
+        chain.push_back(std::move(opt));
+        result.rows++;
+    }
+}
+
+bool load_option_chain_csv(const std::string& path,
+                           const CsvLoadOptions& options,
+                           MarketData& market,
+                           CsvLoadStats* stats) {
+    auto start_time = std::chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    const char* header_end = begin ? static_cast<const char*>(memchr(begin, '\n', end - begin)) : nullptr;
+    if (!header_end) {
+        std::cerr << "CSV file " << path << " has no header line." << std::endl;
+        return false;
+    }
+
+    // Map the header onto the fields we know about
+    std::vector<CsvField> columns;
+    bool have_days_column = false;
+    int required = 0;
+    for (const char* field = begin; field <= header_end; ) {
+        const char* field_end = static_cast<const char*>(memchr(field, ',', header_end - field));
+        if (!field_end) field_end = header_end;
+        const char* first = field;
+        const char* last = field_end;
+        csv_trim(first, last);
+        CsvField f = csv_field_from_name(std::string(first, last));
+        columns.push_back(f);
+        if (f == CSV_DAYS) have_days_column = true;
+        if (f == CSV_EXPIRY || f == CSV_STRIKE || f == CSV_TYPE || f == CSV_BID || f == CSV_ASK) required++;
+        field = field_end + 1;
+    }
+    if (required != 5) {
+        std::cerr << "CSV header must contain expiry_date, strike, type, bid and ask columns." << std::endl;
+        return false;
+    }
+
+    long quote_day = 0;
+    bool have_quote_day = !options.date.empty() &&
+        csv_parse_date(options.date.data(), options.date.data() + options.date.size(), quote_day);
+    if (!have_days_column && !have_quote_day) {
+        std::cerr << "CSV has no days_to_expiry column, so a quote date (YYYY-MM-DD) is required." << std::endl;
+        return false;
+    }
+
+    // Split the body into roughly equal chunks, each ending on a newline
+    const char* body = header_end + 1;
+    size_t body_size = static_cast<size_t>(end - body);
+    unsigned num_threads = options.num_threads ? options.num_threads : std::thread::hardware_concurrency();
+    num_threads = std::max(1u, std::min<unsigned>(num_threads,
+                  static_cast<unsigned>(body_size / CSV_MIN_CHUNK_BYTES) + 1));
+
+    std::vector<const char*> bounds(1, body);
+    for (unsigned i=1; i<num_threads; i++) {
+        const char* b = body + body_size * i / num_threads;
+        b = std::max(b, bounds.back());
+        const char* nl = static_cast<const char*>(memchr(b, '\n', end - b));
+        bounds.push_back(nl ? nl + 1 : end);
+    }
+    bounds.push_back(end);
+
+    std::vector<CsvChunkResult> results(num_threads);
+    std::vector<std::thread> workers;
+    for (unsigned i=1; i<num_threads; i++) {
+        workers.emplace_back(csv_parse_chunk, bounds[i], bounds[i+1], std::cref(columns),
+                             have_days_column, quote_day, std::ref(results[i]));
+    }
+    csv_parse_chunk(bounds[0], bounds[1], columns, have_days_column, quote_day, results[0]);
+    for (auto& w : workers) w.join();
+
+    // Stitch the chunks back together in file order
+    market.spot_price = options.spot_price;
+    market.risk_free_rate = options.risk_free_rate;
+    market.date = options.date;
+    market.option_chains.clear();
+
+    unsigned long rows = 0;
+    unsigned long bad_rows = 0;
+    for (auto& result : results) {
+        rows += result.rows;
+        bad_rows += result.bad_rows;
+        for (auto& chain : result.chains) {
+            std::vector<OptionData>& dst = market.option_chains[chain.first];
+            if (dst.empty()) {
+                dst = std::move(chain.second);
+            } else {
+                dst.insert(dst.end(), std::make_move_iterator(chain.second.begin()),
+                           std::make_move_iterator(chain.second.end()));
+            }
+        }
+    }
+
+    if (stats) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+        stats->rows = rows;
+        stats->bad_rows = bad_rows;
+        stats->bytes = file.size();
+        stats->threads = num_threads;
+        stats->seconds = elapsed.count();
+        stats->rows_per_second = (elapsed.count() > 0.0) ? rows / elapsed.count() : 0.0;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __CSV_LOADER_H
+#define __CSV_LOADER_H
+
+#include <string>
+#include "market_data.h"
+
+// Loads an end-of-day option chain from a CSV file into MarketData.
+//
+// The first line must be a header. Columns are matched by name (case
+// insensitive) and may appear in any order; unknown columns are skipped.
+//   Required: expiry_date (or expiration), strike, type (C/P or call/put),
+//             bid, ask
+//   Optional: days_to_expiry (otherwise computed from CsvLoadOptions::date),
+//             mid_price, volume, open_interest, implied_vol
+//
+// The file is memory-mapped and split into chunks on line boundaries, which
+// are parsed in parallel with std::from_chars straight out of the mapping.
+
+struct CsvLoadOptions {
+    double spot_price;
+    double risk_free_rate;
+    std::string date;        // Quote date, YYYY-MM-DD
+    unsigned num_threads;    // 0 means one per hardware thread
+
+    CsvLoadOptions() : spot_price(0.0), risk_free_rate(0.0), num_threads(0) {}
+};
+
+struct CsvLoadStats {
+    unsigned long rows;      // Rows loaded into the chains
+    unsigned long bad_rows;  // Rows skipped because a field failed to parse
+    size_t bytes;
+    unsigned threads;
+    double seconds;
+    double rows_per_second;
+};
+
+// Returns false (with a message on stderr) if the file cannot be read or
+// the header lacks a required column
+bool load_option_chain_csv(const std::string& path,
+                           const CsvLoadOptions& options,
+                           MarketData& market,
+                           CsvLoadStats* stats = nullptr);
+
+#endif
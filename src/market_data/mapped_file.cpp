@@ -0,0 +1,62 @@
+#ifndef __MAPPED_FILE_CPP
+#define __MAPPED_FILE_CPP
+
+#include "mapped_file.h"
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() : data_ptr(nullptr), data_size(0) {}
+
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Unable to open " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "Unable to stat " << path << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    // mmap() rejects zero-length mappings, so an empty file is left unmapped
+    data_size = static_cast<size_t>(st.st_size);
+    if (data_size == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void* addr = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping stays valid after the descriptor is closed
+    if (addr == MAP_FAILED) {
+        std::cerr << "Unable to map " << path << ": " << strerror(errno) << std::endl;
+        data_size = 0;
+        return false;
+    }
+
+    // The files are read front to back
+    madvise(addr, data_size, MADV_SEQUENTIAL);
+    data_ptr = static_cast<const char*>(addr);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_ptr) {
+        munmap(const_cast<char*>(data_ptr), data_size);
+    }
+    data_ptr = nullptr;
+    data_size = 0;
+}
+
+#endif
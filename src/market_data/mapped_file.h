@@ -0,0 +1,30 @@
+#ifndef __MAPPED_FILE_H
+#define __MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file (POSIX mmap). The mapping is
+// released when the object goes out of scope.
+class MappedFile {
+private:
+    const char* data_ptr;
+    size_t data_size;
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // Non-copyable, as the object owns the mapping
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps the file, returning false (with a message on stderr) on failure
+    bool open(const std::string& path);
+    void close();
+
+    const char* data() const { return data_ptr; }
+    size_t size() const { return data_size; }
+};
+
+#endif
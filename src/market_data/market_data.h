@@ -0,0 +1,30 @@
+#ifndef __MARKET_DATA_H
+#define __MARKET_DATA_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Structure to hold option market data
+struct OptionData {
+    std::string expiry_date;
+    double days_to_expiry;
+    double strike;
+    double bid;
+    double ask;
+    double mid_price;
+    double volume;
+    double open_interest;
+    double implied_vol;
+    char type; // 'C' for call, 'P' for put
+};
+
+// Structure to hold SPX market data
+struct MarketData {
+    double spot_price;
+    double risk_free_rate;
+    std::string date;
+    std::map<std::string, std::vector<OptionData>> option_chains; // Key: expiry date
+};
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef __OPTION_CHAIN_CPP
+#define __OPTION_CHAIN_CPP
+
+#include "option_chain.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+OptionChain::OptionChain(std::pmr::memory_resource* resource)
+    : spot(0.0), rate(0.0), curve(0.0, CURVE_LINEAR_ZERO, resource),
+      expiry_names(resource), expiry_days(resource), expiry_discounts(resource), expiry_rates(resource),
+      segment_begin(resource), strikes(resource), bids(resource), asks(resource), mids(resource),
+      volumes(resource), open_interests(resource), implied_vols(resource) {
+    clear();
+}
+
+OptionChain::OptionChain(const MarketData& market, std::pmr::memory_resource* resource)
+    : OptionChain(resource) {
+    build(market);
+}
+
+OptionChain::OptionChain(const MarketSnapshot& snapshot, std::pmr::memory_resource* resource)
+    : OptionChain(resource) {
+    build(snapshot);
+}
+
+void OptionChain::clear() {
+    expiry_names.clear();
+    expiry_days.clear();
+    expiry_discounts.clear();
+    expiry_rates.clear();
+    segment_begin.assign(1, 0);
+    strikes.clear();
+    bids.clear();
+    asks.clear();
+    mids.clear();
+    volumes.clear();
+    open_interests.clear();
+    implied_vols.clear();
+}
+
+void OptionChain::set_market(const MarketData& market) {
+    clear();
+    spot = market.spot_price;
+    rate = market.risk_free_rate;
+    date = market.date;
+    curve.set_flat_rate(rate);
+}
+
+void OptionChain::append_expiry(const std::string& expiry_date, const std::vector<OptionData>& options) {
+    expiry_names.push_back(expiry_date);
+    expiry_days.push_back(options.empty() ? 0.0 : options[0].days_to_expiry);
+
+    std::pmr::vector<const OptionData*> sorted(strikes.get_allocator().resource());
+    sorted.reserve(options.size());
+    for (int side=0; side<CHAIN_NUM_SIDES; side++) {
+        char type = (side == CHAIN_CALLS) ? 'C' : 'P';
+        sorted.clear();
+        for (const auto& opt : options) {
+            if (opt.type == type) sorted.push_back(&opt);
+        }
+        std::sort(sorted.begin(), sorted.end(),
+                  [](const OptionData* a, const OptionData* b) { return a->strike < b->strike; });
+
+        for (const OptionData* opt : sorted) {
+            strikes.push_back(opt->strike);
+            bids.push_back(opt->bid);
+            asks.push_back(opt->ask);
+            mids.push_back(opt->mid_price);
+            volumes.push_back(opt->volume);
+            open_interests.push_back(opt->open_interest);
+            implied_vols.push_back(opt->implied_vol);
+        }
+        segment_begin.push_back(strikes.size());
+    }
+}
+
+void OptionChain::build(const MarketData& market) {
+    set_market(market);
+
+    size_t rows = 0;
+    for (const auto& chain : market.option_chains) rows += chain.second.size();
+    strikes.reserve(rows);
+    bids.reserve(rows);
+    asks.reserve(rows);
+    mids.reserve(rows);
+    volumes.reserve(rows);
+    open_interests.reserve(rows);
+    implied_vols.reserve(rows);
+
+    // std::map iterates in key order, which becomes the index order
+    for (const auto& chain : market.option_chains) append_expiry(chain.first, chain.second);
+    cache_discounts();
+    check_expiry_order();
+}
+
+void OptionChain::build(const MarketData& market, const std::string& expiry_date) {
+    set_market(market);
+    auto it = market.option_chains.find(expiry_date);
+    if (it != market.option_chains.end()) append_expiry(it->first, it->second);
+    cache_discounts();
+}
+
+void OptionChain::build(const MarketSnapshot& snapshot) {
+    clear();
+    spot = snapshot.spot_price();
+    rate = snapshot.risk_free_rate();
+    date = snapshot.date();
+    curve.set_flat_rate(rate);
+
+    // Snapshot columns are already grouped by expiry and sorted by strike,
+    // so each segment is a straight copy of a column slice
+    for (size_t e=0; e<snapshot.num_expiries(); e++) {
+        expiry_names.push_back(snapshot.expiry_date(e));
+        expiry_days.push_back(snapshot.expiry(e).days_to_expiry);
+
+        for (int side=0; side<CHAIN_NUM_SIDES; side++) {
+            SnapshotSide s = (side == CHAIN_CALLS) ? SNAP_CALLS : SNAP_PUTS;
+            auto append = [&](std::pmr::vector<double>& dst, SnapshotColumn col) {
+                ArrayView<double> src = snapshot.column(s, col, e);
+                dst.insert(dst.end(), src.begin(), src.end());
+            };
+            append(strikes, SNAP_STRIKE);
+            append(bids, SNAP_BID);
+            append(asks, SNAP_ASK);
+            append(mids, SNAP_MID_PRICE);
+            append(volumes, SNAP_VOLUME);
+            append(open_interests, SNAP_OPEN_INTEREST);
+            append(implied_vols, SNAP_IMPLIED_VOL);
+            segment_begin.push_back(strikes.size());
+        }
+    }
+    cache_discounts();
+    check_expiry_order();
+}
+
+void OptionChain::set_yield_curve(const YieldCurve& _curve) {
+    curve = _curve;
+    cache_discounts();
+}
+
+void OptionChain::cache_discounts() {
+    size_t n = expiry_days.size();
+    std::pmr::vector<double> T(n, expiry_days.get_allocator().resource());
+    for (size_t e=0; e<n; e++) T[e] = expiry_days[e] / 365.0;
+    expiry_discounts.resize(n);
+    curve.discount(T.data(), expiry_discounts.data(), n);
+    expiry_rates.resize(n);
+    for (size_t e=0; e<n; e++) {
+        expiry_rates[e] = (T[e] > 0.0) ? -log(expiry_discounts[e]) / T[e] : curve.zero_rate(0.0);
+    }
+}
+
+// Expiries without options carry no days to expiry and are skipped
+bool OptionChain::expiries_in_date_order() const {
+    double last_days = -HUGE_VAL;
+    for (size_t e=0; e<num_expiries(); e++) {
+        if (begin(e, CHAIN_CALLS) == end(e, CHAIN_PUTS)) continue;
+        if (expiry_days[e] < last_days) return false;
+        last_days = expiry_days[e];
+    }
+    return true;
+}
+
+void OptionChain::check_expiry_order() const {
+    if (!expiries_in_date_order()) {
+        std::cerr << "Option chain expiry keys do not sort in date order; use ISO YYYY-MM-DD dates." << std::endl;
+    }
+}
+
+int OptionChain::find_expiry(const std::string& expiry_date) const {
+    auto it = std::lower_bound(expiry_names.begin(), expiry_names.end(), expiry_date);
+    if (it == expiry_names.end() || *it != expiry_date) return -1;
+    return static_cast<int>(it - expiry_names.begin());
+}
+
+size_t OptionChain::nearest_strike(size_t expiry, ChainSide side, double K) const {
+    size_t first = begin(expiry, side);
+    size_t last = end(expiry, side);
+    if (first == last) return size();
+
+    // The nearest strike is either the first one >= K or its predecessor
+    size_t row = std::lower_bound(strikes.begin() + first, strikes.begin() + last, K) - strikes.begin();
+    if (row == last) return last - 1;
+    if (row > first && fabs(strikes[row-1] - K) <= fabs(strikes[row] - K)) return row - 1;
+    return row;
+}
+
+size_t OptionChain::find_option(size_t expiry, ChainSide side, double K) const {
+    size_t row = nearest_strike(expiry, side, K);
+    return (row < size() && strikes[row] == K) ? row : size();
+}
+
+std::pair<size_t, size_t> OptionChain::strike_range(size_t expiry, ChainSide side,
+                                                    double K_low, double K_high) const {
+    auto seg_first = strikes.begin() + begin(expiry, side);
+    auto seg_last = strikes.begin() + end(expiry, side);
+    auto lo = std::lower_bound(seg_first, seg_last, K_low);
+    auto hi = std::upper_bound(lo, seg_last, K_high);
+    return std::make_pair(static_cast<size_t>(lo - strikes.begin()),
+                          static_cast<size_t>(hi - strikes.begin()));
+}
+
+void OptionChain::set_quote(size_t row, double _bid, double _ask) {
+    bids[row] = _bid;
+    asks[row] = _ask;
+    mids[row] = 0.5 * (_bid + _ask);
+}
+
+ArrayView<double> OptionChain::strikes_of(size_t expiry, ChainSide side) const {
+    return ArrayView<double>(strikes.data() + begin(expiry, side), end(expiry, side) - begin(expiry, side));
+}
+
+ArrayView<double> OptionChain::mids_of(size_t expiry, ChainSide side) const {
+    return ArrayView<double>(mids.data() + begin(expiry, side), end(expiry, side) - begin(expiry, side));
+}
+
+ArrayView<double> OptionChain::implied_vols_of(size_t expiry, ChainSide side) const {
+    return ArrayView<double>(implied_vols.data() + begin(expiry, side), end(expiry, side) - begin(expiry, side));
+}
+
+#endif
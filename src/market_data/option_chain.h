@@ -0,0 +1,126 @@
+#ifndef __OPTION_CHAIN_H
+#define __OPTION_CHAIN_H
+
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+#include "array_view.h"
+#include "market_data.h"
+#include "snapshot.h"
+#include "yield_curve.h"
+
+enum ChainSide {
+    CHAIN_CALLS,
+    CHAIN_PUTS,
+    CHAIN_NUM_SIDES
+};
+
+// Flat, indexed option chain. Expiries are addressed by integer index (in
+// date order) and every (expiry, side) pair owns a contiguous, strike-sorted
+// segment of rows. Each field is stored as its own array, so nearest-strike
+// lookups and strike range queries are binary searches over one segment.
+//
+// All columns come from the memory resource given at construction, e.g.
+// scratch_resource() for a chain that lives for one snapshot. A copy uses
+// the default resource; build() and assignment keep the chain's own.
+class OptionChain {
+private:
+    double spot;
+    double rate;
+    std::string date;
+    YieldCurve curve;
+
+    std::pmr::vector<std::string> expiry_names;
+    std::pmr::vector<double> expiry_days;
+    std::pmr::vector<double> expiry_discounts; // P(0,T) on the expiry grid
+    std::pmr::vector<double> expiry_rates;     // Zero rate to each expiry
+    std::pmr::vector<size_t> segment_begin; // Size 2 * num_expiries + 1
+
+    std::pmr::vector<double> strikes;
+    std::pmr::vector<double> bids;
+    std::pmr::vector<double> asks;
+    std::pmr::vector<double> mids;
+    std::pmr::vector<double> volumes;
+    std::pmr::vector<double> open_interests;
+    std::pmr::vector<double> implied_vols;
+
+    size_t segment(size_t expiry, ChainSide side) const { return 2 * expiry + side; }
+    void clear();
+    void set_market(const MarketData& market);
+    void append_expiry(const std::string& expiry_date, const std::vector<OptionData>& options);
+    void cache_discounts();
+    void check_expiry_order() const;
+
+public:
+    OptionChain(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    OptionChain(const MarketData& market,
+                std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    OptionChain(const MarketSnapshot& snapshot,
+                std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    void build(const MarketData& market);
+    void build(const MarketSnapshot& snapshot);
+
+    // A chain of the one listed expiry, e.g. for a per-expiry pipeline stage.
+    // Empty if the market does not list it
+    void build(const MarketData& market, const std::string& expiry_date);
+
+    double spot_price() const { return spot; }
+    double risk_free_rate() const { return rate; }
+    const std::string& market_date() const { return date; }
+
+    // Discounting defaults to a flat curve at risk_free_rate(). Discount
+    // factors and zero rates are cached per expiry, so pricing a listed
+    // option never has to evaluate the curve
+    const YieldCurve& yield_curve() const { return curve; }
+    void set_yield_curve(const YieldCurve& _curve);
+    double discount_factor(size_t expiry) const { return expiry_discounts[expiry]; }
+    double zero_rate(size_t expiry) const { return expiry_rates[expiry]; }
+
+    // Expiries, in the string order of their keys. find_expiry() binary
+    // searches the keys, and the index is date order only if the keys sort
+    // like dates, i.e. are year-first and fixed-width such as ISO YYYY-MM-DD.
+    // build() warns on stderr when days to expiry fall along the index
+    size_t num_expiries() const { return expiry_names.size(); }
+    const std::string& expiry_date(size_t expiry) const { return expiry_names[expiry]; }
+    double days_to_expiry(size_t expiry) const { return expiry_days[expiry]; }
+    int find_expiry(const std::string& expiry_date) const; // -1 if absent
+    bool expiries_in_date_order() const;
+
+    // Rows of one expiry and side are [begin(expiry, side), end(expiry, side))
+    size_t size() const { return strikes.size(); }
+    size_t begin(size_t expiry, ChainSide side) const { return segment_begin[segment(expiry, side)]; }
+    size_t end(size_t expiry, ChainSide side) const { return segment_begin[segment(expiry, side) + 1]; }
+
+    // Row whose strike is closest to K, or size() if the segment is empty
+    size_t nearest_strike(size_t expiry, ChainSide side, double K) const;
+
+    // Rows with K_low <= strike <= K_high, as a half-open [first, second) range
+    std::pair<size_t, size_t> strike_range(size_t expiry, ChainSide side,
+                                           double K_low, double K_high) const;
+
+    // Row with exactly this strike, or size() if there is none
+    size_t find_option(size_t expiry, ChainSide side, double K) const;
+
+    // Per-row fields
+    double strike(size_t row) const { return strikes[row]; }
+    double bid(size_t row) const { return bids[row]; }
+    double ask(size_t row) const { return asks[row]; }
+    double mid_price(size_t row) const { return mids[row]; }
+    double volume(size_t row) const { return volumes[row]; }
+    double open_interest(size_t row) const { return open_interests[row]; }
+    double implied_vol(size_t row) const { return implied_vols[row]; }
+
+    // In-place updates, e.g. when replaying a quote stream
+    void set_spot_price(double S) { spot = S; }
+    void set_quote(size_t row, double _bid, double _ask);
+    void set_implied_vol(size_t row, double sigma) { implied_vols[row] = sigma; }
+
+    // Column slices for a single (expiry, side) segment
+    ArrayView<double> strikes_of(size_t expiry, ChainSide side) const;
+    ArrayView<double> mids_of(size_t expiry, ChainSide side) const;
+    ArrayView<double> implied_vols_of(size_t expiry, ChainSide side) const;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef __QUOTE_H
+#define __QUOTE_H
+
+#include <algorithm>
+#include <vector>
+
+// Observer side of the market data dependency graph. update() is called
+// whenever something the observer registered with has changed; it should
+// only record the fact (e.g. set a dirty flag) and leave the real work until
+// a result is asked for.
+class Observer {
+public:
+    virtual ~Observer() {}
+    virtual void update() = 0;
+};
+
+// Keeps the list of observers to notify. Observers hold raw pointers back to
+// what they observe, so an Observable must outlive everything registered
+// with it and cannot be copied.
+class Observable {
+private:
+    std::vector<Observer*> observers;
+
+public:
+    Observable() {}
+    Observable(const Observable&) = delete;
+    Observable& operator=(const Observable&) = delete;
+    virtual ~Observable() {}
+
+    void register_observer(Observer* o) { observers.push_back(o); }
+
+    void unregister_observer(Observer* o) {
+        auto it = std::find(observers.begin(), observers.end(), o);
+        if (it != observers.end()) {
+            *it = observers.back();
+            observers.pop_back();
+        }
+    }
+
+    size_t num_observers() const { return observers.size(); }
+
+    void notify_observers() {
+        for (size_t i = 0; i < observers.size(); i++) observers[i]->update();
+    }
+};
+
+// A single observable market value: a spot, a zero rate, one node of a
+// volatility grid. Setting the value it already has notifies nobody.
+class Quote : public Observable {
+private:
+    double v;
+
+public:
+    Quote(double _v = 0.0) : v(_v) {}
+
+    double value() const { return v; }
+
+    void set_value(double _v) {
+        if (_v == v) return;
+        v = _v;
+        notify_observers();
+    }
+};
+
+#endif
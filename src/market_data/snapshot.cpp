@@ -0,0 +1,284 @@
+#ifndef __SNAPSHOT_CPP
+#define __SNAPSHOT_CPP
+
+#include "snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+const char SNAPSHOT_MAGIC[8] = {'Q', 'F', 'S', 'N', 'A', 'P', '\0', '\0'};
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+const uint64_t SNAPSHOT_ALIGNMENT = 64;
+
+static uint64_t snapshot_align(uint64_t offset) {
+    return (offset + SNAPSHOT_ALIGNMENT - 1) & ~(SNAPSHOT_ALIGNMENT - 1);
+}
+
+// True if count elements of T starting at offset lie inside a file of
+// file_size bytes and are aligned for T. Written so that no intermediate can
+// overflow whatever the header holds
+template <typename T>
+static bool snapshot_section_fits(uint64_t offset, uint64_t count, uint64_t file_size) {
+    return offset <= file_size && offset % alignof(T) == 0 && count <= (file_size - offset) / sizeof(T);
+}
+
+static double snapshot_field(const OptionData& opt, int col) {
+    switch (col) {
+    case SNAP_DAYS_TO_EXPIRY: return opt.days_to_expiry;
+    case SNAP_STRIKE: return opt.strike;
+    case SNAP_BID: return opt.bid;
+    case SNAP_ASK: return opt.ask;
+    case SNAP_MID_PRICE: return opt.mid_price;
+    case SNAP_VOLUME: return opt.volume;
+    case SNAP_OPEN_INTEREST: return opt.open_interest;
+    default: return opt.implied_vol;
+    }
+}
+
+// =====================
+// write_market_snapshot
+// =====================
+
+bool write_market_snapshot(const std::string& path, const MarketData& market) {
+    // Split every chain into strike-sorted calls and puts. The map is
+    // already ordered by expiry, which fixes the dictionary order
+    std::vector<const OptionData*> rows[SNAP_NUM_SIDES];
+    std::vector<uint32_t> expiry_idx[SNAP_NUM_SIDES];
+    std::vector<SnapshotExpiry> expiries;
+
+    for (const auto& chain : market.option_chains) {
+        SnapshotExpiry e;
+        memset(&e, 0, sizeof(e));
+        if (chain.first.size() >= sizeof(e.name)) {
+            std::cerr << "Expiry key '" << chain.first << "' is too long for a snapshot." << std::endl;
+            return false;
+        }
+        memcpy(e.name, chain.first.data(), chain.first.size());
+        e.days_to_expiry = chain.second.empty() ? 0.0 : chain.second[0].days_to_expiry;
+
+        for (int side=0; side<SNAP_NUM_SIDES; side++) {
+            char type = (side == SNAP_CALLS) ? 'C' : 'P';
+            e.begin[side] = rows[side].size();
+            for (const auto& opt : chain.second) {
+                if (opt.type == type) rows[side].push_back(&opt);
+            }
+            std::sort(rows[side].begin() + e.begin[side], rows[side].end(),
+                      [](const OptionData* a, const OptionData* b) { return a->strike < b->strike; });
+            e.count[side] = rows[side].size() - e.begin[side];
+            expiry_idx[side].resize(rows[side].size(), static_cast<uint32_t>(expiries.size()));
+        }
+        expiries.push_back(e);
+    }
+
+    // Lay out the header, dictionary and columns
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.spot_price = market.spot_price;
+    header.risk_free_rate = market.risk_free_rate;
+    strncpy(header.date, market.date.c_str(), sizeof(header.date) - 1);
+    header.num_expiries = expiries.size();
+    header.expiry_offset = snapshot_align(sizeof(SnapshotHeader));
+
+    uint64_t offset = snapshot_align(header.expiry_offset + expiries.size() * sizeof(SnapshotExpiry));
+    for (int side=0; side<SNAP_NUM_SIDES; side++) {
+        header.num_rows[side] = rows[side].size();
+        header.expiry_index_offset[side] = offset;
+        offset = snapshot_align(offset + rows[side].size() * sizeof(uint32_t));
+        for (int col=0; col<SNAP_NUM_COLUMNS; col++) {
+            header.column_offset[side][col] = offset;
+            offset = snapshot_align(offset + rows[side].size() * sizeof(double));
+        }
+    }
+
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Unable to open " << path << " for writing." << std::endl;
+        return false;
+    }
+
+    const char zeros[SNAPSHOT_ALIGNMENT] = {0};
+    auto pad_to = [&](uint64_t target) {
+        uint64_t pos = static_cast<uint64_t>(out.tellp());
+        out.write(zeros, static_cast<std::streamsize>(target - pos));
+    };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    pad_to(header.expiry_offset);
+    out.write(reinterpret_cast<const char*>(expiries.data()),
+              static_cast<std::streamsize>(expiries.size() * sizeof(SnapshotExpiry)));
+
+    std::vector<double> column;
+    for (int side=0; side<SNAP_NUM_SIDES; side++) {
+        pad_to(header.expiry_index_offset[side]);
+        out.write(reinterpret_cast<const char*>(expiry_idx[side].data()),
+                  static_cast<std::streamsize>(expiry_idx[side].size() * sizeof(uint32_t)));
+        for (int col=0; col<SNAP_NUM_COLUMNS; col++) {
+            column.resize(rows[side].size());
+            for (size_t i=0; i<rows[side].size(); i++) {
+                column[i] = snapshot_field(*rows[side][i], col);
+            }
+            pad_to(header.column_offset[side][col]);
+            out.write(reinterpret_cast<const char*>(column.data()),
+                      static_cast<std::streamsize>(column.size() * sizeof(double)));
+        }
+    }
+    pad_to(offset);
+
+    if (!out) {
+        std::cerr << "Error while writing " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ==============
+// MarketSnapshot
+// ==============
+
+MarketSnapshot::MarketSnapshot() : header(nullptr), expiries(nullptr) {}
+
+bool MarketSnapshot::open(const std::string& path) {
+    header = nullptr;
+    expiries = nullptr;
+    if (!file.open(path)) return false;
+
+    if (file.size() < sizeof(SnapshotHeader)) {
+        std::cerr << path << " is too small to be a market snapshot." << std::endl;
+        return false;
+    }
+
+    const SnapshotHeader* h = reinterpret_cast<const SnapshotHeader*>(file.data());
+    if (memcmp(h->magic, SNAPSHOT_MAGIC, sizeof(h->magic)) != 0) {
+        std::cerr << path << " is not a market snapshot." << std::endl;
+        return false;
+    }
+    if (h->byte_order != SNAPSHOT_BYTE_ORDER) {
+        std::cerr << path << " was written on a host with a different byte order." << std::endl;
+        return false;
+    }
+    if (h->version != SNAPSHOT_VERSION) {
+        std::cerr << path << " has snapshot version " << h->version
+                  << ", expected " << SNAPSHOT_VERSION << std::endl;
+        return false;
+    }
+
+    // Every section must lie inside the mapping
+    bool in_bounds = snapshot_section_fits<SnapshotExpiry>(h->expiry_offset, h->num_expiries, file.size());
+    for (int side=0; side<SNAP_NUM_SIDES; side++) {
+        in_bounds = in_bounds &&
+            snapshot_section_fits<uint32_t>(h->expiry_index_offset[side], h->num_rows[side], file.size());
+        for (int col=0; col<SNAP_NUM_COLUMNS; col++) {
+            in_bounds = in_bounds &&
+                snapshot_section_fits<double>(h->column_offset[side][col], h->num_rows[side], file.size());
+        }
+    }
+    if (!in_bounds) {
+        std::cerr << path << " is truncated." << std::endl;
+        return false;
+    }
+
+    // The dictionary must be in date order and its slices must tile each
+    // side's rows in that order, since the accessors index the columns
+    // unchecked and OptionChain binary searches the names and strikes
+    auto corrupt = [&](uint64_t expiry, int side, const char* what) {
+        std::cerr << path << " is corrupt: expiry " << expiry << " " << what;
+        if (side >= 0) std::cerr << (side == SNAP_CALLS ? " (calls)" : " (puts)");
+        std::cerr << "." << std::endl;
+        return false;
+    };
+    const SnapshotExpiry* e = reinterpret_cast<const SnapshotExpiry*>(file.data() + h->expiry_offset);
+    uint64_t next_row[SNAP_NUM_SIDES] = {0, 0};
+    for (uint64_t i=0; i<h->num_expiries; i++) {
+        if (i > 0 && strncmp(e[i-1].name, e[i].name, sizeof(e[i].name)) >= 0) {
+            return corrupt(i, -1, "is out of date order");
+        }
+        for (int side=0; side<SNAP_NUM_SIDES; side++) {
+            if (e[i].begin[side] != next_row[side] ||
+                e[i].count[side] > h->num_rows[side] - e[i].begin[side]) {
+                return corrupt(i, side, "does not start where the previous one ends, or runs past the rows");
+            }
+            next_row[side] += e[i].count[side];
+        }
+    }
+    for (int side=0; side<SNAP_NUM_SIDES; side++) {
+        if (next_row[side] != h->num_rows[side]) {
+            return corrupt(h->num_expiries, side, "is missing: the slices do not cover every row");
+        }
+        const uint32_t* index = reinterpret_cast<const uint32_t*>(file.data() + h->expiry_index_offset[side]);
+        const double* strike = reinterpret_cast<const double*>(file.data() + h->column_offset[side][SNAP_STRIKE]);
+        for (uint64_t i=0; i<h->num_expiries; i++) {
+            uint64_t first = e[i].begin[side];
+            uint64_t last = first + e[i].count[side];
+            for (uint64_t row=first; row<last; row++) {
+                if (index[row] != i) return corrupt(i, side, "has rows indexed to another expiry");
+                if (!(row == first ? strike[row] == strike[row] : strike[row] >= strike[row-1])) {
+                    return corrupt(i, side, "has strikes that are NaN or out of order");
+                }
+            }
+        }
+    }
+
+    header = h;
+    expiries = reinterpret_cast<const SnapshotExpiry*>(file.data() + h->expiry_offset);
+    return true;
+}
+
+std::string MarketSnapshot::date() const {
+    return std::string(header->date, strnlen(header->date, sizeof(header->date)));
+}
+
+std::string MarketSnapshot::expiry_date(size_t expiry) const {
+    const char* name = expiries[expiry].name;
+    return std::string(name, strnlen(name, sizeof(expiries[expiry].name)));
+}
+
+ArrayView<uint32_t> MarketSnapshot::expiry_index(SnapshotSide side) const {
+    const uint32_t* ptr = reinterpret_cast<const uint32_t*>(file.data() + header->expiry_index_offset[side]);
+    return ArrayView<uint32_t>(ptr, header->num_rows[side]);
+}
+
+ArrayView<double> MarketSnapshot::column(SnapshotSide side, SnapshotColumn col) const {
+    const double* ptr = reinterpret_cast<const double*>(file.data() + header->column_offset[side][col]);
+    return ArrayView<double>(ptr, header->num_rows[side]);
+}
+
+ArrayView<double> MarketSnapshot::column(SnapshotSide side, SnapshotColumn col, size_t expiry) const {
+    return column(side, col).subview(expiries[expiry].begin[side], expiries[expiry].count[side]);
+}
+
+MarketData MarketSnapshot::to_market_data() const {
+    MarketData market;
+    market.spot_price = spot_price();
+    market.risk_free_rate = risk_free_rate();
+    market.date = date();
+
+    for (size_t e=0; e<num_expiries(); e++) {
+        std::vector<OptionData>& chain = market.option_chains[expiry_date(e)];
+        chain.reserve(expiries[e].count[SNAP_CALLS] + expiries[e].count[SNAP_PUTS]);
+
+        for (int side=0; side<SNAP_NUM_SIDES; side++) {
+            SnapshotSide s = static_cast<SnapshotSide>(side);
+            for (uint64_t i=expiries[e].begin[side]; i<expiries[e].begin[side] + expiries[e].count[side]; i++) {
+                OptionData opt;
+                opt.expiry_date = expiry_date(e);
+                opt.days_to_expiry = column(s, SNAP_DAYS_TO_EXPIRY)[i];
+                opt.strike = column(s, SNAP_STRIKE)[i];
+                opt.bid = column(s, SNAP_BID)[i];
+                opt.ask = column(s, SNAP_ASK)[i];
+                opt.mid_price = column(s, SNAP_MID_PRICE)[i];
+                opt.volume = column(s, SNAP_VOLUME)[i];
+                opt.open_interest = column(s, SNAP_OPEN_INTEREST)[i];
+                opt.implied_vol = column(s, SNAP_IMPLIED_VOL)[i];
+                opt.type = (s == SNAP_CALLS) ? 'C' : 'P';
+                chain.push_back(opt);
+            }
+        }
+    }
+    return market;
+}
+
+#endif
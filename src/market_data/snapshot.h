@@ -0,0 +1,103 @@
+#ifndef __SNAPSHOT_H
+#define __SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include "array_view.h"
+#include "mapped_file.h"
+#include "market_data.h"
+
+// Binary columnar snapshot of a MarketData object.
+//
+// File layout (native byte order, every column 64-byte aligned):
+//   SnapshotHeader
+//   SnapshotExpiry[num_expiries]     expiry dictionary, sorted by date
+//   for calls, then puts:
+//     uint32_t expiry_index[rows]    index into the expiry dictionary
+//     double   <column>[rows]        one array per SnapshotColumn
+//
+// Rows of each side are sorted by expiry and then strike, so every expiry
+// occupies a contiguous slice [begin, begin + count) of each column.
+
+const uint32_t SNAPSHOT_VERSION = 1;
+
+enum SnapshotSide {
+    SNAP_CALLS,
+    SNAP_PUTS,
+    SNAP_NUM_SIDES
+};
+
+enum SnapshotColumn {
+    SNAP_DAYS_TO_EXPIRY,
+    SNAP_STRIKE,
+    SNAP_BID,
+    SNAP_ASK,
+    SNAP_MID_PRICE,
+    SNAP_VOLUME,
+    SNAP_OPEN_INTEREST,
+    SNAP_IMPLIED_VOL,
+    SNAP_NUM_COLUMNS
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;  // 0x01020304 as written by the producing host
+    double spot_price;
+    double risk_free_rate;
+    char date[16];
+    uint64_t num_expiries;
+    uint64_t expiry_offset;
+    uint64_t num_rows[SNAP_NUM_SIDES];
+    uint64_t expiry_index_offset[SNAP_NUM_SIDES];
+    uint64_t column_offset[SNAP_NUM_SIDES][SNAP_NUM_COLUMNS];
+};
+
+struct SnapshotExpiry {
+    char name[16];  // NUL-padded expiry date
+    double days_to_expiry;
+    uint64_t begin[SNAP_NUM_SIDES];
+    uint64_t count[SNAP_NUM_SIDES];
+};
+
+// Writes the snapshot, returning false (with a message on stderr) on failure
+bool write_market_snapshot(const std::string& path, const MarketData& market);
+
+// A snapshot mapped read-only into memory. Opening only validates the header
+// and sets up views; the columns are paged in on first access.
+class MarketSnapshot {
+private:
+    MappedFile file;
+    const SnapshotHeader* header;
+    const SnapshotExpiry* expiries;
+
+public:
+    MarketSnapshot();
+
+    // Maps the file and checks every section lies inside it, the expiries
+    // are in date order, their slices tile each side's rows in that order,
+    // every expiry_index value names its slice's expiry and strikes ascend
+    // within each slice. Returns false (with a message on stderr) otherwise.
+    // This reads the index and strike columns once
+    bool open(const std::string& path);
+
+    double spot_price() const { return header->spot_price; }
+    double risk_free_rate() const { return header->risk_free_rate; }
+    std::string date() const;
+
+    size_t num_expiries() const { return header->num_expiries; }
+    std::string expiry_date(size_t expiry) const;
+    const SnapshotExpiry& expiry(size_t i) const { return expiries[i]; }
+
+    size_t num_rows(SnapshotSide side) const { return header->num_rows[side]; }
+    ArrayView<uint32_t> expiry_index(SnapshotSide side) const;
+    ArrayView<double> column(SnapshotSide side, SnapshotColumn col) const;
+
+    // Slice of a column covering a single expiry
+    ArrayView<double> column(SnapshotSide side, SnapshotColumn col, size_t expiry) const;
+
+    // Copy the snapshot back into the map-of-vectors representation
+    MarketData to_market_data() const;
+};
+
+#endif
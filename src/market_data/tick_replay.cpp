@@ -0,0 +1,231 @@
+#ifndef __TICK_REPLAY_CPP
+#define __TICK_REPLAY_CPP
+
+#include "tick_replay.h"
+#include "csv_fields.h"
+#include "mapped_file.h"
+#include "../math/statistics/accumulators.h"
+#include "../option_pricing/vanilla/vanilla_option.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// ==============
+// load_tick_file
+// ==============
+
+bool load_tick_file(const std::string& path, const OptionChain& chain,
+                    std::vector<TickUpdate>& updates,
+                    unsigned long* unmatched) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+
+    unsigned long skipped = 0;
+    unsigned long line_no = 0;
+    const char* p = file.data();
+    const char* end = p + file.size();
+
+    while (p < end) {
+        const char* line_end = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+        const char* line = p;
+        p = line_end + 1;
+        line_no++;
+
+        // Split the line into at most seven fields
+        const char* first[7];
+        const char* last[7];
+        int num_fields = 0;
+        for (const char* f = line; f <= line_end && num_fields < 7; ) {
+            const char* f_end = static_cast<const char*>(memchr(f, ',', line_end - f));
+            if (!f_end) f_end = line_end;
+            first[num_fields] = f;
+            last[num_fields] = f_end;
+            csv_trim(first[num_fields], last[num_fields]);
+            num_fields++;
+            f = f_end + 1;
+        }
+        if (num_fields == 0 || first[0] == last[0] || *first[0] == '#') continue;
+
+        TickUpdate u;
+        u.row = 0;
+        u.ask = 0.0;
+        bool ok = num_fields >= 3 && csv_parse_long(first[1], last[1], u.timestamp);
+
+        if (ok && *first[0] == 'U') {
+            // A spot that is not positive would turn every Greek into NaN
+            u.kind = TICK_UNDERLYING;
+            ok = csv_parse_double(first[2], last[2], u.bid) && std::isfinite(u.bid) && u.bid > 0.0;
+        } else if (ok && *first[0] == 'Q' && num_fields == 7) {
+            u.kind = TICK_QUOTE;
+            double K;
+            char type = (last[4] - first[4] == 1) ? *first[4] : '\0';
+            ok = csv_parse_double(first[3], last[3], K) &&
+                 csv_parse_double(first[5], last[5], u.bid) &&
+                 csv_parse_double(first[6], last[6], u.ask) &&
+                 std::isfinite(u.bid) && std::isfinite(u.ask) && u.bid >= 0.0 && u.ask >= 0.0 &&
+                 (type == 'C' || type == 'c' || type == 'P' || type == 'p');
+            if (ok) {
+                int expiry = chain.find_expiry(std::string(first[2], last[2]));
+                ChainSide side = (type == 'C' || type == 'c') ? CHAIN_CALLS : CHAIN_PUTS;
+                u.row = (expiry >= 0) ? chain.find_option(expiry, side, K) : chain.size();
+                if (u.row == chain.size()) {
+                    skipped++;
+                    continue;
+                }
+            }
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << path << ":" << line_no << ": malformed tick." << std::endl;
+            return false;
+        }
+        updates.push_back(u);
+    }
+
+    if (unmatched) *unmatched = skipped;
+    return true;
+}
+
+// ==========
+// TickReplay
+// ==========
+
+TickReplay::TickReplay(OptionChain& _chain) : chain(_chain) {
+    memset(&stats, 0, sizeof(stats));
+    log_spot = log(chain.spot_price());
+    states.resize(chain.size());
+    greeks.resize(chain.size());
+
+    // Solve every implied vol once from the current mids, using the chain's
+    // own implied vols (where present) as starting points
+    for (size_t e=0; e<chain.num_expiries(); e++) {
+        double T = chain.days_to_expiry(e) / 365.0;
+        for (int side=0; side<CHAIN_NUM_SIDES; side++) {
+            ChainSide s = static_cast<ChainSide>(side);
+            for (size_t row=chain.begin(e, s); row<chain.end(e, s); row++) {
+                OptionState& st = states[row];
+                st.is_call = (s == CHAIN_CALLS);
+                st.active = T > 0.0;
+                st.T = T;
+                st.r = chain.zero_rate(e);
+                st.sqrt_T = sqrt(T);
+                st.log_K = log(chain.strike(row));
+                st.df_K = chain.strike(row) * chain.discount_factor(e);
+                greeks[row] = BlackScholesGreeks();
+                if (!st.active) continue;
+
+                double init = (chain.implied_vol(row) > 0.0) ? chain.implied_vol(row) : 0.2;
+                double sigma = calc_implied_vol(st.is_call, chain.mid_price(row), chain.spot_price(),
+                                                chain.strike(row), st.r, T, init);
+                if (std::isnan(sigma)) sigma = init;
+                set_vol(row, sigma);
+                reprice(row);
+            }
+        }
+    }
+}
+
+void TickReplay::set_vol(size_t row, double sigma) {
+    OptionState& st = states[row];
+    st.sigma = sigma;
+    st.sigma_sqrt_T = sigma * st.sqrt_T;
+    st.drift_T = (st.r + 0.5 * sigma * sigma) * st.T;
+    chain.set_implied_vol(row, sigma);
+}
+
+// Black-Scholes price and Greeks from the cached invariants and log spot
+void TickReplay::reprice(size_t row) {
+    const OptionState& st = states[row];
+    double S = chain.spot_price();
+    double r = st.r;
+
+    double d_1 = (log_spot - st.log_K + st.drift_T) / st.sigma_sqrt_T;
+    double d_2 = d_1 - st.sigma_sqrt_T;
+    double pdf_d_1 = exp(-0.5 * d_1 * d_1) / sqrt(2.0 * M_PI);
+    double N_d_1 = N(d_1);
+    double N_d_2 = N(d_2);
+
+    BlackScholesGreeks& g = greeks[row];
+    g.gamma = pdf_d_1 / (S * st.sigma_sqrt_T);
+    g.vega = S * pdf_d_1 * st.sqrt_T;
+    double decay = -S * pdf_d_1 * st.sigma / (2.0 * st.sqrt_T);
+
+    if (st.is_call) {
+        g.price = S * N_d_1 - st.df_K * N_d_2;
+        g.delta = N_d_1;
+        g.theta = decay - r * st.df_K * N_d_2;
+        g.rho = st.T * st.df_K * N_d_2;
+    } else {
+        g.price = st.df_K * (1.0 - N_d_2) - S * (1.0 - N_d_1);
+        g.delta = N_d_1 - 1.0;
+        g.theta = decay + r * st.df_K * (1.0 - N_d_2);
+        g.rho = -st.T * st.df_K * (1.0 - N_d_2);
+    }
+    stats.reprices++;
+}
+
+void TickReplay::apply(const TickUpdate& update) {
+    stats.updates++;
+
+    // Updates built in memory bypass load_tick_file's checks
+    bool valid = (update.kind == TICK_UNDERLYING)
+        ? std::isfinite(update.bid) && update.bid > 0.0
+        : update.row < states.size() && std::isfinite(update.bid) && std::isfinite(update.ask);
+    if (!valid) {
+        stats.rejected++;
+        return;
+    }
+
+    if (update.kind == TICK_UNDERLYING) {
+        stats.underlying_updates++;
+        chain.set_spot_price(update.bid);
+        log_spot = log(update.bid);
+        for (size_t row=0; row<states.size(); row++) {
+            if (states[row].active) reprice(row);
+        }
+        return;
+    }
+
+    stats.quote_updates++;
+    size_t row = update.row;
+    chain.set_quote(row, update.bid, update.ask);
+    OptionState& st = states[row];
+    if (!st.active) return;
+
+    stats.iv_solves++;
+    double sigma = calc_implied_vol(st.is_call, chain.mid_price(row), chain.spot_price(),
+                                    chain.strike(row), st.r, st.T, st.sigma);
+    if (std::isnan(sigma)) {
+        // Keep the last good vol for quotes that violate arbitrage bounds
+        stats.iv_failures++;
+        return;
+    }
+    set_vol(row, sigma);
+    reprice(row);
+}
+
+ReplayStats TickReplay::replay(const std::vector<TickUpdate>& updates) {
+    TDigest latency;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const auto& update : updates) {
+        auto t0 = std::chrono::steady_clock::now();
+        apply(update);
+        auto t1 = std::chrono::steady_clock::now();
+        latency.add(std::chrono::duration<double, std::nano>(t1 - t0).count());
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.p50_ns = latency.quantile(0.50);
+    stats.p90_ns = latency.quantile(0.90);
+    stats.p99_ns = latency.quantile(0.99);
+    stats.p999_ns = latency.quantile(0.999);
+    stats.max_ns = latency.quantile(1.0);
+    return stats;
+}
+
+#endif
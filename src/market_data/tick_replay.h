@@ -0,0 +1,99 @@
+#ifndef __TICK_REPLAY_H
+#define __TICK_REPLAY_H
+
+#include <string>
+#include <vector>
+#include "option_chain.h"
+#include "../option_pricing/vanilla/black_scholes.h"
+
+// Replays a recorded stream of market updates against an OptionChain,
+// keeping implied vols and Greeks current while touching as little as
+// possible per update:
+//   - a quote update re-solves the implied vol (warm-started from the previous
+//     value) and Greeks of that one option only;
+//   - an underlying update reprices every option at its current implied vol
+//     (sticky strike), using cached per-option invariants so that each option
+//     costs two N() evaluations and one exp() rather than a full pricing.
+//
+// Tick file format, one update per line ('#' starts a comment):
+//   U,<timestamp_ns>,<spot>
+//   Q,<timestamp_ns>,<expiry_date>,<strike>,<C|P>,<bid>,<ask>
+
+enum TickKind {
+    TICK_UNDERLYING,
+    TICK_QUOTE
+};
+
+struct TickUpdate {
+    long long timestamp; // As recorded, in nanoseconds
+    TickKind kind;
+    size_t row;          // Chain row of a quote update
+    double bid;          // New spot for an underlying update
+    double ask;
+};
+
+// Reads a tick file, resolving every quote to its chain row. Quotes for
+// options that are not in the chain are skipped and counted in unmatched.
+// Returns false on a malformed line, including a spot that is not positive
+// and finite or a quote that is negative or not finite
+bool load_tick_file(const std::string& path, const OptionChain& chain,
+                    std::vector<TickUpdate>& updates,
+                    unsigned long* unmatched = nullptr);
+
+struct ReplayStats {
+    unsigned long updates;
+    unsigned long underlying_updates;
+    unsigned long quote_updates;
+    unsigned long rejected;      // Invalid updates, ignored by apply()
+    unsigned long iv_solves;
+    unsigned long iv_failures;   // Quotes outside the no-arbitrage bounds
+    unsigned long reprices;      // Per-option Greeks recomputations
+    double seconds;
+    double p50_ns;               // Per-update latency percentiles
+    double p90_ns;
+    double p99_ns;
+    double p999_ns;
+    double max_ns;
+};
+
+class TickReplay {
+private:
+    // Quantities that only change when the option's implied vol does
+    struct OptionState {
+        bool is_call;
+        bool active;      // False for expired options
+        double T;
+        double r;         // Zero rate to expiry
+        double sqrt_T;
+        double log_K;
+        double df_K;      // K * P(0,T), from the chain's cached discount factors
+        double sigma;
+        double sigma_sqrt_T;
+        double drift_T;   // (r + sigma^2/2) * T
+    };
+
+    OptionChain& chain;
+    std::vector<OptionState> states;
+    std::vector<BlackScholesGreeks> greeks;
+    double log_spot;
+    ReplayStats stats;
+
+    void set_vol(size_t row, double sigma);
+    void reprice(size_t row);
+
+public:
+    TickReplay(OptionChain& _chain);
+
+    // Apply one update to the chain and refresh the affected options.
+    // Updates with a non-positive or non-finite spot, a non-finite quote or
+    // a row outside the chain are ignored and counted as rejected
+    void apply(const TickUpdate& update);
+
+    // Apply every update in order, timing each one
+    ReplayStats replay(const std::vector<TickUpdate>& updates);
+
+    const BlackScholesGreeks& greeks_of(size_t row) const { return greeks[row]; }
+    const ReplayStats& statistics() const { return stats; }
+};
+
+#endif
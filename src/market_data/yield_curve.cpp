@@ -0,0 +1,136 @@
+#ifndef __YIELD_CURVE_CPP
+#define __YIELD_CURVE_CPP
+
+#include "yield_curve.h"
+#include "../implied_volatility/interval_bisection.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Zero rates searched for each node during the bootstrap
+const double CURVE_MIN_ZERO = -0.5;
+const double CURVE_MAX_ZERO = 1.0;
+
+YieldCurve::YieldCurve(double flat_rate, CurveInterpolation _interpolation,
+                       std::pmr::memory_resource* resource)
+    : interpolation(_interpolation), times(1, 1.0, resource), zeros(1, flat_rate, resource) {}
+
+void YieldCurve::set_flat_rate(double flat_rate) {
+    interpolation = CURVE_LINEAR_ZERO;
+    times.assign(1, 1.0);
+    zeros.assign(1, flat_rate);
+}
+
+double YieldCurve::log_discount(double T) const {
+    size_t n = times.size();
+    if (T <= 0.0) return 0.0;
+
+    size_t i = std::upper_bound(times.begin(), times.end(), T) - times.begin();
+
+    if (interpolation == CURVE_LINEAR_ZERO) {
+        double z;
+        if (i == 0) {
+            z = zeros[0];
+        } else if (i == n) {
+            z = zeros[n-1];
+        } else {
+            double w = (T - times[i-1]) / (times[i] - times[i-1]);
+            z = zeros[i-1] + w * (zeros[i] - zeros[i-1]);
+        }
+        return -z * T;
+    }
+
+    // Log-linear discount factors, with an implicit node P(0,0) = 1
+    if (i == 0) return -zeros[0] * T;
+    double t_0 = times[i-1];
+    double l_0 = -zeros[i-1] * t_0;
+    double fwd;
+    if (i == n) {
+        fwd = (n == 1) ? zeros[0] : (zeros[n-1] * times[n-1] - zeros[n-2] * times[n-2]) / (times[n-1] - times[n-2]);
+    } else {
+        fwd = (zeros[i] * times[i] - zeros[i-1] * t_0) / (times[i] - t_0);
+    }
+    return l_0 - fwd * (T - t_0);
+}
+
+double YieldCurve::discount(double T) const {
+    return exp(log_discount(T));
+}
+
+double YieldCurve::zero_rate(double T) const {
+    return (T > 0.0) ? -log_discount(T) / T : zeros[0];
+}
+
+double YieldCurve::forward_rate(double T_1, double T_2) const {
+    if (T_2 <= T_1) return zero_rate(T_1);
+    return (log_discount(T_1) - log_discount(T_2)) / (T_2 - T_1);
+}
+
+void YieldCurve::discount(const double* T, double* df, size_t n) const {
+    for (size_t i=0; i<n; i++) {
+        df[i] = discount(T[i]);
+    }
+}
+
+// Quote implied by the current curve for an instrument
+double YieldCurve::par_rate(const CurveInstrument& inst) const {
+    if (inst.type != CURVE_SWAP) {
+        double tau = inst.maturity - inst.start;
+        return (exp(log_discount(inst.start) - log_discount(inst.maturity)) - 1.0) / tau;
+    }
+
+    // Fixed leg dates roll back from maturity; the first period may be short
+    double period = 1.0 / std::max(inst.frequency, 1);
+    double annuity = 0.0;
+    for (double t=inst.maturity; t>inst.start + 1e-9; t-=period) {
+        double tau = std::min(period, t - inst.start);
+        annuity += tau * discount(t);
+    }
+    return (discount(inst.start) - discount(inst.maturity)) / annuity;
+}
+
+bool YieldCurve::bootstrap(const std::vector<CurveInstrument>& instruments,
+                           CurveInterpolation _interpolation) {
+    std::vector<CurveInstrument> sorted(instruments);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const CurveInstrument& a, const CurveInstrument& b) { return a.maturity < b.maturity; });
+    if (sorted.empty()) {
+        std::cerr << "Yield curve bootstrap needs at least one instrument." << std::endl;
+        return false;
+    }
+
+    YieldCurve fitted;
+    fitted.interpolation = _interpolation;
+    fitted.times.clear();
+    fitted.zeros.clear();
+
+    for (const CurveInstrument& inst : sorted) {
+        if (!(inst.maturity > inst.start) || inst.start < 0.0 ||
+            (!fitted.times.empty() && inst.maturity <= fitted.times.back())) {
+            std::cerr << "Yield curve instrument maturing at " << inst.maturity
+                      << " overlaps another or has no accrual period." << std::endl;
+            return false;
+        }
+
+        // The new node only moves the curve beyond the previous node, so the
+        // instrument's quote is increasing in the node's zero rate
+        fitted.times.push_back(inst.maturity);
+        fitted.zeros.push_back(0.0);
+        auto quote = [&](double z) {
+            fitted.zeros.back() = z;
+            return fitted.par_rate(inst);
+        };
+
+        if (!(inst.rate > quote(CURVE_MIN_ZERO) && inst.rate < quote(CURVE_MAX_ZERO))) {
+            std::cerr << "Yield curve instrument maturing at " << inst.maturity
+                      << " has an unattainable rate " << inst.rate << "." << std::endl;
+            return false;
+        }
+        fitted.zeros.back() = interval_bisection(inst.rate, CURVE_MIN_ZERO, CURVE_MAX_ZERO, 1e-12, quote);
+    }
+
+    *this = fitted;
+    return true;
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef __YIELD_CURVE_H
+#define __YIELD_CURVE_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+enum CurveInterpolation {
+    CURVE_LINEAR_ZERO,   // Continuously compounded zero rates linear in T
+    CURVE_LOG_LINEAR_DF  // Log discount factors linear in T (piecewise flat forwards)
+};
+
+enum CurveInstrumentType {
+    CURVE_DEPOSIT,  // Simple rate from start to maturity
+    CURVE_FUTURE,   // Implied forward rate (100 - price), no convexity adjustment
+    CURVE_SWAP      // Par rate of a fixed leg paying frequency times a year
+};
+
+// Market quote used to bootstrap the curve. Times are in years
+struct CurveInstrument {
+    CurveInstrumentType type;
+    double start;
+    double maturity;
+    double rate;
+    int frequency;
+};
+
+// Discount curve P(0,T) with one node per bootstrapped instrument. Zero
+// rates are flat before the first node; beyond the last node linear zero
+// curves stay flat in the zero rate and log-linear curves in the forward.
+class YieldCurve {
+private:
+    CurveInterpolation interpolation;
+    std::pmr::vector<double> times;  // Node times, increasing
+    std::pmr::vector<double> zeros;  // Continuously compounded zero rate at each node
+
+    double par_rate(const CurveInstrument& inst) const;
+
+public:
+    // The nodes are allocated from resource. Copies use the default
+    // resource, assignment keeps the target's
+    YieldCurve(double flat_rate = 0.0, CurveInterpolation _interpolation = CURVE_LINEAR_ZERO,
+               std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Back to a single flat node, reusing the node storage
+    void set_flat_rate(double flat_rate);
+
+    // Fit one node per instrument, shortest maturity first, so that every
+    // instrument reprices to its quote. Returns false if a quote cannot be
+    // matched, leaving the curve as it was
+    bool bootstrap(const std::vector<CurveInstrument>& instruments,
+                   CurveInterpolation _interpolation = CURVE_LINEAR_ZERO);
+
+    size_t num_nodes() const { return times.size(); }
+    double node_time(size_t i) const { return times[i]; }
+    double node_zero_rate(size_t i) const { return zeros[i]; }
+
+    double log_discount(double T) const;
+    double discount(double T) const;
+    double zero_rate(double T) const;
+
+    // Continuously compounded forward rate between T_1 and T_2
+    double forward_rate(double T_1, double T_2) const;
+
+    // Discount factors for a whole grid of times, e.g. a chain's expiries
+    // or the steps of a Monte Carlo path
+    void discount(const double* T, double* df, size_t n) const;
+};
+
+#endif
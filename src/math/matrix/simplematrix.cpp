@@ -8,10 +8,15 @@ template <typename Type>
 SimpleMatrix<Type> :: SimpleMatrix(){};
 
 template <typename Type>
-SimpleMatrix<Type> :: SimpleMatrix(const int& rows, const int& columns ,const Type& val){
+SimpleMatrix<Type> :: SimpleMatrix(const int& rows, const int& columns ,const Type& val)
+    : SimpleMatrix(rows, columns, val, std::pmr::get_default_resource()) {}
+
+template <typename Type>
+SimpleMatrix<Type> :: SimpleMatrix(const int& rows, const int& columns ,const Type& val,
+                                   std::pmr::memory_resource* resource) : mat(resource) {
+    mat.reserve(rows);
     for (int i = 0; i < rows; i++){
-        std::vector<Type> col_vec(columns,val);
-        mat.push_back(col_vec);
+        mat.emplace_back(columns, val);  // Row allocated from mat's resource
     }
 }
 
@@ -19,7 +24,7 @@ SimpleMatrix<Type> :: SimpleMatrix(const int& rows, const int& columns ,const Ty
 template <typename Type>
 SimpleMatrix<Type> &SimpleMatrix<Type>::operator=(const SimpleMatrix<Type>& _rhs){
     if(this == &_rhs)return *this;
-    mat = _rhs.get_mat();
+    mat = _rhs.mat;  // Copied into this matrix's resource
     return *this;
 }
 //Destructor 
@@ -30,7 +35,9 @@ SimpleMatrix<Type>:: ~SimpleMatrix() {}
 // Matrix access method , via copying
 template <typename Type>
 std::vector<std::vector<Type> > SimpleMatrix<Type>::get_mat() const {
-    return mat;
+    std::vector<std::vector<Type> > copy;
+    for (const auto& row : mat) copy.emplace_back(row.begin(), row.end());
+    return copy;
 }
 
 // Matrix access method, via row and column index
@@ -1,12 +1,14 @@
 #ifndef __SIMPLEMATRIX_H
 #define __SIMPLEMATRIX_H
 
+#include <memory_resource>  // Rows may come from a scratch arena
 #include <vector>  // Need this to store matrix values
 
 template < typename Type = double> class SimpleMatrix {
     private :
-    // Use a "vector of vectors " to store the values
-        std::vector<std::vector<Type> > mat;
+    // Use a "vector of vectors " to store the values. The rows share the
+    // outer vector's memory resource
+        std::pmr::vector<std::pmr::vector<Type> > mat;
 
     public:
         SimpleMatrix(); //Default Constructor
@@ -14,6 +16,10 @@ template < typename Type = double> class SimpleMatrix {
         //Constructor specifying rows , columns and default value
         SimpleMatrix(const int& rows, const int& columns ,const Type& val);
 
+        //As above, with the values allocated from resource
+        SimpleMatrix(const int& rows, const int& columns ,const Type& val,
+                     std::pmr::memory_resource* resource);
+
         //Copy Constructor
         SimpleMatrix(const SimpleMatrix<Type>& rhs);
 
@@ -0,0 +1,135 @@
+#ifndef __LEVENBERG_MARQUARDT_H
+#define __LEVENBERG_MARQUARDT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+struct LevenbergMarquardtResult {
+    double cost;     // Final sum of squared residuals
+    int iterations;
+    bool converged;
+};
+
+// Solves the N x N system A x = b in place by Gaussian elimination with
+// partial pivoting. Returns false if A is numerically singular
+template<size_t N>
+bool solve_linear_system(double A[N][N], double b[N], double x[N]) {
+    for (size_t col=0; col<N; col++) {
+        size_t pivot = col;
+        for (size_t row=col+1; row<N; row++) {
+            if (fabs(A[row][col]) > fabs(A[pivot][col])) pivot = row;
+        }
+        if (fabs(A[pivot][col]) < 1e-300) return false;
+        if (pivot != col) {
+            for (size_t k=0; k<N; k++) std::swap(A[col][k], A[pivot][k]);
+            std::swap(b[col], b[pivot]);
+        }
+        for (size_t row=col+1; row<N; row++) {
+            double f = A[row][col] / A[col][col];
+            for (size_t k=col; k<N; k++) A[row][k] -= f * A[col][k];
+            b[row] -= f * b[col];
+        }
+    }
+    for (size_t i=N; i-- > 0; ) {
+        double sum = b[i];
+        for (size_t k=i+1; k<N; k++) sum -= A[i][k] * x[k];
+        x[i] = sum / A[i][i];
+    }
+    return true;
+}
+
+// Minimises sum_i r_i(p)^2 over N parameters with the Levenberg-Marquardt
+// method (Marquardt's diagonal scaling). The model object must provide
+//   size_t num_residuals() const;
+//   void residuals(const double* p, double* r, double* J) const;
+//       fills r[num_residuals] and, if J is non-null, the row-major
+//       num_residuals x N Jacobian dr_i/dp_j
+//   void project(double* p) const;
+//       maps p back onto the feasible parameter set after each step
+// p holds the starting point on entry and the solution on exit.
+template<size_t N, typename Model>
+LevenbergMarquardtResult levenberg_marquardt(const Model& model,
+                                             double* p,
+                                             int max_iter = 100,
+                                             double tolerance = 1e-10) {
+    size_t m = model.num_residuals();
+    std::vector<double> r(m), r_trial(m), J(m * N);
+
+    LevenbergMarquardtResult result;
+    result.iterations = 0;
+    result.converged = false;
+
+    model.project(p);
+    model.residuals(p, r.data(), J.data());
+    double cost = 0.0;
+    for (size_t i=0; i<m; i++) cost += r[i] * r[i];
+
+    double lambda = 1e-3;
+    while (result.iterations < max_iter) {
+        result.iterations++;
+
+        // Normal equations J^T J and gradient J^T r
+        double JtJ[N][N] = {};
+        double Jtr[N] = {};
+        for (size_t i=0; i<m; i++) {
+            const double* row = &J[i * N];
+            for (size_t a=0; a<N; a++) {
+                Jtr[a] += row[a] * r[i];
+                for (size_t b=a; b<N; b++) JtJ[a][b] += row[a] * row[b];
+            }
+        }
+        for (size_t a=0; a<N; a++) {
+            for (size_t b=0; b<a; b++) JtJ[a][b] = JtJ[b][a];
+        }
+
+        // Increase the damping until a step reduces the cost
+        bool accepted = false;
+        while (!accepted && lambda < 1e12) {
+            double A[N][N];
+            double g[N];
+            double delta[N];
+            for (size_t a=0; a<N; a++) {
+                for (size_t b=0; b<N; b++) A[a][b] = JtJ[a][b];
+                A[a][a] += lambda * (JtJ[a][a] > 0.0 ? JtJ[a][a] : 1.0);
+                g[a] = -Jtr[a];
+            }
+            if (!solve_linear_system<N>(A, g, delta)) {
+                lambda *= 10.0;
+                continue;
+            }
+
+            double p_trial[N];
+            for (size_t a=0; a<N; a++) p_trial[a] = p[a] + delta[a];
+            model.project(p_trial);
+            model.residuals(p_trial, r_trial.data(), nullptr);
+            double cost_trial = 0.0;
+            for (size_t i=0; i<m; i++) cost_trial += r_trial[i] * r_trial[i];
+
+            if (cost_trial < cost) {
+                double improvement = cost - cost_trial;
+                for (size_t a=0; a<N; a++) p[a] = p_trial[a];
+                model.residuals(p, r.data(), J.data());
+                lambda = std::max(lambda * 0.1, 1e-12);
+                accepted = true;
+                if (improvement <= tolerance * (cost + tolerance)) {
+                    result.converged = true;
+                }
+                cost = cost_trial;
+            } else {
+                lambda *= 10.0;
+            }
+        }
+
+        // A step that cannot be improved on is a (local) minimum
+        if (!accepted) result.converged = true;
+        if (result.converged) break;
+    }
+
+    result.cost = cost;
+    return result;
+}
+
+#endif
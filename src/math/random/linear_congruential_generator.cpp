@@ -30,14 +30,16 @@ LinearCongruentialGenerator::LinearCongruentialGenerator(
 
 // Obtains a random unsigned long integer
 unsigned long LinearCongruentialGenerator::get_random_integer() {
-    unsigned long k = 0;
-    k = cur_seed / q;
-    cur_seed = a * (cur_seed - k * q) - r * k;
+    // Schrage's step goes negative before the correction, so it has to be
+    // done in signed arithmetic
+    long k = static_cast<long>(cur_seed / q);
+    long next = static_cast<long>(a * (cur_seed - k * q)) - static_cast<long>(r) * k;
     
-    if (cur_seed < 0) {
-        cur_seed += m;
+    if (next < 0) {
+        next += m;
     }
 
+    cur_seed = static_cast<unsigned long>(next);
     return cur_seed;
 }
 
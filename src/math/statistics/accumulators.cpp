@@ -0,0 +1,357 @@
+#ifndef __ACCUMULATORS_CPP
+#define __ACCUMULATORS_CPP
+
+#include "accumulators.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// =================
+// MomentAccumulator
+// =================
+
+MomentAccumulator::MomentAccumulator() { reset(); }
+
+void MomentAccumulator::reset() {
+    n = 0;
+    m1 = 0.0;
+    m2 = 0.0;
+    m3 = 0.0;
+    m4 = 0.0;
+    min_x = std::numeric_limits<double>::infinity();
+    max_x = -std::numeric_limits<double>::infinity();
+}
+
+// Welford-style update of the first four central moments
+void MomentAccumulator::add(double x) {
+    double n1 = static_cast<double>(n);
+    n++;
+    double nd = static_cast<double>(n);
+
+    double delta = x - m1;
+    double delta_n = delta / nd;
+    double delta_n2 = delta_n * delta_n;
+    double term1 = delta * delta_n * n1;
+
+    m1 += delta_n;
+    m4 += term1 * delta_n2 * (nd*nd - 3.0*nd + 3.0) + 6.0 * delta_n2 * m2 - 4.0 * delta_n * m3;
+    m3 += term1 * delta_n * (nd - 2.0) - 3.0 * delta_n * m2;
+    m2 += term1;
+
+    min_x = std::min(min_x, x);
+    max_x = std::max(max_x, x);
+}
+
+void MomentAccumulator::add(const double* x, size_t count) {
+    for (size_t i=0; i<count; i++) {
+        add(x[i]);
+    }
+}
+
+// Pairwise combination of two sets of moments (Chan et al., Pebay)
+void MomentAccumulator::merge(const MomentAccumulator& rhs) {
+    if (rhs.n == 0) return;
+    if (n == 0) {
+        *this = rhs;
+        return;
+    }
+
+    double na = static_cast<double>(n);
+    double nb = static_cast<double>(rhs.n);
+    double nab = na + nb;
+
+    double delta = rhs.m1 - m1;
+    double delta2 = delta * delta;
+    double delta3 = delta * delta2;
+    double delta4 = delta2 * delta2;
+
+    double new_m1 = m1 + delta * nb / nab;
+    double new_m2 = m2 + rhs.m2 + delta2 * na * nb / nab;
+    double new_m3 = m3 + rhs.m3 + delta3 * na * nb * (na - nb) / (nab*nab)
+        + 3.0 * delta * (na * rhs.m2 - nb * m2) / nab;
+    double new_m4 = m4 + rhs.m4 + delta4 * na * nb * (na*na - na*nb + nb*nb) / (nab*nab*nab)
+        + 6.0 * delta2 * (na*na * rhs.m2 + nb*nb * m2) / (nab*nab)
+        + 4.0 * delta * (na * rhs.m3 - nb * m3) / nab;
+
+    n += rhs.n;
+    m1 = new_m1;
+    m2 = new_m2;
+    m3 = new_m3;
+    m4 = new_m4;
+    min_x = std::min(min_x, rhs.min_x);
+    max_x = std::max(max_x, rhs.max_x);
+}
+
+double MomentAccumulator::var() const {
+    return (n > 1) ? m2 / static_cast<double>(n - 1) : 0.0;
+}
+
+double MomentAccumulator::stdev() const { return sqrt(var()); }
+
+double MomentAccumulator::std_error() const {
+    return (n > 1) ? sqrt(var() / static_cast<double>(n)) : 0.0;
+}
+
+double MomentAccumulator::skew() const {
+    if (n < 2 || m2 == 0.0) return 0.0;
+    return sqrt(static_cast<double>(n)) * m3 / pow(m2, 1.5);
+}
+
+double MomentAccumulator::kurtosis() const {
+    if (n < 2 || m2 == 0.0) return 0.0;
+    return static_cast<double>(n) * m4 / (m2 * m2) - 3.0;
+}
+
+// ==========
+// P2Quantile
+// ==========
+
+P2Quantile::P2Quantile(double _p) : p(_p) { reset(); }
+
+void P2Quantile::reset() {
+    n = 0;
+    for (int i=0; i<5; i++) {
+        q[i] = 0.0;
+        pos[i] = i + 1.0;
+    }
+    desired[0] = 1.0;
+    desired[1] = 1.0 + 2.0*p;
+    desired[2] = 1.0 + 4.0*p;
+    desired[3] = 3.0 + 2.0*p;
+    desired[4] = 5.0;
+    incr[0] = 0.0;
+    incr[1] = 0.5*p;
+    incr[2] = p;
+    incr[3] = 0.5*(1.0 + p);
+    incr[4] = 1.0;
+}
+
+// Piecewise-parabolic prediction of the height of marker i moved by d
+double P2Quantile::parabolic(int i, double d) const {
+    return q[i] + d / (pos[i+1] - pos[i-1]) *
+        ((pos[i] - pos[i-1] + d) * (q[i+1] - q[i]) / (pos[i+1] - pos[i]) +
+         (pos[i+1] - pos[i] - d) * (q[i] - q[i-1]) / (pos[i] - pos[i-1]));
+}
+
+double P2Quantile::linear(int i, double d) const {
+    int j = i + static_cast<int>(d);
+    return q[i] + d * (q[j] - q[i]) / (pos[j] - pos[i]);
+}
+
+void P2Quantile::add(double x) {
+    // The first five samples initialise the markers directly
+    if (n < 5) {
+        q[n++] = x;
+        if (n == 5) std::sort(q, q + 5);
+        return;
+    }
+    n++;
+
+    // Find the cell containing x, extending the extreme markers if needed
+    int k;
+    if (x < q[0]) {
+        q[0] = x;
+        k = 0;
+    } else if (x >= q[4]) {
+        q[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && x >= q[k+1]) k++;
+    }
+
+    for (int i=k+1; i<5; i++) pos[i] += 1.0;
+    for (int i=0; i<5; i++) desired[i] += incr[i];
+
+    // Adjust the heights of the three middle markers if they are off position
+    for (int i=1; i<4; i++) {
+        double d = desired[i] - pos[i];
+        if ((d >= 1.0 && pos[i+1] - pos[i] > 1.0) ||
+            (d <= -1.0 && pos[i-1] - pos[i] < -1.0)) {
+            d = (d > 0.0) ? 1.0 : -1.0;
+            double qn = parabolic(i, d);
+            if (q[i-1] < qn && qn < q[i+1]) {
+                q[i] = qn;
+            } else {
+                q[i] = linear(i, d);
+            }
+            pos[i] += d;
+        }
+    }
+}
+
+double P2Quantile::quantile() const {
+    if (n == 0) return std::numeric_limits<double>::quiet_NaN();
+    if (n < 5) {
+        // Too few samples for the markers, so use the exact order statistic
+        double sorted[5];
+        std::copy(q, q + n, sorted);
+        std::sort(sorted, sorted + n);
+        size_t idx = static_cast<size_t>(p * (n - 1) + 0.5);
+        return sorted[idx];
+    }
+    return q[2];
+}
+
+// =======
+// TDigest
+// =======
+
+TDigest::TDigest(double _compression) : compression(_compression) { reset(); }
+
+void TDigest::reset() {
+    centroids.clear();
+    buffer.clear();
+    buffer.reserve(static_cast<size_t>(5 * compression));
+    total_weight = 0.0;
+    min_x = std::numeric_limits<double>::infinity();
+    max_x = -std::numeric_limits<double>::infinity();
+}
+
+// Arcsine scale function k(q) = delta / (2 pi) * asin(2q - 1) and its inverse
+double TDigest::scale_k(double q) const {
+    return compression / (2.0 * M_PI) * asin(2.0*q - 1.0);
+}
+
+double TDigest::scale_q(double k) const {
+    double angle = k * 2.0 * M_PI / compression;
+    if (angle >= 0.5 * M_PI) return 1.0;
+    return 0.5 * (sin(angle) + 1.0);
+}
+
+void TDigest::add(double x, double w) {
+    buffer.push_back({x, w});
+    total_weight += w;
+    min_x = std::min(min_x, x);
+    max_x = std::max(max_x, x);
+    if (buffer.size() >= static_cast<size_t>(5 * compression)) compress();
+}
+
+void TDigest::add(const double* x, size_t count) {
+    for (size_t i=0; i<count; i++) {
+        add(x[i]);
+    }
+}
+
+void TDigest::merge(const TDigest& rhs) {
+    if (rhs.total_weight == 0.0) return;
+    buffer.insert(buffer.end(), rhs.centroids.begin(), rhs.centroids.end());
+    buffer.insert(buffer.end(), rhs.buffer.begin(), rhs.buffer.end());
+    total_weight += rhs.total_weight;
+    min_x = std::min(min_x, rhs.min_x);
+    max_x = std::max(max_x, rhs.max_x);
+    compress();
+}
+
+// Fold the buffered samples into the centroid list. Adjacent centroids are
+// merged greedily as long as the merged centroid spans at most one unit of k
+void TDigest::compress() {
+    if (buffer.empty()) return;
+
+    buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+    std::sort(buffer.begin(), buffer.end(),
+              [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+
+    centroids.clear();
+    Centroid cur = buffer[0];
+    double weight_so_far = 0.0;
+    double q_limit = scale_q(scale_k(0.0) + 1.0);
+
+    for (size_t i=1; i<buffer.size(); i++) {
+        const Centroid& next = buffer[i];
+        double q = (weight_so_far + cur.weight + next.weight) / total_weight;
+        if (q <= q_limit) {
+            cur.weight += next.weight;
+            cur.mean += (next.mean - cur.mean) * next.weight / cur.weight;
+        } else {
+            weight_so_far += cur.weight;
+            centroids.push_back(cur);
+            q_limit = scale_q(scale_k(weight_so_far / total_weight) + 1.0);
+            cur = next;
+        }
+    }
+    centroids.push_back(cur);
+    buffer.clear();
+}
+
+double TDigest::quantile(double q) {
+    compress();
+    if (centroids.empty()) return std::numeric_limits<double>::quiet_NaN();
+    if (centroids.size() == 1) return centroids[0].mean;
+
+    q = std::min(std::max(q, 0.0), 1.0);
+    double index = q * total_weight;
+
+    // Left of the first centroid's centre, interpolate from the minimum
+    const Centroid& first = centroids.front();
+    if (index < 0.5 * first.weight) {
+        return min_x + (first.mean - min_x) * index / (0.5 * first.weight);
+    }
+
+    // Between centroid centres, interpolate linearly in cumulative weight
+    double weight_so_far = 0.5 * first.weight;
+    for (size_t i=0; i+1<centroids.size(); i++) {
+        double dw = 0.5 * (centroids[i].weight + centroids[i+1].weight);
+        if (weight_so_far + dw > index) {
+            double t = (index - weight_so_far) / dw;
+            return centroids[i].mean + t * (centroids[i+1].mean - centroids[i].mean);
+        }
+        weight_so_far += dw;
+    }
+
+    // Right of the last centroid's centre, interpolate to the maximum
+    const Centroid& last = centroids.back();
+    double t = std::min((index - weight_so_far) / (0.5 * last.weight), 1.0);
+    return last.mean + t * (max_x - last.mean);
+}
+
+double TDigest::cdf(double x) {
+    compress();
+    if (centroids.empty()) return std::numeric_limits<double>::quiet_NaN();
+    if (x < min_x) return 0.0;
+    if (x >= max_x) return 1.0;
+
+    const Centroid& first = centroids.front();
+    if (x < first.mean) {
+        double span = first.mean - min_x;
+        double frac = (span > 0.0) ? (x - min_x) / span : 1.0;
+        return frac * 0.5 * first.weight / total_weight;
+    }
+
+    double weight_so_far = 0.5 * first.weight;
+    for (size_t i=0; i+1<centroids.size(); i++) {
+        const Centroid& a = centroids[i];
+        const Centroid& b = centroids[i+1];
+        double dw = 0.5 * (a.weight + b.weight);
+        if (x < b.mean) {
+            double span = b.mean - a.mean;
+            double frac = (span > 0.0) ? (x - a.mean) / span : 1.0;
+            return (weight_so_far + frac * dw) / total_weight;
+        }
+        weight_so_far += dw;
+    }
+
+    const Centroid& last = centroids.back();
+    double span = max_x - last.mean;
+    double frac = (span > 0.0) ? (x - last.mean) / span : 1.0;
+    return (weight_so_far + frac * 0.5 * last.weight) / total_weight;
+}
+
+double TDigest::lower_tail_mean(double q) {
+    compress();
+    if (centroids.empty() || q <= 0.0) return std::numeric_limits<double>::quiet_NaN();
+
+    // Each centroid is treated as a point mass; the one straddling the
+    // quantile contributes only the part of its weight below it
+    double target = std::min(q, 1.0) * total_weight;
+    double weight_so_far = 0.0;
+    double sum = 0.0;
+    for (size_t i=0; i<centroids.size() && weight_so_far < target; i++) {
+        double w = std::min(centroids[i].weight, target - weight_so_far);
+        sum += w * centroids[i].mean;
+        weight_so_far += w;
+    }
+    return sum / weight_so_far;
+}
+
+#endif
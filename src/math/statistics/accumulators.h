@@ -0,0 +1,123 @@
+#ifndef __ACCUMULATORS_H
+#define __ACCUMULATORS_H
+
+#include <cstddef>
+#include <vector>
+
+// Single-pass, constant-memory summaries of a stream of samples (Monte Carlo
+// pay-offs, scenario P&L etc.). Each accumulator can be filled independently
+// on its own thread and merged afterwards.
+
+// =================
+// MomentAccumulator
+// =================
+
+// Running mean, variance, skewness and kurtosis using Welford's update,
+// extended to the third and fourth central moments (Pebay 2008). Two
+// accumulators are combined in O(1) with the pairwise formulas of Chan et al.
+class MomentAccumulator {
+private:
+    unsigned long n;  // Number of samples
+    double m1;        // Mean
+    double m2;        // Sum of squared deviations from the mean
+    double m3;        // Sum of cubed deviations from the mean
+    double m4;        // Sum of fourth power deviations from the mean
+    double min_x;
+    double max_x;
+
+public:
+    MomentAccumulator();
+
+    void add(double x);
+    void add(const double* x, size_t count);
+    void merge(const MomentAccumulator& rhs);
+    void reset();
+
+    unsigned long count() const { return n; }
+    double mean() const { return m1; }
+    double var() const;        // Unbiased sample variance
+    double stdev() const;
+    double std_error() const;  // Standard error of the mean
+    double skew() const;
+    double kurtosis() const;   // Excess kurtosis (0 for a normal distribution)
+    double min() const { return min_x; }
+    double max() const { return max_x; }
+};
+
+// ==========
+// P2Quantile
+// ==========
+
+// Jain & Chlamtac's P-squared estimator of a single quantile. Uses five
+// markers regardless of the number of samples. P-squared estimators cannot be
+// merged, so use TDigest when samples are produced on several threads.
+class P2Quantile {
+private:
+    double p;          // Target quantile in (0,1)
+    unsigned long n;   // Number of samples
+    double q[5];       // Marker heights
+    double pos[5];     // Actual marker positions
+    double desired[5]; // Desired marker positions
+    double incr[5];    // Increments of the desired positions
+
+    double parabolic(int i, double d) const;
+    double linear(int i, double d) const;
+
+public:
+    P2Quantile(double _p);
+
+    void add(double x);
+    void reset();
+
+    unsigned long count() const { return n; }
+    double quantile() const;
+};
+
+// =======
+// TDigest
+// =======
+
+// Dunning's merging t-digest. Samples are buffered and periodically folded
+// into at most ~compression centroids, sized with the arcsine scale function
+// so that the tails (where VaR/ES live) keep the finest resolution.
+class TDigest {
+private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    double compression;
+    std::vector<Centroid> centroids;  // Sorted by mean after compress()
+    std::vector<Centroid> buffer;     // Unmerged samples
+    double total_weight;
+    double min_x;
+    double max_x;
+
+    double scale_k(double q) const;
+    double scale_q(double k) const;
+
+public:
+    TDigest(double _compression = 200.0);
+
+    void add(double x, double w = 1.0);
+    void add(const double* x, size_t count);
+    void merge(const TDigest& rhs);
+    void compress();
+    void reset();
+
+    double count() const { return total_weight; }
+    size_t num_centroids() const { return centroids.size(); }
+
+    // Estimated q-th quantile, q in [0,1]
+    double quantile(double q);
+
+    // Estimated fraction of samples <= x
+    double cdf(double x);
+
+    // Mean of the samples below the q-th quantile. For a P&L distribution,
+    // -lower_tail_mean(1 - alpha) is the expected shortfall at level alpha
+    double lower_tail_mean(double q);
+};
+
+#endif
@@ -2,6 +2,8 @@
 #define __STATISTICS_CPP
 
 #include "statistics.h"
+#include "../../instrumentation/instrumentation.h"
+#include "../../simd/simd_kernels.h"
 #include <iostream>
 
 StatisticalDistribution::StatisticalDistribution() {}
@@ -23,6 +25,7 @@ double StandardNormalDistribution::cdf(const double& x) const {
                                                        k*(-1.821255978 + 1.330274429*k))));
 
     if (x >= 0.0) {
+        QF_COUNT(COUNTER_NORMAL_CDF, 1);
         return (1.0 - (1.0/(pow(2*M_PI,0.5)))*exp(-0.5*x*x) * k_sum);
     } else {
         return 1.0 - cdf(-x);
@@ -55,16 +58,18 @@ double StandardNormalDistribution::inv_cdf(const double& quantile) const {
                         0.0000003960315187};
 
     if (quantile >= 0.5 && quantile <= 0.92) {
+        QF_COUNT(COUNTER_NORMAL_INV_CDF, 1);
         double num = 0.0;
         double denom = 1.0;
 
         for (int i=0; i<4; i++) {
             num += a[i] * pow((quantile - 0.5), 2*i + 1);
-            denom += b[i] * pow((quantile - 0.5), 2*i);
+            denom += b[i] * pow((quantile - 0.5), 2*i + 2);
         }
         return num/denom;
 
     } else if (quantile > 0.92 && quantile < 1) {
+        QF_COUNT(COUNTER_NORMAL_INV_CDF, 1);
         double num = 0.0;
 
         for (int i=0; i<9; i++) {
@@ -76,7 +81,36 @@ double StandardNormalDistribution::inv_cdf(const double& quantile) const {
         return -1.0*inv_cdf(1-quantile);
     }
 }
-  
+
+// =====================
+// Batch inverse normal CDF
+// =====================
+
+// The batch kernels live in src/simd, built for each instruction set
+void StandardNormalDistribution::inv_cdf(const double* u, double* z, size_t n,
+                                         InvCdfAccuracy accuracy) const {
+    QF_COUNT(COUNTER_NORMAL_INV_CDF, n);
+    if (accuracy == INV_CDF_ACKLAM) {
+        simd_kernels().inv_cdf_acklam(u, z, n);
+    } else {
+        simd_kernels().inv_cdf_as241(u, z, n);
+    }
+}
+
+void StandardNormalDistribution::cdf(const double* x, double* p, size_t n) const {
+    QF_COUNT(COUNTER_NORMAL_CDF, n);
+    simd_kernels().normal_cdf(x, p, n);
+}
+
+void StandardNormalDistribution::cdf(const float* x, float* p, size_t n) const {
+    QF_COUNT(COUNTER_NORMAL_CDF, n);
+    simd_kernels().normal_cdf_f32(x, p, n);
+}
+
+void StandardNormalDistribution::random_draws(const double* u, double* z, size_t n) const {
+    simd_kernels().box_muller(u, z, n);
+}
+
 // Expectation/mean
 double StandardNormalDistribution::mean() const { return 0.0; }
 
@@ -107,15 +141,7 @@ void StandardNormalDistribution::random_draws(
         return;
     }
 
-    // Slow, but easy to implement
-    for (size_t i=0; i<uniform_draws.size() / 2; i++) {
-        dist_draws[2*i] = sqrt(-2.0*log(uniform_draws[2*i])) *
-            sin(2*M_PI*uniform_draws[2*i+1]);
-        dist_draws[2*i+1] = sqrt(-2.0*log(uniform_draws[2*i])) *
-            cos(2*M_PI*uniform_draws[2*i+1]);
-    }
-
-    return;
+    random_draws(uniform_draws.data(), dist_draws.data(), uniform_draws.size());
 }
 
 #endif
\ No newline at end of file
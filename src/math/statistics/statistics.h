@@ -2,8 +2,15 @@
 #define __STATISTICS_H
 
 #include <cmath>
+#include <cstddef>
 #include <vector>
 
+// Accuracy tiers for the batch inverse CDF
+enum InvCdfAccuracy {
+    INV_CDF_ACKLAM,  // Acklam's rational approximation, relative error < 1.15e-9
+    INV_CDF_AS241    // Wichura's AS241 (PPND16), relative error ~1e-16
+};
+
 class StatisticalDistribution {
 public:
     StatisticalDistribution();
@@ -37,6 +44,18 @@ public:
 
     // Inverse cumulative distribution function (aka the probit function)
     virtual double inv_cdf(const double& quantile) const;
+
+    // Batch inverse CDF, z[i] = inv_cdf(u[i]) for u[i] in (0,1). Intended for
+    // quasi-Monte Carlo path construction, where one probit is needed per
+    // dimension per path
+    void inv_cdf(const double* u, double* z, size_t n,
+                 InvCdfAccuracy accuracy = INV_CDF_AS241) const;
+
+    // Batch CDF, p[i] = cdf(x[i]) with the same approximation as N()
+    void cdf(const double* x, double* p, size_t n) const;
+
+    // In float, with up to 2e-7 of rounding on top of the approximation error
+    void cdf(const float* x, float* p, size_t n) const;
     
     // Descriptive stats
     virtual double mean() const;   // equal to 0
@@ -46,6 +65,10 @@ public:
     // Obtain a sequence of random draws from the standard normal distribution
     virtual void random_draws(const std::vector<double>& uniform_draws,
                             std::vector<double>& dist_draws);
+
+    // Box-Muller on consecutive pairs of n uniforms, n even, without the size
+    // checks of the vector version
+    void random_draws(const double* u, double* z, size_t n) const;
 };
 
 #endif
\ No newline at end of file
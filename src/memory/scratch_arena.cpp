@@ -0,0 +1,127 @@
+#ifndef __SCRATCH_ARENA_CPP
+#define __SCRATCH_ARENA_CPP
+
+#include "scratch_arena.h"
+#include <algorithm>
+#include <cstdint>
+
+static const size_t SCRATCH_BLOCK_ALIGN = alignof(std::max_align_t);
+
+// Header size rounded up, so block data starts max_align_t aligned
+static const size_t SCRATCH_HEADER_SIZE =
+    (sizeof(void*) + sizeof(size_t) + SCRATCH_BLOCK_ALIGN - 1) / SCRATCH_BLOCK_ALIGN * SCRATCH_BLOCK_ALIGN;
+
+ScratchArena::ScratchArena(size_t initial_size, std::pmr::memory_resource* _upstream)
+    : upstream(_upstream), next_size(std::max<size_t>(initial_size, 1024)), head(nullptr),
+      num_blocks(0), cursor(nullptr), limit(nullptr), used(0), peak(0) {}
+
+ScratchArena::~ScratchArena() {
+    free_blocks();
+}
+
+void ScratchArena::add_block(size_t min_size) {
+    size_t size = std::max(next_size, min_size);
+    void* raw = upstream->allocate(SCRATCH_HEADER_SIZE + size, SCRATCH_BLOCK_ALIGN);
+    Block* block = static_cast<Block*>(raw);
+    block->prev = head;
+    block->size = size;
+    head = block;
+    num_blocks++;
+    cursor = static_cast<char*>(raw) + SCRATCH_HEADER_SIZE;
+    limit = cursor + size;
+    next_size = size * 2;  // Geometric growth keeps the number of blocks small
+}
+
+void ScratchArena::free_blocks() {
+    while (head) {
+        Block* prev = head->prev;
+        upstream->deallocate(head, SCRATCH_HEADER_SIZE + head->size, SCRATCH_BLOCK_ALIGN);
+        head = prev;
+    }
+    num_blocks = 0;
+    cursor = limit = nullptr;
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment) {
+    uintptr_t p = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (!cursor || p + bytes > reinterpret_cast<uintptr_t>(limit)) {
+        // Whatever is left of the current block is abandoned until reset()
+        add_block(bytes + alignment);
+        p = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+    used += bytes;
+    cursor = reinterpret_cast<char*>(p + bytes);
+    return reinterpret_cast<void*>(p);
+}
+
+void ScratchArena::reset() {
+    peak = std::max(peak, used);
+    used = 0;
+    if (num_blocks > 1) {
+        // One block as large as all of them together, so the next cycle of
+        // the same size fits without growing
+        size_t total = capacity();
+        free_blocks();
+        next_size = total;
+        add_block(total);
+    } else if (head) {
+        cursor = reinterpret_cast<char*>(head) + SCRATCH_HEADER_SIZE;
+        limit = cursor + head->size;
+    }
+}
+
+void ScratchArena::release() {
+    peak = std::max(peak, used);
+    used = 0;
+    free_blocks();
+}
+
+size_t ScratchArena::peak_bytes_used() const {
+    return std::max(peak, used);
+}
+
+size_t ScratchArena::capacity() const {
+    size_t total = 0;
+    for (Block* b = head; b; b = b->prev) total += b->size;
+    return total;
+}
+
+// Per-thread scratch: a pool over an arena. The pool takes its chunks and
+// its own bookkeeping from the arena, so it must be released before the
+// arena is rewound
+struct ThreadScratch {
+    ScratchArena arena;
+    std::pmr::unsynchronized_pool_resource pool;
+    int depth;  // Open ScratchScopes
+
+    ThreadScratch() : arena(), pool(&arena), depth(0) {}
+};
+
+static ThreadScratch& thread_scratch() {
+    thread_local ThreadScratch scratch;
+    return scratch;
+}
+
+std::pmr::memory_resource* scratch_resource() {
+    return &thread_scratch().pool;
+}
+
+ScratchArena& scratch_arena() {
+    return thread_scratch().arena;
+}
+
+void scratch_reset() {
+    ThreadScratch& s = thread_scratch();
+    s.pool.release();
+    s.arena.reset();
+}
+
+ScratchScope::ScratchScope() {
+    thread_scratch().depth++;
+}
+
+ScratchScope::~ScratchScope() {
+    if (--thread_scratch().depth == 0) scratch_reset();
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef __SCRATCH_ARENA_H
+#define __SCRATCH_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+
+// Scratch memory for short-lived containers (chains, strike grids, paths,
+// matrices) used through std::pmr.
+//
+// ScratchArena is a monotonic (bump pointer) resource: deallocation is a
+// no-op and reset() rewinds it to empty. Unlike
+// std::pmr::monotonic_buffer_resource it keeps its memory on reset, and if
+// the last cycle needed more than one block they are merged into one, so
+// once the arena has grown to the working set of a snapshot later
+// snapshots take nothing from the heap.
+//
+// Each thread also has a pool (std::pmr::unsynchronized_pool_resource)
+// over its own arena, returned by scratch_resource(). The pool recycles
+// blocks freed within a snapshot, e.g. by vectors that grow, and needs no
+// locking because no other thread uses it.
+
+class ScratchArena : public std::pmr::memory_resource {
+private:
+    struct Block {
+        Block* prev;
+        size_t size;  // Usable bytes after the header
+    };
+
+    std::pmr::memory_resource* upstream;
+    size_t next_size;  // Size of the next block to take from upstream
+    Block* head;       // Newest block
+    size_t num_blocks;
+    char* cursor;      // Next free byte in head
+    char* limit;       // End of head
+    size_t used;       // Bytes handed out since the last reset
+    size_t peak;       // Largest used at any reset
+
+    void add_block(size_t min_size);
+    void free_blocks();
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    ScratchArena(size_t initial_size = 64 * 1024,
+                 std::pmr::memory_resource* _upstream = std::pmr::new_delete_resource());
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // Rewinds to empty, keeping the memory. Everything allocated since the
+    // last reset must already be destroyed
+    void reset();
+
+    // Returns all memory to upstream
+    void release();
+
+    size_t bytes_used() const { return used; }
+    size_t peak_bytes_used() const;
+    size_t capacity() const;
+    size_t blocks() const { return num_blocks; }
+};
+
+// The calling thread's scratch pool and the arena under it
+std::pmr::memory_resource* scratch_resource();
+ScratchArena& scratch_arena();
+
+// Releases the calling thread's pool and rewinds its arena
+void scratch_reset();
+
+// One snapshot or simulation: scratch memory is reset when the outermost
+// scope on the thread closes. Open the scope before the containers that use
+// scratch_resource(), so that they are destroyed first
+class ScratchScope {
+public:
+    ScratchScope();
+    ~ScratchScope();
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+};
+
+#endif
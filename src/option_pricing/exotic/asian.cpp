@@ -4,6 +4,7 @@
 #include <numeric> // Necessary for std::accumulate
 #include <cmath> // For log/exp functions
 #include "asian.h"
+#include "../../instrumentation/instrumentation.h"
 
 AsianOption::AsianOption(PayOff* _pay_off) : pay_off(_pay_off) {}
 
@@ -15,6 +16,8 @@ AsianOptionArithmetic::AsianOptionArithmetic(PayOff* _pay_off) : AsianOption(_pa
 
 // Arithmetic mean pay-off price
 double AsianOptionArithmetic::pay_off_price(const std::vector<double>& spot_prices) const {
+    QF_TIMED_SCOPE(TIMER_PAYOFF);
+    QF_COUNT(COUNTER_PAYOFFS, 1);
     unsigned num_times = spot_prices.size();
     double sum = std::accumulate(spot_prices.begin(), spot_prices.end(), 0.0);
     double arith_mean = sum / static_cast<double>(num_times);
@@ -29,6 +32,8 @@ AsianOptionGeometric::AsianOptionGeometric(PayOff* _pay_off) : AsianOption(_pay_
 
 // Geometric mean pay-off price
 double AsianOptionGeometric::pay_off_price(const std::vector<double>& spot_prices) const {
+    QF_TIMED_SCOPE(TIMER_PAYOFF);
+    QF_COUNT(COUNTER_PAYOFFS, 1);
     unsigned num_times = spot_prices.size();
     double log_sum = 0.0;
     for (size_t i = 0; i < spot_prices.size(); i++) {
@@ -0,0 +1,146 @@
+#ifndef __ASIAN_APPROXIMATION_CPP
+#define __ASIAN_APPROXIMATION_CPP
+
+#include "asian_approximation.h"
+#include <algorithm>
+#include <cmath>
+
+static double asian_norm_cdf(double x) {
+    return 0.5 * erfc(-x * M_SQRT1_2);
+}
+
+// (exp(x) - 1) / x, without the cancellation near x = 0
+static double exprel(double x) {
+    return x == 0.0 ? 1.0 : expm1(x) / x;
+}
+
+ArithmeticAsianApproximation::ArithmeticAsianApproximation(double _S, double _r, double _sigma, double _T,
+                                                           const std::vector<double>& fixing_times)
+    : S(_S), r(_r), sigma(_sigma), T(_T), df(exp(-_r * _T)), forward(0.0),
+      tw_forward(0.0), tw_variance(0.0), levy_variance(0.0), mu_G(0.0), sigma_G(0.0) {
+    const size_t n = fixing_times.size();
+    if (n == 0) return;
+    const double var = sigma * sigma;
+    const double inv_n = 1.0 / static_cast<double>(n);
+
+    // Levy: E[A] and E[A^2] of the discrete average, per unit spot.
+    // E[S(t_i) S(t_j)] = exp(r (t_i + t_j) + sigma^2 min(t_i, t_j)), and with
+    // the times ascending the sum over j > i is a running suffix sum
+    double m1 = 0.0, m2 = 0.0, suffix = 0.0;
+    for (size_t k = n; k-- > 0;) {
+        double t = fixing_times[k];
+        double growth = exp(r * t);
+        double var_growth = exp(var * t);
+        m1 += growth;
+        m2 += growth * var_growth * (growth + 2.0 * suffix);
+        suffix += growth;
+    }
+    m1 *= inv_n;
+    m2 *= inv_n * inv_n;
+    forward = S * m1;
+    levy_variance = std::max(log(m2 / (m1 * m1)), 0.0);
+
+    // Turnbull-Wakeman: the same for the continuous average over [t_0, t_n-1]
+    double t_0 = fixing_times[0];
+    double tau = fixing_times[n - 1] - t_0;
+    if (tau > 0.0) {
+        double c1 = exp(r * t_0) * exprel(r * tau);
+        double c2 = 2.0 * exp((2.0 * r + var) * t_0) / (tau * (r + var))
+                  * (exprel((2.0 * r + var) * tau) - exprel(r * tau));
+        tw_forward = S * c1;
+        tw_variance = std::max(log(c2 / (c1 * c1)), 0.0);
+    } else {
+        tw_forward = S * exp(r * t_0);
+        tw_variance = var * t_0;
+    }
+
+    // Curran: log S(t_i) ~ N(mu_i, sigma^2 t_i) with mu_i = log S + (r - sigma^2/2) t_i.
+    // Sum over j of min(t_i, t_j) = (t_0 + ... + t_i-1) + (n - i) t_i
+    std::vector<double> cov(n);
+    double prefix = 0.0, sum_min = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double t = fixing_times[i];
+        mu_G += (r - 0.5 * var) * t;
+        cov[i] = var * inv_n * (prefix + (n - i) * t);
+        sum_min += (2.0 * (n - 1 - i) + 1.0) * t;
+        prefix += t;
+    }
+    mu_G = log(S) + mu_G * inv_n;
+    sigma_G = sqrt(var * sum_min) * inv_n;
+    if (sigma_G <= 0.0) return;
+
+    fixing_forward.resize(n);
+    curran_a.resize(n);
+    curran_b.resize(n);
+    curran_c.resize(n);
+    double var_G = sigma_G * sigma_G;
+    double log_S = log(S);
+    for (size_t i = 0; i < n; i++) {
+        double t = fixing_times[i];
+        double mu_i = log_S + (r - 0.5 * var) * t;
+        fixing_forward[i] = S * exp(r * t) * inv_n;
+        curran_a[i] = exp(mu_i + 0.5 * (var * t - cov[i] * cov[i] / var_G)) * inv_n;
+        curran_b[i] = cov[i] / var_G;
+        curran_c[i] = cov[i] / sigma_G;
+    }
+}
+
+std::vector<double> ArithmeticAsianApproximation::path_fixing_times(double T, size_t n) {
+    std::vector<double> times(n);
+    for (size_t i = 0; i < n; i++) times[i] = T * i / static_cast<double>(n);
+    return times;
+}
+
+// Black's formula on a forward F of A with the given total variance
+double ArithmeticAsianApproximation::lognormal_call(double K, double F, double variance) const {
+    if (variance <= 0.0) return df * std::max(F - K, 0.0);
+    double sd = sqrt(variance);
+    double d_1 = (log(F / K) + 0.5 * variance) / sd;
+    return df * (F * asian_norm_cdf(d_1) - K * asian_norm_cdf(d_1 - sd));
+}
+
+// Exact where G > K (then A > K too), lognormal approximation of the
+// remainder through the conditional mean of A given G. K_hat is the level of
+// G at which that conditional mean reaches K
+double ArithmeticAsianApproximation::curran_call(double K) const {
+    if (sigma_G <= 0.0) return lognormal_call(K, forward, 0.0);
+    const size_t n = curran_a.size();
+    double x = log(K) - mu_G;
+    double conditional = 0.0;
+    for (size_t i = 0; i < n; i++) conditional += curran_a[i] * exp(curran_b[i] * x);
+    double K_hat = 2.0 * K - conditional;
+    if (K_hat <= 0.0) return df * (forward - K);  // The average ends above K
+
+    double d = (mu_G - log(K_hat)) / sigma_G;
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) sum += fixing_forward[i] * asian_norm_cdf(d + curran_c[i]);
+    return df * (sum - K * asian_norm_cdf(d));
+}
+
+double ArithmeticAsianApproximation::price(AsianApproximation method, bool is_call, double K) const {
+    double F = method == ASIAN_TURNBULL_WAKEMAN ? tw_forward : forward;
+    double call;
+    switch (method) {
+        case ASIAN_TURNBULL_WAKEMAN: call = lognormal_call(K, tw_forward, tw_variance); break;
+        case ASIAN_LEVY: call = lognormal_call(K, forward, levy_variance); break;
+        default: call = curran_call(K); break;
+    }
+    // Put-call parity on the average
+    return is_call ? call : call - df * (F - K);
+}
+
+void ArithmeticAsianApproximation::prices(AsianApproximation method, const double* phi, const double* K,
+                                          double* price, size_t n) const {
+    for (size_t i = 0; i < n; i++) price[i] = this->price(method, phi[i] > 0.0, K[i]);
+}
+
+const char* asian_approximation_name(AsianApproximation method) {
+    switch (method) {
+        case ASIAN_TURNBULL_WAKEMAN: return "Turnbull-Wakeman";
+        case ASIAN_LEVY: return "Levy";
+        case ASIAN_CURRAN: return "Curran";
+        default: return "unknown";
+    }
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef __ASIAN_APPROXIMATION_H
+#define __ASIAN_APPROXIMATION_H
+
+#include <cstddef>
+#include <vector>
+
+// Analytic approximations to discretely monitored arithmetic Asian options,
+// paying max(phi (A - K), 0) at T on A, the mean of the spot at the fixing
+// times, under Black-Scholes dynamics. For indicative quotes and as a check
+// on the Monte Carlo pricers (AsianOptionArithmetic, ArithmeticAsianOption)
+enum AsianApproximation {
+    // Lognormal A matched to the first two moments of the continuous average
+    // over [first fixing, last fixing]
+    ASIAN_TURNBULL_WAKEMAN,
+    // Lognormal A matched to the exact moments of the discrete average
+    ASIAN_LEVY,
+    // Conditioning on the geometric average of the same fixings (Curran)
+    ASIAN_CURRAN
+};
+
+// Everything that does not depend on the strike is computed once in the
+// constructor, in O(number of fixings), so pricing a strike is cheap:
+// O(1) for the moment-matching methods and O(number of fixings) for Curran
+class ArithmeticAsianApproximation {
+private:
+    double S, r, sigma, T;
+    double df;            // exp(-r T), the pay-off is paid at T
+    double forward;       // E[A]
+    double tw_forward;    // E[A] for the continuous average
+    double tw_variance;   // Lognormal total variance of A, continuous moments
+    double levy_variance; // Lognormal total variance of A, discrete moments
+
+    // Curran: log S(t_i) and log G, G the geometric average, are jointly
+    // normal. With c_i = Cov(log S(t_i), log G)
+    double mu_G, sigma_G;                // Mean and standard deviation of log G
+    std::vector<double> fixing_forward;  // E[S(t_i)] / n
+    std::vector<double> curran_a;        // E[S(t_i) | log G = mu_G] / n
+    std::vector<double> curran_b;        // c_i / sigma_G^2
+    std::vector<double> curran_c;        // c_i / sigma_G
+
+    double lognormal_call(double K, double F, double variance) const;
+    double curran_call(double K) const;
+
+public:
+    // fixing_times ascending, in years from today, each within [0, T]
+    ArithmeticAsianApproximation(double _S, double _r, double _sigma, double _T,
+                                 const std::vector<double>& fixing_times);
+
+    // The fixings of calc_path_spot_prices: n prices at t_i = i T / n
+    static std::vector<double> path_fixing_times(double T, size_t n);
+
+    double price(AsianApproximation method, bool is_call, double K) const;
+
+    // Prices across strikes: price[i] for strike K[i], phi[i] is +1 for a
+    // call and -1 for a put
+    void prices(AsianApproximation method, const double* phi, const double* K,
+                double* price, size_t n) const;
+
+    double average_forward() const { return forward; }
+};
+
+const char* asian_approximation_name(AsianApproximation method);
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef __DIGITAL_CPP
+#define __DIGITAL_CPP
+
+#include "digital.h"
+#include "../../instrumentation/instrumentation.h"
+#include <cmath>
+
+static inline double digital_norm_cdf(double x) {
+    return 0.5 * erfc(-x * M_SQRT1_2);
+}
+
+static inline double digital_norm_pdf(double x) {
+    return exp(-0.5 * x * x) / sqrt(2.0 * M_PI);
+}
+
+// Cash-or-nothing with phi = +1 for a call, -1 for a put. Only the four
+// batch Greeks are computed when theta_rho is false
+static inline void cash_or_nothing(double phi, double S, double K, double r, double T, double sigma,
+                                   BlackScholesGreeks& g, bool theta_rho) {
+    double sqrt_T = sqrt(T);
+    double sigma_sqrt_T = sigma * sqrt_T;
+    double d_1 = (log(S/K) + (r + sigma * sigma * 0.5) * T) / sigma_sqrt_T;
+    double d_2 = d_1 - sigma_sqrt_T;
+    double df = exp(-r * T);
+    double df_pdf = phi * df * digital_norm_pdf(d_2);
+
+    g.price = df * digital_norm_cdf(phi * d_2);
+    g.delta = df_pdf / (S * sigma_sqrt_T);
+    g.gamma = -df_pdf * d_1 / (S * S * sigma * sigma * T);
+    g.vega = -df_pdf * d_1 / sigma;
+    if (theta_rho) {
+        g.theta = r * g.price - df_pdf * (r / sigma_sqrt_T - d_1 / (2.0 * T));
+        g.rho = -T * g.price + df_pdf * sqrt_T / sigma;
+    }
+}
+
+static inline void asset_or_nothing(double phi, double S, double K, double r, double T, double sigma,
+                                    BlackScholesGreeks& g, bool theta_rho) {
+    double sqrt_T = sqrt(T);
+    double sigma_sqrt_T = sigma * sqrt_T;
+    double d_1 = (log(S/K) + (r + sigma * sigma * 0.5) * T) / sigma_sqrt_T;
+    double d_2 = d_1 - sigma_sqrt_T;
+    double pdf = phi * digital_norm_pdf(d_1);
+
+    g.price = S * digital_norm_cdf(phi * d_1);
+    g.delta = digital_norm_cdf(phi * d_1) + pdf / sigma_sqrt_T;
+    g.gamma = -pdf * d_2 / (S * sigma * sigma * T);
+    g.vega = -S * pdf * d_2 / sigma;
+    if (theta_rho) {
+        g.theta = -S * pdf * ((r + sigma * sigma * 0.5) / sigma_sqrt_T - d_1 / (2.0 * T));
+        g.rho = S * pdf * sqrt_T / sigma;
+    }
+}
+
+BlackScholesGreeks calc_cash_or_nothing_greeks(bool is_call, double S, double K,
+                                               double r, double T, double sigma) {
+    BlackScholesGreeks g;
+    cash_or_nothing(is_call ? 1.0 : -1.0, S, K, r, T, sigma, g, true);
+    return g;
+}
+
+BlackScholesGreeks calc_asset_or_nothing_greeks(bool is_call, double S, double K,
+                                                double r, double T, double sigma) {
+    BlackScholesGreeks g;
+    asset_or_nothing(is_call ? 1.0 : -1.0, S, K, r, T, sigma, g, true);
+    return g;
+}
+
+BlackScholesGreeks calc_double_digital_greeks(double S, double D, double U,
+                                              double r, double T, double sigma) {
+    BlackScholesGreeks lower = calc_cash_or_nothing_greeks(true, S, D, r, T, sigma);
+    BlackScholesGreeks upper = calc_cash_or_nothing_greeks(true, S, U, r, T, sigma);
+    BlackScholesGreeks g;
+    g.price = lower.price - upper.price;
+    g.delta = lower.delta - upper.delta;
+    g.gamma = lower.gamma - upper.gamma;
+    g.vega = lower.vega - upper.vega;
+    g.theta = lower.theta - upper.theta;
+    g.rho = lower.rho - upper.rho;
+    return g;
+}
+
+void calc_cash_or_nothing_greeks(const double* phi, const double* S, const double* K,
+                                 const double* r, const double* T, const double* sigma,
+                                 double* price, double* delta, double* gamma, double* vega, size_t n) {
+    QF_COUNT(COUNTER_BLACK_SCHOLES_PRICES, n);
+    for (size_t i=0; i<n; i++) {
+        BlackScholesGreeks g;
+        cash_or_nothing(phi[i], S[i], K[i], r[i], T[i], sigma[i], g, false);
+        price[i] = g.price;
+        delta[i] = g.delta;
+        gamma[i] = g.gamma;
+        vega[i] = g.vega;
+    }
+}
+
+void calc_asset_or_nothing_greeks(const double* phi, const double* S, const double* K,
+                                  const double* r, const double* T, const double* sigma,
+                                  double* price, double* delta, double* gamma, double* vega, size_t n) {
+    QF_COUNT(COUNTER_BLACK_SCHOLES_PRICES, n);
+    for (size_t i=0; i<n; i++) {
+        BlackScholesGreeks g;
+        asset_or_nothing(phi[i], S[i], K[i], r[i], T[i], sigma[i], g, false);
+        price[i] = g.price;
+        delta[i] = g.delta;
+        gamma[i] = g.gamma;
+        vega[i] = g.vega;
+    }
+}
+
+// Both legs share S, r, T and sigma, so sqrt(T) and the discount factor are
+// computed once per option rather than once per leg
+void calc_double_digital_greeks(const double* S, const double* D, const double* U,
+                                const double* r, const double* T, const double* sigma,
+                                double* price, double* delta, double* gamma, double* vega, size_t n) {
+    QF_COUNT(COUNTER_BLACK_SCHOLES_PRICES, n);
+    for (size_t i=0; i<n; i++) {
+        double sqrt_T = sqrt(T[i]);
+        double sigma_sqrt_T = sigma[i] * sqrt_T;
+        double drift = (r[i] + sigma[i] * sigma[i] * 0.5) * T[i];
+        double d_1_D = (log(S[i]/D[i]) + drift) / sigma_sqrt_T;
+        double d_1_U = (log(S[i]/U[i]) + drift) / sigma_sqrt_T;
+        double d_2_D = d_1_D - sigma_sqrt_T;
+        double d_2_U = d_1_U - sigma_sqrt_T;
+        double df = exp(-r[i] * T[i]);
+        double pdf_D = df * digital_norm_pdf(d_2_D);
+        double pdf_U = df * digital_norm_pdf(d_2_U);
+
+        // N(d2_D) - N(d2_U) = N(-d2_U) - N(-d2_D), the latter keeps precision
+        // when both strikes are far below spot
+        price[i] = df * (digital_norm_cdf(-d_2_U) - digital_norm_cdf(-d_2_D));
+        delta[i] = (pdf_D - pdf_U) / (S[i] * sigma_sqrt_T);
+        gamma[i] = -(pdf_D * d_1_D - pdf_U * d_1_U) / (S[i] * S[i] * sigma[i] * sigma[i] * T[i]);
+        vega[i] = -(pdf_D * d_1_D - pdf_U * d_1_U) / sigma[i];
+    }
+}
+
+#endif
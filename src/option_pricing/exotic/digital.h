@@ -0,0 +1,40 @@
+#ifndef __DIGITAL_H
+#define __DIGITAL_H
+
+#include <cstddef>
+#include "../vanilla/black_scholes.h"
+
+// Closed-form Black-Scholes prices and Greeks of digital options, per unit
+// of cash (cash-or-nothing) or per unit of the underlying (asset-or-nothing):
+//   cash-or-nothing call  exp(-rT) N(d2),   put  exp(-rT) N(-d2)
+//   asset-or-nothing call S N(d1),          put  S N(-d1)
+//   double digital [D, U] cash-or-nothing call(D) - cash-or-nothing call(U)
+// which is what PayoffDoubleDigital pays. Vega and rho are per unit change,
+// theta is per year, as for calc_black_scholes_greeks. N is evaluated through
+// erfc, as a digital's price is a probability and needs it to full precision.
+
+BlackScholesGreeks calc_cash_or_nothing_greeks(bool is_call, double S, double K,
+                                               double r, double T, double sigma);
+
+BlackScholesGreeks calc_asset_or_nothing_greeks(bool is_call, double S, double K,
+                                                double r, double T, double sigma);
+
+BlackScholesGreeks calc_double_digital_greeks(double S, double D, double U,
+                                              double r, double T, double sigma);
+
+// Batch forms on arrays (structure of arrays), for marking a whole book.
+// phi[i] is +1 for a call and -1 for a put. Every output is an array of n
+// values and must not be null
+void calc_cash_or_nothing_greeks(const double* phi, const double* S, const double* K,
+                                 const double* r, const double* T, const double* sigma,
+                                 double* price, double* delta, double* gamma, double* vega, size_t n);
+
+void calc_asset_or_nothing_greeks(const double* phi, const double* S, const double* K,
+                                  const double* r, const double* T, const double* sigma,
+                                  double* price, double* delta, double* gamma, double* vega, size_t n);
+
+void calc_double_digital_greeks(const double* S, const double* D, const double* U,
+                                const double* r, const double* T, const double* sigma,
+                                double* price, double* delta, double* gamma, double* vega, size_t n);
+
+#endif
@@ -11,11 +11,10 @@ PayoffDoubleDigital::PayoffDoubleDigital(const double _U,const double _D){
 PayoffDoubleDigital::~PayoffDoubleDigital(){}
 
 double PayoffDoubleDigital::operator()(const double S)const{
-    if(S>=D && S<=U){
-        return 1.0;
-    }else {
-        return 0.0;
-    }
-    
+    return value(S);
+}
+
+void PayoffDoubleDigital::evaluate(const double* S, double* out, size_t n) const{
+    for(size_t i=0; i<n; i++) out[i] = value(S[i]);
 }
 #endif
\ No newline at end of file
@@ -12,6 +12,9 @@ public:
     PayoffDoubleDigital(const double _U, const double _D);
     virtual ~PayoffDoubleDigital();
     virtual double operator() (const double S)const; //Payoff is 1 if spot within strike barriers , 0 otherwise
+    virtual void evaluate(const double* S, double* out, size_t n) const;
+
+    double value(const double S) const { return (S>=D && S<=U) ? 1.0 : 0.0; }
 
 };
 
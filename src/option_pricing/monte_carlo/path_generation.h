@@ -4,6 +4,8 @@
 #include <vector>
 #include <cmath>
 #include <cstdlib>
+#include "../../instrumentation/instrumentation.h"
+#include "../../simd/simd_kernels.h"
 
 // For random Gaussian generation using Box-Muller method
 double gaussian_box_muller() {
@@ -21,11 +23,17 @@ double gaussian_box_muller() {
 }
 
 // This provides a vector containing sampled points of a
-// Geometric Brownian Motion stock price path
-void calc_path_spot_prices(std::vector<double>& spot_prices, // Vector of spot prices to be filled in
+// Geometric Brownian Motion stock price path. Any allocator, e.g. a
+// std::pmr::vector on scratch_resource()
+template<typename Alloc>
+void calc_path_spot_prices(std::vector<double, Alloc>& spot_prices, // Vector of spot prices to be filled in
                            const double& r,   // Risk free interest rate (constant)
                            const double& v,   // Volatility of underlying (constant)
                            const double& T) { // Expiry
+    QF_TIMED_SCOPE(TIMER_PATH_GENERATION);
+    QF_COUNT(COUNTER_PATHS, 1);
+    QF_COUNT(COUNTER_PATH_STEPS, spot_prices.size() - 1);
+
     // Since the drift and volatility of the asset are constant
     // we will precalculate as much as possible for maximum efficiency
     double dt = T / static_cast<double>(spot_prices.size());
@@ -38,4 +46,25 @@ void calc_path_spot_prices(std::vector<double>& spot_prices, // Vector of spot p
     }
 }
 
+// Advances n independent paths by one step of length dt in lockstep, given
+// one standard normal draw per path. Vectorises across paths, unlike the
+// per-path recursion above
+inline void calc_gbm_step(double* spot_prices, const double* gauss, size_t n,
+                          double r, double v, double dt) {
+    QF_COUNT(COUNTER_PATH_STEPS, n);
+    double drift = exp(dt * (r - 0.5 * v * v));
+    double vol = sqrt(v * v * dt);
+    simd_kernels().gbm_step(spot_prices, gauss, spot_prices, n, drift, vol);
+}
+
+// In float, for twice the paths per SIMD register. Drift and vol are
+// computed in double and rounded once
+inline void calc_gbm_step(float* spot_prices, const float* gauss, size_t n,
+                          double r, double v, double dt) {
+    QF_COUNT(COUNTER_PATH_STEPS, n);
+    float drift = static_cast<float>(exp(dt * (r - 0.5 * v * v)));
+    float vol = static_cast<float>(sqrt(v * v * dt));
+    simd_kernels().gbm_step_f32(spot_prices, gauss, spot_prices, n, drift, vol);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef __BLACK_SCHOLES_H
+#define __BLACK_SCHOLES_H
+
+#include <cstddef>
+
+// Closed-form Black-Scholes price and sensitivities of a European option.
+// Vega and rho are per unit change (not per 1%), theta is per year.
+struct BlackScholesGreeks {
+    double price;
+    double delta;
+    double gamma;
+    double vega;
+    double theta;
+    double rho;
+};
+
+BlackScholesGreeks calc_black_scholes_greeks(bool is_call, double S, double K,
+                                             double r, double T, double sigma);
+
+// As above, with the discount factor exp(-r*T) supplied by the caller, e.g.
+// from OptionChain::discount_factor()
+BlackScholesGreeks calc_black_scholes_greeks(bool is_call, double S, double K,
+                                             double r, double T, double sigma, double df);
+
+// Prices of n European options held as arrays (structure of arrays). phi[i]
+// is +1 for a call and -1 for a put. Runs the SIMD variant chosen for this
+// CPU (src/simd) and agrees with VanillaOption to a few ulps
+void calc_black_scholes_prices(const double* phi, const double* S, const double* K,
+                               const double* r, const double* T, const double* sigma,
+                               double* price, size_t n);
+
+// Single precision, twice as many options per SIMD register. The error is a
+// few float ulps of S + K*exp(-r*T) at any expiry and volatility, as an error
+// in d1 moves the two terms of the price by the same amount
+void calc_black_scholes_prices(const float* phi, const float* S, const float* K,
+                               const float* r, const float* T, const float* sigma,
+                               float* price, size_t n);
+
+// Mixed precision: every option is priced in float, and those whose float
+// error bound exceeds max(abs_tolerance, rel_tolerance * price) are priced
+// again in double, as are any outside the range of float. Each price is then
+// within that tolerance of the double one. Returns the number priced again
+size_t calc_black_scholes_prices_mixed(const double* phi, const double* S, const double* K,
+                                       const double* r, const double* T, const double* sigma,
+                                       double* price, size_t n,
+                                       double abs_tolerance, double rel_tolerance = 0.0);
+
+// Bound on the error of the float price of one option, from measured errors
+// over a wide range of contracts with a margin of over 3
+double black_scholes_float_error_bound(double S, double K, double r, double T);
+
+// Function object exposing price and vega as functions of volatility, for use
+// with the root finders in src/implied_volatility
+class BlackScholesPricer {
+private:
+    bool is_call;
+    double K, r, T, S;
+    double df_K; // K * exp(-r*T), fixed for the whole solve
+
+public:
+    BlackScholesPricer(bool _is_call, double _K, double _r, double _T, double _S);
+
+    double price(double sigma) const;
+    double vega(double sigma) const;
+
+    // No-arbitrage bounds on the option price
+    double lower_bound() const;
+    double upper_bound() const;
+};
+
+// Implied volatility by safeguarded Newton-Raphson, starting from init.
+// Returns NaN if the price lies outside the no-arbitrage bounds
+double calc_implied_vol(bool is_call, double price, double S, double K,
+                        double r, double T, double init = 0.2,
+                        double epsilon = 1e-8, int* iterations = nullptr);
+
+// Implied volatilities of n options held as arrays, phi[i] = +1 for a call
+// and -1 for a put. Newton steps are taken for a block of options at once
+// with calc_black_scholes_prices; an option that has not converged after a
+// few lockstep steps finishes on calc_implied_vol. NaN where the price lies
+// outside the no-arbitrage bounds
+void calc_implied_vols(const double* phi, const double* price, const double* S, const double* K,
+                       const double* r, const double* T, double* sigma, size_t n,
+                       double epsilon = 1e-8);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef __LAZY_OPTION_CPP
+#define __LAZY_OPTION_CPP
+
+#include "lazy_option.h"
+
+LazyVanillaOption::LazyVanillaOption(bool _is_call, double _K, double _T,
+                                     Quote& _spot, Quote& _rate, Quote& _vol)
+    : is_call(_is_call), K(_K), T(_T), spot(_spot), rate(_rate), vol(_vol), results() {
+    spot.register_observer(this);
+    rate.register_observer(this);
+    vol.register_observer(this);
+}
+
+LazyVanillaOption::~LazyVanillaOption() {
+    spot.unregister_observer(this);
+    rate.unregister_observer(this);
+    vol.unregister_observer(this);
+}
+
+void LazyVanillaOption::perform_calculations() const {
+    results = calc_black_scholes_greeks(is_call, spot.value(), K, rate.value(), T, vol.value());
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef __LAZY_OPTION_H
+#define __LAZY_OPTION_H
+
+#include "black_scholes.h"
+#include "../../market_data/quote.h"
+
+// Base for results that depend on observable inputs. A notification only
+// marks the object dirty; calculate() runs on the next read. Dirtiness is
+// passed on to our own observers only when we held a valid result, so a
+// burst of ticks between two reads notifies downstream objects once.
+class LazyInstrument : public Observer, public Observable {
+private:
+    mutable bool calculated;
+    mutable unsigned long calculations;
+
+protected:
+    virtual void perform_calculations() const = 0;
+
+    void calculate() const {
+        if (!calculated) {
+            perform_calculations();
+            calculated = true;
+            calculations++;
+        }
+    }
+
+public:
+    LazyInstrument() : calculated(false), calculations(0) {}
+
+    void update() override {
+        if (calculated) {
+            calculated = false;
+            notify_observers();
+        }
+    }
+
+    bool is_calculated() const { return calculated; }
+    unsigned long num_calculations() const { return calculations; }
+};
+
+// European option priced with Black-Scholes off three quotes: the spot of
+// its underlying, the zero rate to its expiry and the vol node it sits on.
+// A quote change costs one flag write here; price and Greeks are
+// recomputed the first time one of them is read afterwards. The quotes
+// must outlive the option.
+class LazyVanillaOption : public LazyInstrument {
+private:
+    bool is_call;
+    double K;
+    double T;
+    Quote& spot;
+    Quote& rate;
+    Quote& vol;
+    mutable BlackScholesGreeks results;
+
+    void perform_calculations() const override;
+
+public:
+    LazyVanillaOption(bool _is_call, double _K, double _T,
+                      Quote& _spot, Quote& _rate, Quote& _vol);
+    ~LazyVanillaOption() override;
+
+    bool call() const { return is_call; }
+    double strike() const { return K; }
+    double expiry() const { return T; }
+
+    double price() const { calculate(); return results.price; }
+    double delta() const { calculate(); return results.delta; }
+    double gamma() const { calculate(); return results.gamma; }
+    double vega() const { calculate(); return results.vega; }
+    double theta() const { calculate(); return results.theta; }
+    double rho() const { calculate(); return results.rho; }
+    const BlackScholesGreeks& greeks() const { calculate(); return results; }
+};
+
+#endif
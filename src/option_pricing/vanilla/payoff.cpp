@@ -5,6 +5,10 @@
 
 PayOff::PayOff() {}
 
+void PayOff::evaluate(const double* S, double* out, size_t n) const {
+  for (size_t i=0; i<n; i++) out[i] = (*this)(S[i]);
+}
+
 // ==========
 // PayOffCall
 // ==========
@@ -14,7 +18,11 @@ PayOffCall::PayOffCall(const double _K) { K = _K; }
 
 // Over-ridden operator() method, which turns PayOffCall into a function object
 double PayOffCall::operator() (const double S) const {
-  return std::max(S-K, 0.0); // Standard European call pay-off
+  return value(S); // Standard European call pay-off
+}
+
+void PayOffCall::evaluate(const double* S, double* out, size_t n) const {
+  for (size_t i=0; i<n; i++) out[i] = value(S[i]);
 }
 
 // =========
@@ -28,7 +36,11 @@ PayOffPut::PayOffPut(const double _K) {
 
 // Over-ridden operator() method, which turns PayOffPut into a function object
 double PayOffPut::operator() (const double S) const {
-  return std::max(K-S, 0.0); // Standard European put pay-off
+  return value(S); // Standard European put pay-off
+}
+
+void PayOffPut::evaluate(const double* S, double* out, size_t n) const {
+  for (size_t i=0; i<n; i++) out[i] = value(S[i]);
 }
 
 #endif
@@ -2,6 +2,7 @@
 #define __PAY_OFF_H
 
 #include<algorithm>
+#include<cstddef>
 
 class PayOff{
 public:
@@ -9,8 +10,16 @@ public:
     virtual ~PayOff(){}; // Virtual destructor
 
     virtual double operator() (const double S)const = 0;//Pure virtual method
+
+    // Batch form, out[i] = (*this)(S[i]), with one virtual call per batch
+    // rather than per value. The default loops over operator()
+    virtual void evaluate(const double* S, double* out, size_t n) const;
 };
 
+// Each concrete pay-off also has a non-virtual inline value(), which
+// operator(), evaluate() and templated code such as AsianOptionPolicy call
+// directly so the compiler can inline and vectorise it
+
 class PayOffCall : public PayOff {
     private:
         double K; // strike price
@@ -19,7 +28,9 @@ class PayOffCall : public PayOff {
         PayOffCall(const double K_); // not used {} since that will give us redefinition error
         virtual ~PayOffCall() {}; // Destructor virtual for further inheritance
         virtual double operator() (const double S) const ;
+        virtual void evaluate(const double* S, double* out, size_t n) const;
 
+        double value(const double S) const { return std::max(S-K, 0.0); }
 };
 
 class PayOffPut : public PayOff {
@@ -30,7 +41,9 @@ class PayOffPut : public PayOff {
         PayOffPut(const double K_);
         virtual ~PayOffPut(){}; // Destructor virtual for further inheritance
         virtual double operator() (const double S)const ;
+        virtual void evaluate(const double* S, double* out, size_t n) const;
 
+        double value(const double S) const { return std::max(K-S, 0.0); }
 };
 
-#endif
\ No newline at end of file
+#endif
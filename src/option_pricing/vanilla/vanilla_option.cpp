@@ -2,6 +2,7 @@
 #define __VANILLA_OPTION_CPP
 
 #include "vanilla_option.h"
+#include "../../instrumentation/instrumentation.h"
 #include <cmath>
 
 double N(const double x) {
@@ -9,6 +10,7 @@ double N(const double x) {
     double k_sum = k*(0.319381530 + k*(-0.356563782 + k*(1.781477937 + k*(-1.821255978 + 1.330274429*k))));
 
     if (x >= 0.0) {
+        QF_COUNT(COUNTER_NORMAL_CDF, 1); // Negative x is counted once, on the way back in
         return (1.0 - (1.0/(pow(2*M_PI,0.5)))*exp(-0.5*x*x) * k_sum);
     } else {
         return 1.0 - N(-x);
@@ -21,6 +23,7 @@ void VanillaOption::init() {
     T = 1.0; // One year until maturity
     S = 100.0; // Option is at the money as spot equals the strike
     sigma = 0.2; // Volatility is 20%
+    df = exp(-r*T);
 }
 
 void VanillaOption::copy(const VanillaOption& rhs) {
@@ -29,6 +32,7 @@ void VanillaOption::copy(const VanillaOption& rhs) {
     T = rhs.getT();
     S = rhs.getS();
     sigma = rhs.getsigma();
+    df = rhs.df;
 }
 
 VanillaOption::VanillaOption() { init(); }
@@ -41,6 +45,7 @@ VanillaOption::VanillaOption(const double& _K, const double& _r,
     T = _T;
     S = _S;
     sigma = _sigma;
+    df = exp(-r*T);
 }
 
 VanillaOption::VanillaOption(const VanillaOption& rhs) {
@@ -67,14 +72,14 @@ double VanillaOption::calc_call_price() const {
     double sigma_sqrt_T = sigma * sqrt(T);
     double d_1 = ( log(S/K) + (r + sigma * sigma * 0.5 ) * T ) / sigma_sqrt_T;
     double d_2 = d_1 - sigma_sqrt_T;
-    return S * N(d_1) - K * exp(-r*T) * N(d_2);
+    return S * N(d_1) - K * df * N(d_2);
 }
 
 double VanillaOption::calc_put_price() const {
     double sigma_sqrt_T = sigma * sqrt(T);
     double d_1 = ( log(S/K) + (r + sigma * sigma * 0.5 ) * T ) / sigma_sqrt_T;
     double d_2 = d_1 - sigma_sqrt_T;
-    return K * exp(-r*T) * N(-d_2) - S * N(-d_1);
+    return K * df * N(-d_2) - S * N(-d_1);
 }
 
 #endif
\ No newline at end of file
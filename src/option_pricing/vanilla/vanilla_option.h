@@ -1,6 +1,9 @@
 #ifndef __VANILLA_OPTION_H
 #define __VANILLA_OPTION_H
 
+// Cumulative standard normal distribution (Abramowitz & Stegun approximation)
+double N(const double x);
+
 class VanillaOption {
 private:
     void init();
@@ -11,6 +14,7 @@ private:
     double T; // Maturity time
     double S; // Underlying asset price
     double sigma; // Volatility of underlying asset
+    double df; // Discount factor exp(-r*T), cached so pricing calls skip the exp
 
 public:
     VanillaOption(); // Default constructor - has no parameters
@@ -0,0 +1,179 @@
+#ifndef __SNAPSHOT_PIPELINE_CPP
+#define __SNAPSHOT_PIPELINE_CPP
+
+#include "snapshot_pipeline.h"
+#include "../option_pricing/vanilla/black_scholes.h"
+#include <algorithm>
+#include <cmath>
+
+const char* pipeline_stage_name(PipelineStage stage) {
+    switch (stage) {
+        case PIPELINE_PARSE: return "parse";
+        case PIPELINE_IV: return "iv";
+        case PIPELINE_FIT: return "fit";
+        case PIPELINE_RISK: return "risk";
+        case PIPELINE_SURFACE: return "surface";
+        case PIPELINE_BOOK: return "book";
+        default: return "unknown";
+    }
+}
+
+SnapshotPipeline::SnapshotPipeline(const SviFitOptions& _fit_options)
+    : fit_options(_fit_options), book() {}
+
+bool SnapshotPipeline::run(const MarketData& market, const PositionSet& positions, unsigned num_threads) {
+    graph.clear();
+    for (int s = 0; s < PIPELINE_NUM_STAGES; s++) stage_tasks[s].clear();
+    expiries.clear();
+    expiries.resize(market.option_chains.size());
+
+    // Expiries in date order, and each position assigned to the one nearest
+    // its time to expiry
+    std::vector<double> expiry_T;
+    size_t e = 0;
+    for (const auto& chain : market.option_chains) {
+        expiries[e++].expiry_date = chain.first;
+        expiry_T.push_back(chain.second.empty() ? 0.0 : chain.second[0].days_to_expiry / 365.0);
+    }
+    if (!expiry_T.empty()) {
+        ArrayView<double> T = positions.expiry_column();
+        for (size_t i = 0; i < positions.size(); i++) {
+            size_t nearest = 0;
+            for (size_t k = 1; k < expiry_T.size(); k++) {
+                if (fabs(expiry_T[k] - T[i]) < fabs(expiry_T[nearest] - T[i])) nearest = k;
+            }
+            expiries[nearest].positions.push_back(i);
+        }
+    }
+
+    auto add = [&](PipelineStage stage, const std::string& name, std::function<void()> fn) {
+        size_t task = graph.add_task(name, std::move(fn));
+        stage_tasks[stage].push_back(task);
+        return task;
+    };
+    for (e = 0; e < expiries.size(); e++) {
+        const std::string& date = expiries[e].expiry_date;
+        size_t parse_task = add(PIPELINE_PARSE, "parse " + date, [this, &market, e]() { parse(market, e); });
+        size_t iv_task = add(PIPELINE_IV, "iv " + date, [this, e]() { invert(e); });
+        size_t fit_task = add(PIPELINE_FIT, "fit " + date, [this, e]() { fit(e); });
+        size_t risk_task = add(PIPELINE_RISK, "risk " + date, [this, &positions, e]() { value(positions, e); });
+        graph.add_dependency(parse_task, iv_task);
+        graph.add_dependency(iv_task, fit_task);
+        graph.add_dependency(fit_task, risk_task);
+    }
+    size_t surface_task = add(PIPELINE_SURFACE, "surface", [this, &market]() { build_surface(market); });
+    size_t book_task = add(PIPELINE_BOOK, "book", [this]() { sum_book(); });
+    for (size_t fit_task : stage_tasks[PIPELINE_FIT]) graph.add_dependency(fit_task, surface_task);
+    for (size_t risk_task : stage_tasks[PIPELINE_RISK]) graph.add_dependency(risk_task, book_task);
+
+    if (!graph.run(num_threads)) return false;
+
+    for (const Expiry& x : expiries) {
+        if (x.slice.num_points >= 5) previous[x.expiry_date] = x.slice;
+    }
+    return true;
+}
+
+void SnapshotPipeline::parse(const MarketData& market, size_t e) {
+    Expiry& x = expiries[e];
+    x.chain.build(market, x.expiry_date);
+    const OptionChain& chain = x.chain;
+    size_t n = chain.size();
+    x.phi.resize(n);
+    x.S.assign(n, chain.spot_price());
+    x.K.resize(n);
+    x.r.resize(n);
+    x.T.resize(n);
+    x.mid.resize(n);
+    x.iv.resize(n);
+    if (chain.num_expiries() == 0) return;
+    double T = chain.days_to_expiry(0) / 365.0;
+    for (int side = CHAIN_CALLS; side < CHAIN_NUM_SIDES; side++) {
+        for (size_t row = chain.begin(0, ChainSide(side)); row < chain.end(0, ChainSide(side)); row++) {
+            x.phi[row] = side == CHAIN_CALLS ? 1.0 : -1.0;
+            x.K[row] = chain.strike(row);
+            x.r[row] = chain.zero_rate(0);
+            x.T[row] = T;
+            x.mid[row] = chain.mid_price(row);
+        }
+    }
+}
+
+// The chain's quoted vols are replaced by those implied by its mids
+void SnapshotPipeline::invert(size_t e) {
+    Expiry& x = expiries[e];
+    size_t n = x.chain.size();
+    x.failed_ivs = 0;
+    if (n == 0) return;
+    calc_implied_vols(x.phi.data(), x.mid.data(), x.S.data(), x.K.data(), x.r.data(), x.T.data(),
+                      x.iv.data(), n);
+    for (size_t row = 0; row < n; row++) {
+        x.chain.set_implied_vol(row, x.iv[row]);
+        if (!std::isfinite(x.iv[row])) x.failed_ivs++;
+    }
+}
+
+void SnapshotPipeline::fit(size_t e) {
+    Expiry& x = expiries[e];
+    x.slice = SviSlice();
+    x.slice.expiry_date = x.expiry_date;
+    if (x.chain.num_expiries() == 0) return;
+    auto it = previous.find(x.expiry_date);
+    const SviSlice* prev = (it != previous.end()) ? &it->second : nullptr;
+    svi_fit_slice(x.chain, 0, prev, fit_options, x.slice);
+}
+
+void SnapshotPipeline::value(const PositionSet& positions, size_t e) {
+    Expiry& x = expiries[e];
+    ExpiryRisk risk = {x.positions.size(), 0.0, 0.0, 0.0, 0.0};
+    const SviSlice& slice = x.slice;
+    bool fitted = slice.num_points >= 5 && slice.T > 0.0;
+    double S = x.chain.spot_price();
+    double r = x.chain.num_expiries() ? x.chain.zero_rate(0) : x.chain.risk_free_rate();
+
+    ArrayView<double> K = positions.strike_column();
+    ArrayView<double> T = positions.expiry_column();
+    ArrayView<double> vol = positions.vol_column();
+    ArrayView<double> quantity = positions.quantity_column();
+    for (size_t i : x.positions) {
+        double sigma = vol[i];
+        if (fitted) {
+            double w = svi_total_variance(slice.params, log(K[i] / slice.forward));
+            if (w > 0.0) sigma = sqrt(w / slice.T);
+        }
+        BlackScholesGreeks g = calc_black_scholes_greeks(positions.is_call(i), S, K[i], r, T[i], sigma);
+        risk.value += quantity[i] * g.price;
+        risk.delta += quantity[i] * g.delta;
+        risk.gamma += quantity[i] * g.gamma;
+        risk.vega += quantity[i] * g.vega;
+    }
+    x.risk = risk;
+}
+
+void SnapshotPipeline::build_surface(const MarketData& market) {
+    std::vector<SviSlice> slices;
+    slices.reserve(expiries.size());
+    for (const Expiry& x : expiries) slices.push_back(x.slice);
+    svi.set_slices(slices);
+    vol_surface.build(svi, market.spot_price, YieldCurve(market.risk_free_rate));
+}
+
+void SnapshotPipeline::sum_book() {
+    ExpiryRisk total = {0, 0.0, 0.0, 0.0, 0.0};
+    for (const Expiry& x : expiries) {
+        total.positions += x.risk.positions;
+        total.value += x.risk.value;
+        total.delta += x.risk.delta;
+        total.gamma += x.risk.gamma;
+        total.vega += x.risk.vega;
+    }
+    book = total;
+}
+
+double SnapshotPipeline::stage_seconds(PipelineStage stage) const {
+    double total = 0.0;
+    for (size_t task : stage_tasks[stage]) total += graph.seconds(task);
+    return total;
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef __SNAPSHOT_PIPELINE_H
+#define __SNAPSHOT_PIPELINE_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "task_graph.h"
+#include "../market_data/market_data.h"
+#include "../market_data/option_chain.h"
+#include "../market_data/yield_curve.h"
+#include "../risk/position_set.h"
+#include "../volatility/svi.h"
+#include "../volatility/vol_surface.h"
+
+enum PipelineStage {
+    PIPELINE_PARSE,    // Per expiry: chain of the expiry and solver inputs
+    PIPELINE_IV,       // Per expiry: implied vols of the mid prices
+    PIPELINE_FIT,      // Per expiry: SVI slice through the implied vols
+    PIPELINE_RISK,     // Per expiry: value and Greeks of the book's positions at SVI vols
+    PIPELINE_SURFACE,  // All fitted slices into one VolSurface
+    PIPELINE_BOOK,     // Per-expiry risk summed over the book
+    PIPELINE_NUM_STAGES
+};
+
+const char* pipeline_stage_name(PipelineStage stage);
+
+struct ExpiryRisk {
+    size_t positions;
+    double value;
+    double delta;
+    double gamma;
+    double vega;
+};
+
+// One market snapshot from quotes to book risk, as a task graph with a chain
+// of parse, IV, fit and risk tasks per expiry. Expiries are independent, so
+// their chains run concurrently; the surface waits for every fit and the
+// book total for every risk task.
+//
+// Each position is valued in the expiry nearest its time to expiry, at the
+// vol of that expiry's SVI slice at its strike (its own vol if the slice
+// could not be fitted). A pipeline kept from one snapshot to the next
+// warm-starts each SVI fit from the previous parameters of the expiry.
+class SnapshotPipeline {
+private:
+    struct Expiry {
+        std::string expiry_date;
+        OptionChain chain;  // This expiry only
+        std::vector<double> phi, S, K, r, T, mid, iv;
+        size_t failed_ivs;  // Mids outside the no-arbitrage bounds
+        SviSlice slice;
+        std::vector<size_t> positions;
+        ExpiryRisk risk;
+    };
+
+    std::vector<Expiry> expiries;
+    std::map<std::string, SviSlice> previous;  // Warm starts
+    SviFitOptions fit_options;
+    SviSurface svi;
+    VolSurface vol_surface;
+    ExpiryRisk book;
+    TaskGraph graph;
+    std::vector<size_t> stage_tasks[PIPELINE_NUM_STAGES];
+
+    void parse(const MarketData& market, size_t e);
+    void invert(size_t e);
+    void fit(size_t e);
+    void value(const PositionSet& positions, size_t e);
+    void build_surface(const MarketData& market);
+    void sum_book();
+
+public:
+    SnapshotPipeline(const SviFitOptions& _fit_options = SviFitOptions());
+
+    // Runs the whole snapshot on up to num_threads threads (0 means one per
+    // hardware thread). The market and positions must outlive the call only
+    bool run(const MarketData& market, const PositionSet& positions, unsigned num_threads = 0);
+
+    size_t num_expiries() const { return expiries.size(); }
+    const std::string& expiry_date(size_t e) const { return expiries[e].expiry_date; }
+    const SviSlice& slice(size_t e) const { return expiries[e].slice; }
+    size_t failed_ivs(size_t e) const { return expiries[e].failed_ivs; }
+    const ExpiryRisk& expiry_risk(size_t e) const { return expiries[e].risk; }
+    const ExpiryRisk& book_risk() const { return book; }
+    const VolSurface& surface() const { return vol_surface; }
+
+    // Scheduling and timings of the last run
+    const TaskGraph& tasks() const { return graph; }
+    size_t stage_tasks_run(PipelineStage stage) const { return stage_tasks[stage].size(); }
+    double stage_seconds(PipelineStage stage) const;
+};
+
+#endif
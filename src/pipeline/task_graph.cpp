@@ -0,0 +1,216 @@
+#ifndef __TASK_GRAPH_CPP
+#define __TASK_GRAPH_CPP
+
+#include "task_graph.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+TaskGraph::TaskGraph() : wall(0.0), threads_used(0) {}
+
+size_t TaskGraph::add_task(const std::string& name, std::function<void()> fn) {
+    Task task;
+    task.name = name;
+    task.fn = std::move(fn);
+    tasks.push_back(std::move(task));
+    timings.push_back(TaskTiming());
+    return tasks.size() - 1;
+}
+
+void TaskGraph::add_dependency(size_t before, size_t after) {
+    tasks[before].successors.push_back(after);
+    tasks[after].predecessors.push_back(before);
+}
+
+void TaskGraph::clear() {
+    tasks.clear();
+    timings.clear();
+    wall = 0.0;
+    threads_used = 0;
+}
+
+// Kahn's algorithm. False if some tasks are left over, i.e. on a cycle
+bool TaskGraph::topological_order(std::vector<size_t>& order) const {
+    const size_t n = tasks.size();
+    std::vector<size_t> waiting(n);
+    order.clear();
+    for (size_t t = 0; t < n; t++) {
+        waiting[t] = tasks[t].predecessors.size();
+        if (waiting[t] == 0) order.push_back(t);
+    }
+    for (size_t i = 0; i < order.size(); i++) {
+        for (size_t s : tasks[order[i]].successors) {
+            if (--waiting[s] == 0) order.push_back(s);
+        }
+    }
+    return order.size() == n;
+}
+
+bool TaskGraph::run(unsigned num_threads) {
+    std::vector<size_t> order;
+    if (!topological_order(order)) {
+        std::cerr << "Task graph has a dependency cycle, " << tasks.size() - order.size()
+                  << " of " << tasks.size() << " tasks cannot run" << std::endl;
+        return false;
+    }
+
+    const size_t n = tasks.size();
+    std::vector<size_t> waiting(n);
+    std::vector<size_t> ready;  // Used as a stack, newest first
+    for (size_t t = n; t-- > 0;) {
+        waiting[t] = tasks[t].predecessors.size();
+        if (waiting[t] == 0) ready.push_back(t);
+    }
+    size_t finished = 0;
+    std::mutex mutex;
+    std::condition_variable wake;
+
+    // The first exception thrown by a task. Tasks not yet started when it
+    // is caught are skipped, but still release their successors, so the
+    // graph drains and every thread returns
+    std::exception_ptr error;
+    size_t failed_task = n;
+    size_t skipped = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto since_start = [&]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    };
+
+    // Tasks are coarse (a stage of a whole expiry), so one lock around the
+    // ready stack costs nothing measurable
+    auto worker = [&](unsigned thread) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&]() { return !ready.empty() || finished == n; });
+            if (ready.empty()) return;
+            size_t t = ready.back();
+            ready.pop_back();
+            bool skip = static_cast<bool>(error);
+            lock.unlock();
+
+            TaskTiming& timing = timings[t];
+            timing.thread = thread;
+            timing.start = since_start();
+            std::exception_ptr thrown;
+            if (!skip && tasks[t].fn) {
+                try {
+                    tasks[t].fn();
+                } catch (...) {
+                    thrown = std::current_exception();
+                }
+            }
+            timing.end = since_start();
+
+            lock.lock();
+            if (skip) skipped++;
+            if (thrown && !error) {
+                error = thrown;
+                failed_task = t;
+            }
+            finished++;
+            size_t made_ready = 0;
+            for (size_t s : tasks[t].successors) {
+                if (--waiting[s] == 0) {
+                    ready.push_back(s);
+                    made_ready++;
+                }
+            }
+            // This thread takes one of them itself
+            if (finished == n) {
+                wake.notify_all();
+            } else {
+                for (size_t i = 1; i < made_ready; i++) wake.notify_one();
+            }
+        }
+    };
+
+    unsigned max_threads = num_threads ? num_threads : std::thread::hardware_concurrency();
+    threads_used = std::max(1u, std::min<unsigned>(max_threads, static_cast<unsigned>(std::max<size_t>(n, 1))));
+    std::vector<std::thread> threads;
+    try {
+        for (unsigned i = 1; i < threads_used; i++) threads.emplace_back(worker, i);
+    } catch (const std::system_error&) {
+        // Carry on with the threads that did start
+        threads_used = static_cast<unsigned>(threads.size()) + 1;
+    }
+    worker(0);
+    for (auto& t : threads) t.join();
+    wall = since_start();
+
+    if (error) {
+        std::string what = "unknown exception";
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            what = e.what();
+        } catch (...) {
+        }
+        std::cerr << "Task " << tasks[failed_task].name << " failed: " << what << "; "
+                  << skipped << " of " << n << " tasks were not run" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+double TaskGraph::busy_seconds() const {
+    double total = 0.0;
+    for (size_t t = 0; t < tasks.size(); t++) total += seconds(t);
+    return total;
+}
+
+std::vector<size_t> TaskGraph::critical_path() const {
+    std::vector<size_t> order, path;
+    if (tasks.empty() || !topological_order(order)) return path;
+
+    // Longest time to the end of each task, and the predecessor it came through
+    const size_t none = tasks.size();
+    std::vector<double> finish(tasks.size(), 0.0);
+    std::vector<size_t> via(tasks.size(), none);
+    for (size_t t : order) {
+        double start = 0.0;
+        for (size_t p : tasks[t].predecessors) {
+            if (finish[p] > start) {
+                start = finish[p];
+                via[t] = p;
+            }
+        }
+        finish[t] = start + seconds(t);
+    }
+    size_t last = std::max_element(finish.begin(), finish.end()) - finish.begin();
+    for (size_t t = last; t != none; t = via[t]) path.push_back(t);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+double TaskGraph::critical_path_seconds() const {
+    double total = 0.0;
+    for (size_t t : critical_path()) total += seconds(t);
+    return total;
+}
+
+void TaskGraph::report(std::ostream& out) const {
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    double busy = busy_seconds();
+    double critical = critical_path_seconds();
+    out << std::fixed << std::setprecision(3)
+        << "Tasks: " << tasks.size() << " on " << threads_used << " thread(s)\n"
+        << "Wall time:      " << std::setw(9) << wall * 1000.0 << " ms\n"
+        << "Sum of tasks:   " << std::setw(9) << busy * 1000.0 << " ms\n"
+        << "Critical path:  " << std::setw(9) << critical * 1000.0 << " ms";
+    if (critical > 0.0) out << std::setprecision(1) << " (parallelism " << busy / critical << "x)";
+    out << "\nCritical path tasks:";
+    for (size_t t : critical_path()) out << " " << tasks[t].name;
+    out << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef __TASK_GRAPH_H
+#define __TASK_GRAPH_H
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct TaskTiming {
+    double start;     // Seconds from the start of run()
+    double end;
+    unsigned thread;  // Worker that ran the task, 0 is the calling thread
+};
+
+// Directed acyclic graph of tasks run on a set of worker threads. A task is
+// started as soon as all of its predecessors have finished, so independent
+// chains of tasks (e.g. one per expiry) overlap and the graph takes as long
+// as its critical path rather than the sum of its tasks, given enough
+// threads.
+//
+// Ready tasks are taken newest first: a thread that finishes a task carries
+// on with the successor it made ready, so a chain runs through its stages
+// while its data is still in cache and its results arrive early.
+class TaskGraph {
+private:
+    struct Task {
+        std::string name;
+        std::function<void()> fn;
+        std::vector<size_t> successors;
+        std::vector<size_t> predecessors;
+    };
+
+    std::vector<Task> tasks;
+    std::vector<TaskTiming> timings;
+    double wall;
+    unsigned threads_used;
+
+    bool topological_order(std::vector<size_t>& order) const;
+
+public:
+    TaskGraph();
+
+    // Returns the index of the new task
+    size_t add_task(const std::string& name, std::function<void()> fn);
+
+    // Task after is not started before task before has finished
+    void add_dependency(size_t before, size_t after);
+
+    void clear();
+
+    // Runs every task once on up to num_threads threads (0 means one per
+    // hardware thread), the caller included. Returns false, without running
+    // anything, if the dependencies form a cycle. If a task throws, the tasks
+    // not yet started are skipped, all threads are joined and run() returns
+    // false, with the task and exception on cerr
+    bool run(unsigned num_threads = 0);
+
+    size_t size() const { return tasks.size(); }
+    const std::string& name(size_t task) const { return tasks[task].name; }
+
+    // Timings of the last run
+    const TaskTiming& timing(size_t task) const { return timings[task]; }
+    double seconds(size_t task) const { return timings[task].end - timings[task].start; }
+    double wall_seconds() const { return wall; }
+    unsigned threads() const { return threads_used; }
+    double busy_seconds() const;  // Sum over tasks
+
+    // Longest chain of dependent tasks by their measured times: the least
+    // wall time any number of threads could have achieved
+    double critical_path_seconds() const;
+    std::vector<size_t> critical_path() const;
+
+    // Wall, busy and critical path times, and the tasks on the critical path
+    void report(std::ostream& out) const;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __FENWICK_TREE_H
+#define __FENWICK_TREE_H
+
+#include <cstddef>
+#include <vector>
+
+// Binary indexed tree over n cells: point updates and prefix/range sums in
+// O(log n). T needs a value-initialised zero, += and -=.
+template<typename T>
+class FenwickTree {
+private:
+    std::vector<T> tree;  // 1-based
+
+public:
+    FenwickTree(size_t n = 0) : tree(n + 1, T()) {}
+
+    size_t size() const { return tree.size() - 1; }
+
+    // cell[i] += delta
+    void add(size_t i, const T& delta) {
+        for (size_t j=i+1; j<tree.size(); j+=j&(~j+1)) tree[j] += delta;
+    }
+
+    // cell[i] -= delta
+    void subtract(size_t i, const T& delta) {
+        for (size_t j=i+1; j<tree.size(); j+=j&(~j+1)) tree[j] -= delta;
+    }
+
+    // Sum of cells [0, i)
+    T prefix(size_t i) const {
+        T sum = T();
+        for (size_t j=i; j>0; j-=j&(~j+1)) sum += tree[j];
+        return sum;
+    }
+
+    // Sum of cells [first, last)
+    T range(size_t first, size_t last) const {
+        T sum = prefix(last);
+        sum -= prefix(first);
+        return sum;
+    }
+};
+
+#endif
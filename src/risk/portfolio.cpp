@@ -0,0 +1,148 @@
+#ifndef __PORTFOLIO_CPP
+#define __PORTFOLIO_CPP
+
+#include "portfolio.h"
+#include "../option_pricing/vanilla/black_scholes.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+Portfolio::Portfolio(const std::vector<double>& _spots, const YieldCurve& _curve,
+                     const std::vector<double>& _expiry_edges, const std::vector<double>& _strike_edges)
+    : spots(_spots), reference_spots(_spots), curve(_curve),
+      expiry_edges(_expiry_edges), strike_edges(_strike_edges),
+      expiry_buckets(_expiry_edges.size() + 1), strike_buckets(_strike_edges.size() + 1),
+      num_active(0),
+      by_expiry(_spots.size() * (_expiry_edges.size() + 1) * (_strike_edges.size() + 1)),
+      by_strike(_spots.size() * (_expiry_edges.size() + 1) * (_strike_edges.size() + 1)) {}
+
+// Quantity-independent price and Greeks of one unit of p
+void Portfolio::price(Position& p) const {
+    BlackScholesGreeks g = calc_black_scholes_greeks(p.is_call, spots[p.underlying], p.K,
+                                                     curve.zero_rate(p.T), p.T, p.sigma, curve.discount(p.T));
+    p.unit.value = g.price;
+    p.unit.delta = g.delta;
+    p.unit.gamma = g.gamma;
+    p.unit.vega = g.vega;
+    p.unit.theta = g.theta;
+    p.unit.rho = g.rho;
+}
+
+static RiskTotals scaled(const RiskTotals& unit, double quantity) {
+    RiskTotals r;
+    r.value = quantity * unit.value;
+    r.delta = quantity * unit.delta;
+    r.gamma = quantity * unit.gamma;
+    r.vega = quantity * unit.vega;
+    r.theta = quantity * unit.theta;
+    r.rho = quantity * unit.rho;
+    return r;
+}
+
+void Portfolio::insert(const Position& p) {
+    RiskTotals r = scaled(p.unit, p.quantity);
+    by_expiry.add(expiry_cell(p.underlying, p.expiry_bucket, p.strike_bucket), r);
+    by_strike.add(strike_cell(p.underlying, p.expiry_bucket, p.strike_bucket), r);
+}
+
+void Portfolio::erase(const Position& p) {
+    RiskTotals r = scaled(p.unit, p.quantity);
+    by_expiry.subtract(expiry_cell(p.underlying, p.expiry_bucket, p.strike_bucket), r);
+    by_strike.subtract(strike_cell(p.underlying, p.expiry_bucket, p.strike_bucket), r);
+}
+
+size_t Portfolio::add(unsigned underlying, bool is_call, double K, double T, double sigma, double quantity) {
+    if (underlying >= spots.size()) {
+        std::cerr << "Position refers to underlying " << underlying << ", but the book has "
+                  << spots.size() << " spots." << std::endl;
+        return PORTFOLIO_INVALID_ID;
+    }
+    if (!(K > 0.0 && T > 0.0 && sigma > 0.0) || !std::isfinite(quantity)) {
+        std::cerr << "Position with K " << K << ", T " << T << ", sigma " << sigma
+                  << " and quantity " << quantity << " rejected." << std::endl;
+        return PORTFOLIO_INVALID_ID;
+    }
+
+    Position p;
+    p.underlying = underlying;
+    p.is_call = is_call;
+    p.active = true;
+    p.K = K;
+    p.T = T;
+    p.sigma = sigma;
+    p.quantity = quantity;
+    p.expiry_bucket = std::lower_bound(expiry_edges.begin(), expiry_edges.end(), T) - expiry_edges.begin();
+    p.strike_bucket = std::lower_bound(strike_edges.begin(), strike_edges.end(),
+                                       K / reference_spots[underlying]) - strike_edges.begin();
+    price(p);
+    insert(p);
+
+    size_t id;
+    if (free_ids.empty()) {
+        id = positions.size();
+        positions.push_back(p);
+    } else {
+        id = free_ids.back();
+        free_ids.pop_back();
+        positions[id] = p;
+    }
+    num_active++;
+    return id;
+}
+
+void Portfolio::remove(size_t id) {
+    if (!is_active(id)) return;
+    erase(positions[id]);
+    positions[id].active = false;
+    free_ids.push_back(id);
+    num_active--;
+}
+
+bool Portfolio::amend(size_t id, double quantity) {
+    if (!is_active(id) || !std::isfinite(quantity)) return false;
+    Position& p = positions[id];
+    RiskTotals r = scaled(p.unit, quantity - p.quantity);
+    by_expiry.add(expiry_cell(p.underlying, p.expiry_bucket, p.strike_bucket), r);
+    by_strike.add(strike_cell(p.underlying, p.expiry_bucket, p.strike_bucket), r);
+    p.quantity = quantity;
+    return true;
+}
+
+bool Portfolio::reprice(size_t id, double sigma) {
+    if (!is_active(id) || !(sigma > 0.0)) return false;
+    Position& p = positions[id];
+    erase(p);
+    p.sigma = sigma;
+    price(p);
+    insert(p);
+    return true;
+}
+
+RiskTotals Portfolio::total() const {
+    return by_expiry.prefix(by_expiry.size());
+}
+
+RiskTotals Portfolio::underlying_total(unsigned u) const {
+    if (u >= spots.size()) return RiskTotals();
+    return by_expiry.range(expiry_cell(u, 0, 0), expiry_cell(u + 1, 0, 0));
+}
+
+RiskTotals Portfolio::expiry_total(unsigned u, size_t first_bucket, size_t last_bucket) const {
+    if (u >= spots.size()) return RiskTotals();
+    return by_expiry.range(expiry_cell(u, first_bucket, 0), expiry_cell(u, last_bucket, 0));
+}
+
+RiskTotals Portfolio::strike_total(unsigned u, size_t first_bucket, size_t last_bucket) const {
+    if (u >= spots.size()) return RiskTotals();
+    return by_strike.range(strike_cell(u, 0, first_bucket), strike_cell(u, 0, last_bucket));
+}
+
+RiskTotals Portfolio::recompute_total() const {
+    RiskTotals sum;
+    for (const Position& p : positions) {
+        if (p.active) sum += scaled(p.unit, p.quantity);
+    }
+    return sum;
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef __PORTFOLIO_H
+#define __PORTFOLIO_H
+
+#include <cstddef>
+#include <vector>
+#include "fenwick_tree.h"
+#include "../market_data/yield_curve.h"
+
+// Quantity-weighted value and Black-Scholes sensitivities of a group of
+// positions (vega and rho per unit, theta per year)
+struct RiskTotals {
+    double value;
+    double delta;
+    double gamma;
+    double vega;
+    double theta;
+    double rho;
+
+    RiskTotals() : value(0.0), delta(0.0), gamma(0.0), vega(0.0), theta(0.0), rho(0.0) {}
+
+    RiskTotals& operator+=(const RiskTotals& rhs) {
+        value += rhs.value; delta += rhs.delta; gamma += rhs.gamma;
+        vega += rhs.vega; theta += rhs.theta; rho += rhs.rho;
+        return *this;
+    }
+    RiskTotals& operator-=(const RiskTotals& rhs) {
+        value -= rhs.value; delta -= rhs.delta; gamma -= rhs.gamma;
+        vega -= rhs.vega; theta -= rhs.theta; rho -= rhs.rho;
+        return *this;
+    }
+};
+
+// Id returned by Portfolio::add for a position it rejects
+const size_t PORTFOLIO_INVALID_ID = static_cast<size_t>(-1);
+
+// Book of European option positions that keeps its totals up to date
+// incrementally. Every position falls into a cell (underlying, expiry
+// bucket, strike bucket); cell totals live in two Fenwick trees, one laid
+// out expiry-major and one strike-major, so that adding, amending,
+// repricing or removing a position costs O(log cells) and any contiguous
+// range of expiry or strike buckets of an underlying is one range query.
+//
+// Expiry buckets are given by increasing edges in years and strike buckets
+// by edges in moneyness K/S, against the spot each underlying had when the
+// book was created. A position belongs to the first bucket whose edge is
+// >= its value; the last bucket is open-ended.
+class Portfolio {
+private:
+    struct Position {
+        unsigned underlying;
+        bool is_call;
+        bool active;
+        double K;
+        double T;
+        double sigma;
+        double quantity;
+        size_t expiry_bucket;
+        size_t strike_bucket;
+        RiskTotals unit;  // Price and Greeks of one unit
+    };
+
+    std::vector<double> spots;
+    std::vector<double> reference_spots;  // Used for strike buckets
+    YieldCurve curve;
+    std::vector<double> expiry_edges;
+    std::vector<double> strike_edges;
+    size_t expiry_buckets;  // expiry_edges.size() + 1
+    size_t strike_buckets;  // strike_edges.size() + 1
+
+    std::vector<Position> positions;
+    std::vector<size_t> free_ids;
+    size_t num_active;
+
+    FenwickTree<RiskTotals> by_expiry;  // Cell (u, e, k) at (u * E + e) * K + k
+    FenwickTree<RiskTotals> by_strike;  // Cell (u, e, k) at (u * K + k) * E + e
+
+    size_t expiry_cell(unsigned u, size_t e, size_t k) const { return (u * expiry_buckets + e) * strike_buckets + k; }
+    size_t strike_cell(unsigned u, size_t e, size_t k) const { return (u * strike_buckets + k) * expiry_buckets + e; }
+
+    void price(Position& p) const;
+    void insert(const Position& p);
+    void erase(const Position& p);
+
+public:
+    Portfolio(const std::vector<double>& _spots, const YieldCurve& _curve,
+              const std::vector<double>& _expiry_edges, const std::vector<double>& _strike_edges);
+
+    // Returns the position's id, which stays valid until it is removed, or
+    // PORTFOLIO_INVALID_ID (with a message on stderr) if the underlying has
+    // no spot, K, T or sigma is not positive or the quantity is not finite.
+    // Such a position would index past the trees or make every total NaN
+    size_t add(unsigned underlying, bool is_call, double K, double T, double sigma, double quantity);
+    void remove(size_t id);
+
+    // Both return false, leaving the book unchanged, for an inactive id, a
+    // quantity that is not finite or a sigma that is not positive
+    bool amend(size_t id, double quantity);
+    bool reprice(size_t id, double sigma);  // New implied vol for one position
+
+    size_t size() const { return num_active; }
+    size_t num_underlyings() const { return spots.size(); }
+    size_t num_expiry_buckets() const { return expiry_buckets; }
+    size_t num_strike_buckets() const { return strike_buckets; }
+    bool is_active(size_t id) const { return id < positions.size() && positions[id].active; }
+    double quantity(size_t id) const { return positions[id].quantity; }
+    const RiskTotals& unit_risk(size_t id) const { return positions[id].unit; }
+
+    // Aggregates, each an O(log cells) query; zero for an unknown underlying
+    RiskTotals total() const;
+    RiskTotals underlying_total(unsigned u) const;
+    RiskTotals expiry_total(unsigned u, size_t first_bucket, size_t last_bucket) const;  // Buckets [first, last)
+    RiskTotals strike_total(unsigned u, size_t first_bucket, size_t last_bucket) const;  // Buckets [first, last)
+
+    // Recompute every total from the positions (for checking the trees)
+    RiskTotals recompute_total() const;
+};
+
+#endif
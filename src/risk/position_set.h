@@ -0,0 +1,61 @@
+#ifndef __POSITION_SET_H
+#define __POSITION_SET_H
+
+#include <cstddef>
+#include <vector>
+#include "../market_data/array_view.h"
+
+// European option positions stored column by column for the risk engines.
+// Each position refers to its underlying by index, and its quantity already
+// includes the contract multiplier (e.g. 10 SPX contracts = 1000).
+class PositionSet {
+private:
+    std::vector<unsigned> underlyings;
+    std::vector<double> phis;       // +1 for calls, -1 for puts
+    std::vector<double> strikes;
+    std::vector<double> expiries;   // Time to expiry in years
+    std::vector<double> vols;       // Implied vol used for the base valuation
+    std::vector<double> quantities;
+
+public:
+    size_t add(unsigned underlying, bool is_call, double K, double T, double sigma, double quantity) {
+        underlyings.push_back(underlying);
+        phis.push_back(is_call ? 1.0 : -1.0);
+        strikes.push_back(K);
+        expiries.push_back(T);
+        vols.push_back(sigma);
+        quantities.push_back(quantity);
+        return underlyings.size() - 1;
+    }
+
+    void reserve(size_t n) {
+        underlyings.reserve(n);
+        phis.reserve(n);
+        strikes.reserve(n);
+        expiries.reserve(n);
+        vols.reserve(n);
+        quantities.reserve(n);
+    }
+
+    void clear() {
+        underlyings.clear();
+        phis.clear();
+        strikes.clear();
+        expiries.clear();
+        vols.clear();
+        quantities.clear();
+    }
+
+    size_t size() const { return underlyings.size(); }
+    unsigned underlying(size_t i) const { return underlyings[i]; }
+    bool is_call(size_t i) const { return phis[i] > 0.0; }
+
+    ArrayView<unsigned> underlying_column() const { return ArrayView<unsigned>(underlyings.data(), underlyings.size()); }
+    ArrayView<double> phi_column() const { return ArrayView<double>(phis.data(), phis.size()); }
+    ArrayView<double> strike_column() const { return ArrayView<double>(strikes.data(), strikes.size()); }
+    ArrayView<double> expiry_column() const { return ArrayView<double>(expiries.data(), expiries.size()); }
+    ArrayView<double> vol_column() const { return ArrayView<double>(vols.data(), vols.size()); }
+    ArrayView<double> quantity_column() const { return ArrayView<double>(quantities.data(), quantities.size()); }
+};
+
+#endif
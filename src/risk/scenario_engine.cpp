@@ -0,0 +1,382 @@
+#ifndef __SCENARIO_ENGINE_CPP
+#define __SCENARIO_ENGINE_CPP
+
+#include "scenario_engine.h"
+#include "../math/statistics/accumulators.h"
+#include "../option_pricing/vanilla/black_scholes.h"
+#include "../instrumentation/instrumentation.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+// Shocked vols are floored so that a large negative vol move cannot produce
+// a zero or negative volatility
+const double RISK_MIN_VOL = 1e-4;
+
+// Corners of the (spot, vol, rate) box probed when checking the expansion
+const int RISK_NUM_PROBES = 8;
+
+ScenarioEngine::ScenarioEngine(const PositionSet& _positions, const std::vector<double>& _spots,
+                               const YieldCurve& curve)
+    : positions(_positions), spots(_spots), base_value(0.0) {
+    size_t n = positions.size();
+    ArrayView<unsigned> u = positions.underlying_column();
+    ArrayView<double> K = positions.strike_column();
+    ArrayView<double> T = positions.expiry_column();
+    ArrayView<double> vol = positions.vol_column();
+    ArrayView<double> q = positions.quantity_column();
+
+    std::vector<double> S(n);
+    base_rates.resize(n);
+    base_prices.resize(n);
+    deltas.resize(n);
+    gammas.resize(n);
+    vegas.resize(n);
+    vannas.resize(n);
+    volgas.resize(n);
+    rhos.resize(n);
+    for (size_t i=0; i<n; i++) {
+        S[i] = (u[i] < spots.size()) ? spots[u[i]] : 0.0;
+        base_rates[i] = curve.zero_rate(T[i]);
+        BlackScholesGreeks g = calc_black_scholes_greeks(positions.is_call(i), S[i], K[i],
+                                                         base_rates[i], T[i], vol[i], curve.discount(T[i]));
+        deltas[i] = g.delta;
+        gammas[i] = g.gamma;
+        vegas[i] = g.vega;
+        rhos[i] = g.rho;
+
+        // Second-order vol terms, the same for calls and puts
+        double sigma_sqrt_T = vol[i] * sqrt(T[i]);
+        double d_1 = (log(S[i]/K[i]) + (base_rates[i] + 0.5 * vol[i] * vol[i]) * T[i]) / sigma_sqrt_T;
+        double d_2 = d_1 - sigma_sqrt_T;
+        vannas[i] = -g.vega / S[i] * d_2 / sigma_sqrt_T;
+        volgas[i] = g.vega * d_1 * d_2 / vol[i];
+    }
+
+    // Base prices come from the same batch pricer as the scenarios, so an
+    // unshocked scenario has exactly zero P&L
+    calc_black_scholes_prices(positions.phi_column().data(), S.data(), K.data(),
+                              base_rates.data(), T.data(), vol.data(), base_prices.data(), n);
+    for (size_t i=0; i<n; i++) base_value += q[i] * base_prices[i];
+}
+
+// P&L under scenario s of positions subset[0..n), or of positions 0..n when
+// subset is null. If position_pnl is given, each position's P&L is also
+// added to it
+double ScenarioEngine::reprice(const ScenarioSet& scenarios, size_t s, const size_t* subset, size_t n,
+                               size_t chunk_size, Workspace& ws, double* position_pnl) const {
+    const unsigned* u = positions.underlying_column().data();
+    const double* phi = positions.phi_column().data();
+    const double* K = positions.strike_column().data();
+    const double* T = positions.expiry_column().data();
+    const double* vol = positions.vol_column().data();
+    const double* q = positions.quantity_column().data();
+    const double* spot_return = scenarios.spot_returns_of(s);
+    const double* vol_shift = scenarios.vol_shifts_of(s);
+    double rate_shift = scenarios.rate_shift(s);
+
+    QF_COUNT(COUNTER_POSITION_REVALUATIONS, n);
+    double pnl = 0.0;
+    for (size_t first=0; first<n; first+=chunk_size) {
+        size_t len = std::min(chunk_size, n - first);
+        for (size_t j=0; j<len; j++) {
+            size_t i = subset ? subset[first + j] : first + j;
+            ws.phi[j] = phi[i];
+            ws.K[j] = K[i];
+            ws.T[j] = T[i];
+            ws.S[j] = spots[u[i]] * (1.0 + spot_return[u[i]]);
+            ws.sigma[j] = std::max(vol[i] + vol_shift[u[i]], RISK_MIN_VOL);
+            ws.r[j] = base_rates[i] + rate_shift;
+        }
+        calc_black_scholes_prices(ws.phi.data(), ws.S.data(), ws.K.data(), ws.r.data(), ws.T.data(),
+                                  ws.sigma.data(), ws.price.data(), len);
+        for (size_t j=0; j<len; j++) {
+            size_t i = subset ? subset[first + j] : first + j;
+            double dp = q[i] * (ws.price[j] - base_prices[i]);
+            pnl += dp;
+            if (position_pnl) position_pnl[i] += dp;
+        }
+    }
+    return pnl;
+}
+
+double ScenarioEngine::scenario_pnl(const ScenarioSet& scenarios, size_t s, const Approximation* approx,
+                                    size_t chunk_size, Workspace& ws, double* position_pnl) const {
+    if (!approx) return reprice(scenarios, s, nullptr, positions.size(), chunk_size, ws, position_pnl);
+
+    const double* spot_return = scenarios.spot_returns_of(s);
+    const double* vol_shift = scenarios.vol_shifts_of(s);
+    double rate_shift = scenarios.rate_shift(s);
+
+    // Bucketed expansion: one row of sensitivities per underlying
+    double pnl = approx->rho * rate_shift;
+    for (size_t u=0; u<spots.size(); u++) {
+        double dS = spots[u] * spot_return[u];
+        double dv = vol_shift[u];
+        pnl += approx->delta[u] * dS + approx->vega[u] * dv
+             + 0.5 * approx->gamma[u] * dS * dS + approx->vanna[u] * dS * dv + 0.5 * approx->volga[u] * dv * dv;
+    }
+
+    if (position_pnl) {
+        const unsigned* und = positions.underlying_column().data();
+        const double* q = positions.quantity_column().data();
+        for (size_t i=0; i<positions.size(); i++) {
+            if (approx->is_exact[i]) continue;
+            unsigned u = und[i];
+            position_pnl[i] += q[i] * expansion(i, spots[u] * spot_return[u], vol_shift[u], rate_shift);
+        }
+    }
+
+    return pnl + reprice(scenarios, s, approx->exact.data(), approx->exact.size(), chunk_size, ws, position_pnl);
+}
+
+// Second-order change in the price of one unit of position i
+double ScenarioEngine::expansion(size_t i, double dS, double dv, double dr) const {
+    return deltas[i] * dS + vegas[i] * dv + rhos[i] * dr
+         + 0.5 * gammas[i] * dS * dS + vannas[i] * dS * dv + 0.5 * volgas[i] * dv * dv;
+}
+
+// Compare the expansion with full revaluation at the corners of the box
+// spanned by the confidence-quantile absolute spot, vol and rate moves of
+// the scenario set, which is where the VaR/ES tail is decided
+static double abs_quantile(std::vector<double>& moves, double p) {
+    size_t k = static_cast<size_t>(p * (moves.size() - 1));
+    std::nth_element(moves.begin(), moves.begin() + k, moves.end());
+    return moves[k];
+}
+
+void ScenarioEngine::build_approximation(const ScenarioSet& scenarios, double tolerance, double confidence,
+                                         Approximation& approx) const {
+    size_t n_u = spots.size();
+    size_t n = positions.size();
+    size_t num_scenarios = scenarios.size();
+    std::vector<double> probe_return(n_u), probe_vol_shift(n_u), moves(num_scenarios);
+    for (size_t u=0; u<n_u; u++) {
+        for (size_t s=0; s<num_scenarios; s++) moves[s] = fabs(scenarios.spot_returns_of(s)[u]);
+        probe_return[u] = abs_quantile(moves, confidence);
+        for (size_t s=0; s<num_scenarios; s++) moves[s] = fabs(scenarios.vol_shifts_of(s)[u]);
+        probe_vol_shift[u] = abs_quantile(moves, confidence);
+    }
+    for (size_t s=0; s<num_scenarios; s++) moves[s] = fabs(scenarios.rate_shift(s));
+    double probe_rate_shift = abs_quantile(moves, confidence);
+
+    const unsigned* und = positions.underlying_column().data();
+    const double* q = positions.quantity_column().data();
+    std::vector<double> phi(RISK_NUM_PROBES * n), S(phi.size()), K(phi.size()), r(phi.size()),
+                        T(phi.size()), sigma(phi.size()), price(phi.size());
+    for (size_t i=0; i<n; i++) {
+        unsigned u = und[i];
+        for (int c=0; c<RISK_NUM_PROBES; c++) {
+            size_t k = i * RISK_NUM_PROBES + c;
+            phi[k] = positions.phi_column()[i];
+            K[k] = positions.strike_column()[i];
+            T[k] = positions.expiry_column()[i];
+            S[k] = spots[u] * (1.0 + ((c & 1) ? probe_return[u] : -probe_return[u]));
+            sigma[k] = std::max(positions.vol_column()[i] + ((c & 2) ? probe_vol_shift[u] : -probe_vol_shift[u]), RISK_MIN_VOL);
+            r[k] = base_rates[i] + ((c & 4) ? probe_rate_shift : -probe_rate_shift);
+        }
+    }
+    calc_black_scholes_prices(phi.data(), S.data(), K.data(), r.data(), T.data(), sigma.data(), price.data(), phi.size());
+
+    approx.exact.clear();
+    approx.is_exact.assign(n, 0);
+    approx.delta.assign(n_u, 0.0);
+    approx.gamma.assign(n_u, 0.0);
+    approx.vega.assign(n_u, 0.0);
+    approx.vanna.assign(n_u, 0.0);
+    approx.volga.assign(n_u, 0.0);
+    approx.rho = 0.0;
+
+    // Error estimate and non-linear P&L (the part the second-order terms
+    // have to capture) of each position, in money
+    std::vector<double> errors(n), budget_weights(n);
+    double budget = 0.0;
+    for (size_t i=0; i<n; i++) {
+        unsigned u = und[i];
+        double max_error = 0.0;
+        double max_pnl = 0.0;
+        for (int c=0; c<RISK_NUM_PROBES; c++) {
+            size_t k = i * RISK_NUM_PROBES + c;
+            double dS = S[k] - spots[u];
+            double dv = (c & 2) ? probe_vol_shift[u] : -probe_vol_shift[u];
+            double dr = (c & 4) ? probe_rate_shift : -probe_rate_shift;
+            double full = price[k] - base_prices[i];
+            max_error = std::max(max_error, fabs(full - expansion(i, dS, dv, dr)));
+            max_pnl = std::max(max_pnl, fabs(full - deltas[i] * dS - rhos[i] * dr));
+        }
+        errors[i] = fabs(q[i]) * max_error;
+        budget_weights[i] = fabs(q[i]) * max_pnl;
+        budget += budget_weights[i];
+    }
+    budget *= tolerance;
+
+    // Approximate the most benign positions first until the error budget is
+    // spent; everything after that is revalued in full
+    std::vector<size_t> order(n);
+    for (size_t i=0; i<n; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return errors[a] < errors[b]; });
+
+    double spent = 0.0;
+    for (size_t k=0; k<n; k++) {
+        size_t i = order[k];
+        unsigned u = und[i];
+        spent += errors[i];
+        if (spent > budget) {
+            approx.is_exact[i] = 1;
+            continue;
+        }
+        approx.delta[u] += q[i] * deltas[i];
+        approx.gamma[u] += q[i] * gammas[i];
+        approx.vega[u] += q[i] * vegas[i];
+        approx.vanna[u] += q[i] * vannas[i];
+        approx.volga[u] += q[i] * volgas[i];
+        approx.rho += q[i] * rhos[i];
+    }
+
+    // Keep the revalued positions in book order for the batch pricer
+    for (size_t i=0; i<n; i++) {
+        if (approx.is_exact[i]) approx.exact.push_back(i);
+    }
+}
+
+bool ScenarioEngine::run(const ScenarioSet& scenarios, const RiskEngineOptions& options,
+                         const Approximation* approx, RiskReport& report) const {
+    auto start_time = std::chrono::steady_clock::now();
+    size_t num_scenarios = scenarios.size();
+    size_t n = positions.size();
+
+    size_t chunk_size = std::max<size_t>(options.chunk_size, 1);
+    size_t block_size = std::max<size_t>(options.block_size, 1);
+    size_t num_blocks = (num_scenarios + block_size - 1) / block_size;
+    unsigned num_threads = options.num_threads ? options.num_threads : std::thread::hardware_concurrency();
+    num_threads = std::max(1u, std::min<unsigned>(num_threads, static_cast<unsigned>(num_blocks)));
+
+    report.base_value = base_value;
+    report.num_scenarios = num_scenarios;
+    report.exact_positions = approx ? approx->exact.size() : n;
+    report.threads = num_threads;
+    report.pnl.assign(num_scenarios, 0.0);
+
+    // Threads pull blocks of scenarios and stream each P&L into their own
+    // accumulators, which are merged once every block is done
+    std::vector<MomentAccumulator> moments(num_threads);
+    std::vector<TDigest> digests(num_threads);
+    std::atomic<size_t> next_block(0);
+
+    auto worker = [&](unsigned t) {
+        Workspace ws(chunk_size);
+        for (size_t b=next_block++; b<num_blocks; b=next_block++) {
+            QF_TIMED_SCOPE(TIMER_SCENARIO_BLOCK);
+            size_t last = std::min(num_scenarios, (b + 1) * block_size);
+            QF_COUNT(COUNTER_SCENARIOS, last - b * block_size);
+            for (size_t s=b*block_size; s<last; s++) {
+                double pnl = scenario_pnl(scenarios, s, approx, chunk_size, ws, nullptr);
+                report.pnl[s] = pnl;
+                moments[t].add(pnl);
+                digests[t].add(pnl);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t=1; t<num_threads; t++) workers.emplace_back(worker, t);
+    worker(0);
+    for (auto& w : workers) w.join();
+    workers.clear();
+
+    for (unsigned t=1; t<num_threads; t++) {
+        moments[0].merge(moments[t]);
+        digests[0].merge(digests[t]);
+    }
+    double tail_q = 1.0 - options.confidence;
+    report.mean_pnl = moments[0].mean();
+    report.stdev_pnl = moments[0].stdev();
+    report.var = -digests[0].quantile(tail_q);
+    report.es = -digests[0].lower_tail_mean(tail_q);
+
+    // Revisit only the tail scenarios, this time keeping the P&L of every
+    // position
+    size_t num_tail = std::max<size_t>(1, static_cast<size_t>(ceil(tail_q * num_scenarios - 1e-9)));
+    num_tail = std::min(num_tail, num_scenarios);
+    report.num_tail = num_tail;
+    report.contributions.clear();
+
+    if (options.contributions) {
+        std::vector<size_t> order(num_scenarios);
+        for (size_t s=0; s<num_scenarios; s++) order[s] = s;
+        std::nth_element(order.begin(), order.begin() + (num_tail - 1), order.end(),
+                         [&](size_t a, size_t b) { return report.pnl[a] < report.pnl[b]; });
+
+        unsigned tail_threads = std::max(1u, std::min<unsigned>(num_threads, static_cast<unsigned>(num_tail)));
+        std::vector<std::vector<double> > sums(tail_threads, std::vector<double>(n, 0.0));
+        std::atomic<size_t> next_tail(0);
+
+        auto tail_worker = [&](unsigned t) {
+            QF_TIMED_SCOPE(TIMER_TAIL_CONTRIBUTIONS);
+            Workspace ws(chunk_size);
+            for (size_t k=next_tail++; k<num_tail; k=next_tail++) {
+                scenario_pnl(scenarios, order[k], approx, chunk_size, ws, sums[t].data());
+            }
+        };
+        for (unsigned t=1; t<tail_threads; t++) workers.emplace_back(tail_worker, t);
+        tail_worker(0);
+        for (auto& w : workers) w.join();
+
+        report.contributions.assign(n, 0.0);
+        for (unsigned t=0; t<tail_threads; t++) {
+            for (size_t i=0; i<n; i++) report.contributions[i] -= sums[t][i];
+        }
+        for (size_t i=0; i<n; i++) report.contributions[i] /= static_cast<double>(num_tail);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    report.seconds = elapsed.count();
+    return true;
+}
+
+static bool risk_check_inputs(const PositionSet& positions, size_t num_spots,
+                              const ScenarioSet& scenarios, const RiskEngineOptions& options) {
+    for (size_t i=0; i<positions.size(); i++) {
+        if (positions.underlying(i) >= num_spots || positions.underlying(i) >= scenarios.num_underlyings()) {
+            std::cerr << "Position " << i << " refers to underlying " << positions.underlying(i)
+                      << ", which has no spot or scenario." << std::endl;
+            return false;
+        }
+    }
+    if (scenarios.size() == 0 || !(options.confidence > 0.0 && options.confidence < 1.0)) {
+        std::cerr << "Risk run needs at least one scenario and a confidence in (0,1)." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ScenarioEngine::full_revaluation(const ScenarioSet& scenarios, const RiskEngineOptions& options,
+                                      RiskReport& report) const {
+    if (!risk_check_inputs(positions, spots.size(), scenarios, options)) return false;
+    return run(scenarios, options, nullptr, report);
+}
+
+bool ScenarioEngine::approximation(const ScenarioSet& scenarios, const RiskEngineOptions& options,
+                                   RiskReport& report) const {
+    if (!risk_check_inputs(positions, spots.size(), scenarios, options)) return false;
+    if (scenarios.num_underlyings() != spots.size()) {
+        std::cerr << "Scenarios cover " << scenarios.num_underlyings() << " underlyings but the engine has "
+                  << spots.size() << " spots." << std::endl;
+        return false;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+    Approximation approx;
+    build_approximation(scenarios, options.approximation_tolerance, options.confidence, approx);
+    bool ok = run(scenarios, options, &approx, report);
+
+    // Include the set-up, which is part of the cost of this mode
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    report.seconds = elapsed.count();
+    return ok;
+}
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef __SCENARIO_ENGINE_H
+#define __SCENARIO_ENGINE_H
+
+#include <cstddef>
+#include <vector>
+#include "position_set.h"
+#include "scenarios.h"
+#include "../market_data/yield_curve.h"
+
+struct RiskEngineOptions {
+    double confidence;     // VaR/ES level, e.g. 0.99
+    unsigned num_threads;  // 0 = one per hardware thread
+    size_t block_size;     // Scenarios handed to a thread at a time
+    size_t chunk_size;     // Positions priced per batch call
+    bool contributions;    // Compute per-position ES contributions
+
+    // Delta-gamma-vega mode only. Each position's expansion error is
+    // estimated at the confidence-quantile moves of the scenario set;
+    // positions are approximated, smallest error first, while the summed
+    // error stays within this fraction of the book's non-linear P&L there.
+    // The remaining (typically short-dated, near-the-money) positions are
+    // fully revalued
+    double approximation_tolerance;
+
+    RiskEngineOptions()
+        : confidence(0.99), num_threads(0), block_size(64), chunk_size(512), contributions(true),
+          approximation_tolerance(0.02) {}
+};
+
+// VaR and ES are losses (positive numbers) read from a t-digest of the
+// scenario P&L. Contributions are Euler allocations over the worst
+// ceil((1 - confidence) * N) scenarios: contribution[i] is position i's
+// average loss there, and the contributions sum to that tail's mean loss.
+struct RiskReport {
+    double base_value;
+    double mean_pnl;
+    double stdev_pnl;
+    double var;
+    double es;
+    size_t num_scenarios;
+    size_t num_tail;
+    size_t exact_positions;  // Positions fully revalued in every scenario
+    unsigned threads;
+    double seconds;
+    std::vector<double> pnl;            // Portfolio P&L per scenario
+    std::vector<double> contributions;  // Per position, if requested
+};
+
+// Scenario P&L of a position set. Base prices, zero rates and Black-Scholes
+// sensitivities are computed once on construction. Two modes:
+//   full_revaluation - shock spot, vol and rate and reprice every position
+//                      with the batch pricer
+//   approximation    - delta-gamma-vega expansion (with the vanna and volga
+//                      cross terms, since spot and vol usually move
+//                      together, and rho) with sensitivities summed per
+//                      underlying, so a scenario costs O(number of
+//                      underlyings); positions the expansion cannot capture
+//                      over the scenario range are fully revalued
+class ScenarioEngine {
+private:
+    const PositionSet& positions;
+    std::vector<double> spots;        // Base spot per underlying
+    std::vector<double> base_rates;   // Zero rate to each position's expiry
+    std::vector<double> base_prices;
+    std::vector<double> deltas;       // Per unit of each position
+    std::vector<double> gammas;
+    std::vector<double> vegas;
+    std::vector<double> vannas;       // d(delta)/d(sigma)
+    std::vector<double> volgas;       // d(vega)/d(sigma)
+    std::vector<double> rhos;
+    double base_value;
+
+    // Quantity-weighted sensitivities by underlying of the approximated
+    // positions, and the positions that are revalued instead
+    struct Approximation {
+        std::vector<size_t> exact;
+        std::vector<char> is_exact;
+        std::vector<double> delta;
+        std::vector<double> gamma;
+        std::vector<double> vega;
+        std::vector<double> vanna;
+        std::vector<double> volga;
+        double rho;
+    };
+
+    // Shocked inputs and prices of one chunk of positions
+    struct Workspace {
+        std::vector<double> phi, S, K, r, T, sigma, price;
+        Workspace(size_t n) : phi(n), S(n), K(n), r(n), T(n), sigma(n), price(n) {}
+    };
+
+    double reprice(const ScenarioSet& scenarios, size_t s, const size_t* subset, size_t n,
+                   size_t chunk_size, Workspace& ws, double* position_pnl) const;
+    double scenario_pnl(const ScenarioSet& scenarios, size_t s, const Approximation* approx,
+                        size_t chunk_size, Workspace& ws, double* position_pnl) const;
+    double expansion(size_t i, double dS, double dv, double dr) const;
+    void build_approximation(const ScenarioSet& scenarios, double tolerance, double confidence,
+                             Approximation& approx) const;
+    bool run(const ScenarioSet& scenarios, const RiskEngineOptions& options,
+             const Approximation* approx, RiskReport& report) const;
+
+public:
+    ScenarioEngine(const PositionSet& _positions, const std::vector<double>& _spots,
+                   const YieldCurve& curve);
+
+    double value() const { return base_value; }
+    double base_price(size_t i) const { return base_prices[i]; }
+
+    bool full_revaluation(const ScenarioSet& scenarios, const RiskEngineOptions& options,
+                          RiskReport& report) const;
+    bool approximation(const ScenarioSet& scenarios, const RiskEngineOptions& options,
+                       RiskReport& report) const;
+};
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef __SCENARIOS_CPP
+#define __SCENARIOS_CPP
+
+#include "scenarios.h"
+#include "../math/random/linear_congruential_generator.h"
+#include "../math/statistics/statistics.h"
+#include <cmath>
+#include <iostream>
+
+void ScenarioSet::add(const double* spot_return, const double* vol_shift, double rate_shift) {
+    spot_returns.insert(spot_returns.end(), spot_return, spot_return + underlyings);
+    vol_shifts.insert(vol_shifts.end(), vol_shift, vol_shift + underlyings);
+    rate_shifts.push_back(rate_shift);
+}
+
+void ScenarioSet::reserve(size_t n) {
+    spot_returns.reserve(n * underlyings);
+    vol_shifts.reserve(n * underlyings);
+    rate_shifts.reserve(n);
+}
+
+void ScenarioSet::clear() {
+    spot_returns.clear();
+    vol_shifts.clear();
+    rate_shifts.clear();
+}
+
+bool historical_scenarios(const std::vector<double>& spots, const std::vector<double>& vols,
+                          const std::vector<double>& rates, size_t num_underlyings,
+                          size_t horizon_days, ScenarioSet& scenarios) {
+    size_t days = rates.size();
+    if (num_underlyings == 0 || horizon_days == 0 ||
+        spots.size() != days * num_underlyings || vols.size() != days * num_underlyings) {
+        std::cerr << "Historical spot, vol and rate series must cover the same days." << std::endl;
+        return false;
+    }
+
+    scenarios = ScenarioSet(num_underlyings);
+    if (days <= horizon_days) return true;
+    scenarios.reserve(days - horizon_days);
+
+    std::vector<double> spot_return(num_underlyings), vol_shift(num_underlyings);
+    for (size_t d=horizon_days; d<days; d++) {
+        const double* s_0 = &spots[(d - horizon_days) * num_underlyings];
+        const double* s_1 = &spots[d * num_underlyings];
+        const double* v_0 = &vols[(d - horizon_days) * num_underlyings];
+        const double* v_1 = &vols[d * num_underlyings];
+        for (size_t u=0; u<num_underlyings; u++) {
+            spot_return[u] = s_1[u] / s_0[u] - 1.0;
+            vol_shift[u] = v_1[u] - v_0[u];
+        }
+        scenarios.add(spot_return.data(), vol_shift.data(), rates[d] - rates[d - horizon_days]);
+    }
+    return true;
+}
+
+bool mc_scenarios(const McScenarioModel& model, size_t num_scenarios,
+                  unsigned long seed, ScenarioSet& scenarios) {
+    size_t n_u = model.spot_vols.size();
+    if (n_u == 0 || model.vol_of_vols.size() != n_u ||
+        model.spot_correlation < 0.0 || model.spot_correlation > 1.0 ||
+        fabs(model.spot_vol_correlation) > 1.0) {
+        std::cerr << "Monte Carlo scenario model needs one vol of vol per underlying and valid correlations." << std::endl;
+        return false;
+    }
+
+    // Per scenario: a common spot factor, an idiosyncratic spot and vol
+    // normal for every underlying, and one rate normal
+    size_t per_scenario = 2 * n_u + 2;
+    std::vector<double> u(num_scenarios * per_scenario), z(u.size());
+    LinearCongruentialGenerator lcg(u.size(), seed);
+    lcg.get_uniform_draws(u);
+    StandardNormalDistribution snd;
+    snd.inv_cdf(u.data(), z.data(), u.size());
+
+    double sqrt_h = sqrt(model.horizon);
+    double a_common = sqrt(model.spot_correlation);
+    double a_idio = sqrt(1.0 - model.spot_correlation);
+    double a_vol = sqrt(1.0 - model.spot_vol_correlation * model.spot_vol_correlation);
+
+    scenarios = ScenarioSet(n_u);
+    scenarios.reserve(num_scenarios);
+    std::vector<double> spot_return(n_u), vol_shift(n_u);
+    for (size_t s=0; s<num_scenarios; s++) {
+        const double* zs = &z[s * per_scenario];
+        for (size_t u=0; u<n_u; u++) {
+            double z_spot = a_common * zs[0] + a_idio * zs[1 + u];
+            double z_vol = model.spot_vol_correlation * z_spot + a_vol * zs[1 + n_u + u];
+            double sigma = model.spot_vols[u];
+            spot_return[u] = exp(sigma * sqrt_h * z_spot - 0.5 * sigma * sigma * model.horizon) - 1.0;
+            vol_shift[u] = model.vol_of_vols[u] * sqrt_h * z_vol;
+        }
+        scenarios.add(spot_return.data(), vol_shift.data(), model.rate_vol * sqrt_h * zs[per_scenario - 1]);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef __SCENARIOS_H
+#define __SCENARIOS_H
+
+#include <cstddef>
+#include <vector>
+
+// Joint market moves applied to a portfolio: a relative spot return and an
+// absolute implied vol shift per underlying, plus a parallel shift of the
+// yield curve. Stored scenario-major so one scenario's shocks are adjacent.
+class ScenarioSet {
+private:
+    size_t underlyings;
+    std::vector<double> spot_returns;  // [scenario * underlyings + u]
+    std::vector<double> vol_shifts;    // [scenario * underlyings + u]
+    std::vector<double> rate_shifts;   // [scenario]
+
+public:
+    ScenarioSet(size_t _underlyings = 1) : underlyings(_underlyings) {}
+
+    void add(const double* spot_return, const double* vol_shift, double rate_shift);
+    void reserve(size_t n);
+    void clear();
+
+    size_t size() const { return rate_shifts.size(); }
+    size_t num_underlyings() const { return underlyings; }
+    const double* spot_returns_of(size_t s) const { return &spot_returns[s * underlyings]; }
+    const double* vol_shifts_of(size_t s) const { return &vol_shifts[s * underlyings]; }
+    double rate_shift(size_t s) const { return rate_shifts[s]; }
+};
+
+// Historical simulation from daily histories laid out as [day * underlyings + u]
+// (spots and implied vols) and [day] (rates). Each scenario is one
+// overlapping horizon_days change. Returns false if the histories disagree
+bool historical_scenarios(const std::vector<double>& spots, const std::vector<double>& vols,
+                          const std::vector<double>& rates, size_t num_underlyings,
+                          size_t horizon_days, ScenarioSet& scenarios);
+
+// Joint normal model for Monte Carlo scenarios over a horizon (in years).
+// Log spot returns share one correlation between underlyings; each vol
+// change is correlated with its own spot return
+struct McScenarioModel {
+    std::vector<double> spot_vols;  // Annualised vol of each underlying
+    std::vector<double> vol_of_vols;  // Annualised st. dev. of absolute vol changes
+    double spot_correlation;
+    double spot_vol_correlation;    // Typically negative for equity indices
+    double rate_vol;                // Annualised st. dev. of parallel rate changes
+    double horizon;
+};
+
+bool mc_scenarios(const McScenarioModel& model, size_t num_scenarios,
+                  unsigned long seed, ScenarioSet& scenarios);
+
+#endif
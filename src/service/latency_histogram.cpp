@@ -0,0 +1,97 @@
+#ifndef __LATENCY_HISTOGRAM_CPP
+#define __LATENCY_HISTOGRAM_CPP
+
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+// 8 significant bits: values below 2^8 exactly, then 2^7 buckets for each
+// of the 56 powers of two from 2^8 to 2^63 (shifts 1 to 56 in bucket_index)
+static const int HISTOGRAM_SUB_BITS = 7;
+static const size_t HISTOGRAM_SUB_BUCKETS = size_t(1) << HISTOGRAM_SUB_BITS;
+static const size_t HISTOGRAM_EXACT = 2 * HISTOGRAM_SUB_BUCKETS;
+static const size_t HISTOGRAM_BUCKETS = HISTOGRAM_EXACT + (64 - HISTOGRAM_SUB_BITS - 1) * HISTOGRAM_SUB_BUCKETS;
+
+LatencyHistogram::LatencyHistogram() : counts(HISTOGRAM_BUCKETS, 0) {
+    reset();
+}
+
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+    if (value < HISTOGRAM_EXACT) return static_cast<size_t>(value);
+    int shift = 63 - __builtin_clzll(value) - HISTOGRAM_SUB_BITS;  // >= 1
+    size_t mantissa = static_cast<size_t>(value >> shift);           // In [128, 256)
+    return HISTOGRAM_EXACT + (shift - 1) * HISTOGRAM_SUB_BUCKETS + (mantissa - HISTOGRAM_SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::bucket_upper(size_t index) {
+    if (index < HISTOGRAM_EXACT) return index;
+    size_t offset = index - HISTOGRAM_EXACT;
+    int shift = static_cast<int>(offset / HISTOGRAM_SUB_BUCKETS) + 1;
+    uint64_t mantissa = offset % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS;
+    // Wraps to UINT64_MAX for the last bucket, [255 << 56, 2^64)
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    counts[bucket_index(value)]++;
+    total++;
+    min_value = std::min(min_value, value);
+    max_value = std::max(max_value, value);
+    sum += static_cast<double>(value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) counts[i] += other.counts[i];
+    total += other.total;
+    min_value = std::min(min_value, other.min_value);
+    max_value = std::max(max_value, other.max_value);
+    sum += other.sum;
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    min_value = UINT64_MAX;
+    max_value = 0;
+    sum = 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(ceil(std::clamp(p, 0.0, 100.0) / 100.0 * total));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(bucket_upper(i), max_value);
+    }
+    return max_value;
+}
+
+void LatencyHistogram::print_header(std::ostream& out) {
+    out << std::left << std::setw(14) << "request" << std::right
+        << std::setw(10) << "count" << std::setw(10) << "mean us"
+        << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+        << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us"
+        << std::setw(10) << "max us" << std::endl;
+}
+
+void LatencyHistogram::print(std::ostream& out, const char* name) const {
+    auto us = [](double ns) { return ns * 1e-3; };
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::left << std::setw(14) << name << std::right
+        << std::setw(10) << total << std::fixed << std::setprecision(1)
+        << std::setw(10) << us(mean())
+        << std::setw(10) << us(percentile(50.0))
+        << std::setw(10) << us(percentile(90.0))
+        << std::setw(10) << us(percentile(99.0))
+        << std::setw(10) << us(percentile(99.9))
+        << std::setw(10) << us(max()) << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
+
+#endif
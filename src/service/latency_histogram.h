@@ -0,0 +1,47 @@
+#ifndef __LATENCY_HISTOGRAM_H
+#define __LATENCY_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+// Latency histogram in the style of HdrHistogram: values below 256 are
+// counted exactly, larger ones in log-linear buckets of 128 per power of two,
+// so every recorded value is known to within 0.8% over the full range of
+// uint64_t. Recording is an index computation and an increment; percentiles
+// walk the buckets. Not thread safe: keep one per thread and merge().
+class LatencyHistogram {
+private:
+    std::vector<uint64_t> counts;
+    uint64_t total;
+    uint64_t min_value;
+    uint64_t max_value;
+    double sum;
+
+    static size_t bucket_index(uint64_t value);
+    static uint64_t bucket_upper(size_t index);  // Largest value in the bucket
+
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? min_value : 0; }
+    uint64_t max() const { return max_value; }
+    double mean() const { return total ? sum / total : 0.0; }
+
+    // Smallest bucket bound at or below which p percent of the values lie,
+    // capped at max()
+    uint64_t percentile(double p) const;
+
+    // One line: count, mean and p50/p90/p99/p99.9/max, values in
+    // nanoseconds printed in microseconds
+    void print(std::ostream& out, const char* name) const;
+    static void print_header(std::ostream& out);
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef __PRICING_PROTOCOL_H
+#define __PRICING_PROTOCOL_H
+
+#include <cstdint>
+
+// Wire format of the pricing daemon (pricing_daemon.cpp). Client and daemon
+// run on the same host and talk over a Unix domain stream socket, so the
+// messages are fixed-size structs in host byte order with no framing beyond
+// their size. A client may pipeline any number of requests; responses carry
+// the request id and may come back in a different order, as requests of
+// different types are priced in different batches.
+
+enum PricingRequestType {
+    PRICING_PRICE = 1,        // value is sigma, result is the price
+    PRICING_IMPLIED_VOL = 2   // value is the price, result is sigma
+};
+
+const int NUM_PRICING_REQUEST_TYPES = 2;
+
+enum PricingStatus {
+    PRICING_OK = 0,
+    PRICING_INVALID_INPUT = 1,  // Non-positive S, K, T or sigma, or a price outside the bounds
+    PRICING_BAD_REQUEST = 2     // Unknown request type
+};
+
+struct PricingRequest {
+    uint32_t id;       // Chosen by the client, echoed in the response
+    uint8_t type;      // PricingRequestType
+    uint8_t is_call;
+    uint16_t reserved;
+    double S;
+    double K;
+    double r;
+    double T;
+    double value;
+};
+
+struct PricingResponse {
+    uint32_t id;
+    uint8_t type;
+    uint8_t status;    // PricingStatus
+    uint16_t reserved;
+    double result;     // NaN unless status is PRICING_OK
+};
+
+static_assert(sizeof(PricingRequest) == 48, "PricingRequest must have no padding");
+static_assert(sizeof(PricingResponse) == 16, "PricingResponse must have no padding");
+
+inline const char* pricing_request_name(int type) {
+    switch (type) {
+        case PRICING_PRICE: return "price";
+        case PRICING_IMPLIED_VOL: return "implied vol";
+        default: return "unknown";
+    }
+}
+
+#endif
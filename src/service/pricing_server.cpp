@@ -0,0 +1,331 @@
+#ifndef __PRICING_SERVER_CPP
+#define __PRICING_SERVER_CPP
+
+#include "pricing_server.h"
+#include "../option_pricing/vanilla/black_scholes.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Room for a good run of pipelined requests per read
+static const size_t PRICING_READ_BUFFER = 64 * 1024;
+
+// Most bytes read from one connection per pass of the event loop, so that a
+// client pipelining faster than it can be served does not starve the other
+// connections or the batch window
+static const size_t PRICING_READ_BUDGET = PRICING_READ_BUFFER;
+
+// Unsent responses past which a connection is not read until its client
+// catches up. Bounds the memory of a client that pipelines but never reads:
+// at most this plus the responses to one read budget and one batch
+static const size_t PRICING_OUT_HIGH_WATER = 256 * 1024;
+
+// Idle poll timeout, so that stop() is seen without a signal to wake the loop
+static const uint64_t PRICING_IDLE_POLL_NS = 100000000;
+
+static uint64_t pricing_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+PricingServer::PricingServer(const PricingServerOptions& _options)
+    : options(_options), listen_fd(-1), stopping(false), batch_deadline_ns(0), num_invalid(0) {
+    options.max_batch = std::max<size_t>(options.max_batch, 1);
+    pending.reserve(options.max_batch);
+}
+
+PricingServer::~PricingServer() {
+    for (Connection& conn : connections) close_connection(conn);
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+        unlink(options.socket_path.c_str());
+    }
+}
+
+bool PricingServer::start() {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (options.socket_path.empty() || options.socket_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path must be 1 to " << sizeof(addr.sun_path) - 1
+                  << " characters: " << options.socket_path << std::endl;
+        return false;
+    }
+    memcpy(addr.sun_path, options.socket_path.c_str(), options.socket_path.size());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "Unable to create socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+    // A socket file left by a daemon that did not shut down cleanly
+    unlink(options.socket_path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        std::cerr << "Unable to bind " << options.socket_path << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    if (listen(fd, SOMAXCONN) != 0) {
+        std::cerr << "Unable to listen on " << options.socket_path << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        unlink(options.socket_path.c_str());
+        return false;
+    }
+    listen_fd = fd;
+    return true;
+}
+
+void PricingServer::run() {
+    std::vector<pollfd> fds;
+    std::vector<size_t> polled;  // Connection of fds[i + 1]
+
+    while (listen_fd >= 0 && !stopping.load(std::memory_order_relaxed)) {
+        fds.clear();
+        polled.clear();
+        fds.push_back({listen_fd, POLLIN, 0});
+        for (size_t c = 0; c < connections.size(); c++) {
+            const Connection& conn = connections[c];
+            if (conn.fd < 0) continue;
+            short events = conn.unsent() < PRICING_OUT_HIGH_WATER ? POLLIN : 0;
+            if (conn.unsent() > 0) events |= POLLOUT;
+            fds.push_back({conn.fd, events, 0});
+            polled.push_back(c);
+        }
+
+        uint64_t now = pricing_now_ns();
+        uint64_t wait = PRICING_IDLE_POLL_NS;
+        if (!pending.empty()) wait = batch_deadline_ns > now ? batch_deadline_ns - now : 0;
+        timespec timeout;
+        timeout.tv_sec = static_cast<time_t>(wait / 1000000000);
+        timeout.tv_nsec = static_cast<long>(wait % 1000000000);
+
+        if (ppoll(fds.data(), fds.size(), &timeout, nullptr) < 0 && errno != EINTR) {
+            std::cerr << "Pricing server poll failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        now = pricing_now_ns();
+        if (fds[0].revents & POLLIN) accept_connections();
+        for (size_t i = 0; i < polled.size(); i++) {
+            short revents = fds[i + 1].revents;
+            Connection& conn = connections[polled[i]];
+            if ((revents & POLLOUT) && !flush(conn)) continue;
+            if ((revents & (POLLHUP | POLLERR)) && conn.unsent() >= PRICING_OUT_HIGH_WATER) {
+                // Not being read, so the hang-up would be reported forever
+                close_connection(conn);
+                continue;
+            }
+            if (revents & (POLLIN | POLLHUP | POLLERR)) read_requests(polled[i], now);
+        }
+
+        if (!pending.empty() && (options.batch_window_ns == 0 || pricing_now_ns() >= batch_deadline_ns)) {
+            price_batch();
+        }
+        for (Connection& conn : connections) {
+            if (conn.fd >= 0 && conn.out_sent < conn.out.size()) flush(conn);
+        }
+        // Pending requests refer to connections by index
+        if (pending.empty()) compact_connections();
+    }
+}
+
+void PricingServer::accept_connections() {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "Pricing server accept failed: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+        Connection conn;
+        conn.fd = fd;
+        conn.in.resize(PRICING_READ_BUFFER);
+        conn.in_used = 0;
+        conn.out_sent = 0;
+        connections.push_back(std::move(conn));
+    }
+}
+
+void PricingServer::read_requests(size_t c, uint64_t now) {
+    size_t budget = PRICING_READ_BUDGET;
+    while (connections[c].fd >= 0 && budget > 0 && connections[c].unsent() < PRICING_OUT_HIGH_WATER) {
+        Connection& conn = connections[c];
+        size_t room = std::min(conn.in.size() - conn.in_used, budget);
+        ssize_t n = read(conn.fd, conn.in.data() + conn.in_used, room);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (n <= 0) {
+            // The client has gone, and with it any responses still owed
+            close_connection(conn);
+            return;
+        }
+        conn.in_used += static_cast<size_t>(n);
+        budget -= static_cast<size_t>(n);
+
+        size_t offset = 0;
+        PricingRequest request;
+        while (conn.in_used - offset >= sizeof(PricingRequest)) {
+            memcpy(&request, conn.in.data() + offset, sizeof(PricingRequest));
+            offset += sizeof(PricingRequest);
+            // May price a full batch, which leaves conn and the buffer untouched
+            queue_request(request, c, now);
+        }
+        conn.in_used -= offset;
+        if (offset > 0 && conn.in_used > 0) memmove(conn.in.data(), conn.in.data() + offset, conn.in_used);
+    }
+}
+
+void PricingServer::queue_request(const PricingRequest& request, size_t c, uint64_t now) {
+    if (request.type != PRICING_PRICE && request.type != PRICING_IMPLIED_VOL) {
+        respond({request, c, now}, PRICING_BAD_REQUEST, std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+    if (pending.empty()) batch_deadline_ns = now + options.batch_window_ns;
+    pending.push_back({request, c, now});
+    if (pending.size() >= options.max_batch) price_batch();
+}
+
+void PricingServer::respond(const PendingRequest& p, uint8_t status, double value) {
+    Connection& conn = connections[p.connection];
+    if (conn.fd < 0) return;
+    PricingResponse response;
+    response.id = p.request.id;
+    response.type = p.request.type;
+    response.status = status;
+    response.reserved = 0;
+    response.result = status == PRICING_OK ? value : std::numeric_limits<double>::quiet_NaN();
+    const char* bytes = reinterpret_cast<const char*>(&response);
+    conn.out.insert(conn.out.end(), bytes, bytes + sizeof(response));
+}
+
+void PricingServer::price_batch() {
+    batch_sizes.record(pending.size());
+    price_type(PRICING_PRICE);
+    price_type(PRICING_IMPLIED_VOL);
+    pending.clear();
+}
+
+// Gathers the pending requests of one type into columns and prices them with
+// one call to the batch kernel
+void PricingServer::price_type(int type) {
+    batch_index.clear();
+    phi.clear();
+    S.clear();
+    K.clear();
+    r.clear();
+    T.clear();
+    value.clear();
+    for (size_t i = 0; i < pending.size(); i++) {
+        const PricingRequest& q = pending[i].request;
+        if (q.type != type) continue;
+        bool valid = std::isfinite(q.S) && std::isfinite(q.K) && std::isfinite(q.r)
+                  && std::isfinite(q.T) && std::isfinite(q.value)
+                  && q.S > 0.0 && q.K > 0.0 && q.T > 0.0
+                  && (type != PRICING_PRICE || q.value > 0.0);
+        if (!valid) {
+            num_invalid++;
+            respond(pending[i], PRICING_INVALID_INPUT, 0.0);
+            continue;
+        }
+        batch_index.push_back(i);
+        phi.push_back(q.is_call ? 1.0 : -1.0);
+        S.push_back(q.S);
+        K.push_back(q.K);
+        r.push_back(q.r);
+        T.push_back(q.T);
+        value.push_back(q.value);
+    }
+
+    size_t n = batch_index.size();
+    if (n > 0) {
+        result.resize(n);
+        if (type == PRICING_PRICE) {
+            calc_black_scholes_prices(phi.data(), S.data(), K.data(), r.data(), T.data(),
+                                      value.data(), result.data(), n);
+        } else {
+            calc_implied_vols(phi.data(), value.data(), S.data(), K.data(), r.data(), T.data(),
+                              result.data(), n);
+        }
+        for (size_t k = 0; k < n; k++) {
+            const PendingRequest& p = pending[batch_index[k]];
+            bool ok = std::isfinite(result[k]);
+            if (!ok) num_invalid++;
+            respond(p, ok ? PRICING_OK : PRICING_INVALID_INPUT, result[k]);
+        }
+    }
+
+    // Invalid requests count too: their response waited for the batch
+    uint64_t now = pricing_now_ns();
+    LatencyHistogram& histogram = latency[type - 1];
+    for (const PendingRequest& p : pending) {
+        if (p.request.type == type) histogram.record(now - p.received_ns);
+    }
+}
+
+// False if the connection had to be closed
+bool PricingServer::flush(Connection& conn) {
+    while (conn.out_sent < conn.out.size()) {
+        ssize_t n = send(conn.fd, conn.out.data() + conn.out_sent, conn.out.size() - conn.out_sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Resumed on POLLOUT. Drop the sent part once it is most of the
+            // buffer, or a client that never quite catches up grows it
+            if (conn.out_sent > conn.out.size() / 2) {
+                conn.out.erase(conn.out.begin(), conn.out.begin() + conn.out_sent);
+                conn.out_sent = 0;
+            }
+            return true;
+        }
+        if (n < 0) {
+            close_connection(conn);
+            return false;
+        }
+        conn.out_sent += static_cast<size_t>(n);
+    }
+    conn.out.clear();
+    conn.out_sent = 0;
+    return true;
+}
+
+void PricingServer::close_connection(Connection& conn) {
+    if (conn.fd < 0) return;
+    ::close(conn.fd);
+    conn.fd = -1;
+    conn.out.clear();
+    conn.out_sent = 0;
+    conn.in_used = 0;
+}
+
+void PricingServer::compact_connections() {
+    connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                     [](const Connection& conn) { return conn.fd < 0; }),
+                      connections.end());
+}
+
+void PricingServer::report(std::ostream& out) const {
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << "Batches: " << batch_sizes.count() << ", size mean " << std::fixed << std::setprecision(1)
+        << batch_sizes.mean() << ", p50 " << batch_sizes.percentile(50.0)
+        << ", p99 " << batch_sizes.percentile(99.0) << ", max " << batch_sizes.max() << std::endl;
+    out << "Invalid requests: " << num_invalid << std::endl;
+    out.flags(flags);
+    out.precision(precision);
+    LatencyHistogram::print_header(out);
+    for (int type = 1; type <= NUM_PRICING_REQUEST_TYPES; type++) {
+        latency[type - 1].print(out, pricing_request_name(type));
+    }
+}
+
+#endif
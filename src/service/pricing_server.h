@@ -0,0 +1,102 @@
+#ifndef __PRICING_SERVER_H
+#define __PRICING_SERVER_H
+
+#include "latency_histogram.h"
+#include "pricing_protocol.h"
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct PricingServerOptions {
+    std::string socket_path;
+    // Longest the first request of a batch waits for others to join it.
+    // With 0 a batch is whatever arrived in one pass of the event loop
+    uint64_t batch_window_ns;
+    // A batch is priced as soon as it has this many requests
+    size_t max_batch;
+
+    PricingServerOptions()
+        : socket_path("/tmp/qf_pricing.sock"), batch_window_ns(50000), max_batch(256) {}
+};
+
+// Pricing daemon on a Unix domain socket (protocol in pricing_protocol.h).
+//
+// A single thread runs a poll loop over all connections. Requests from every
+// connection are gathered into one micro-batch, which is priced when it
+// reaches max_batch or when its first request has waited batch_window_ns.
+// Pricing splits the batch by request type into columns and makes one call
+// to calc_black_scholes_prices or calc_implied_vols per type, so concurrent
+// clients share the SIMD kernels. Latency is measured per request type from
+// the read of a request to its response being queued on the socket.
+//
+// Each connection is read for a bounded number of bytes per pass of the
+// loop, and not at all while too many of its responses are unsent, so a
+// client that pipelines without reading neither starves the others nor
+// makes the daemon buffer without limit.
+class PricingServer {
+private:
+    struct Connection {
+        int fd;                  // -1 once closed
+        std::vector<char> in;    // Partial request carried between reads
+        size_t in_used;
+        std::vector<char> out;   // Responses not yet accepted by the socket
+        size_t out_sent;
+
+        size_t unsent() const { return out.size() - out_sent; }
+    };
+
+    struct PendingRequest {
+        PricingRequest request;
+        size_t connection;
+        uint64_t received_ns;
+    };
+
+    PricingServerOptions options;
+    int listen_fd;
+    std::atomic<bool> stopping;
+    std::vector<Connection> connections;
+    std::vector<PendingRequest> pending;
+    uint64_t batch_deadline_ns;
+
+    // Batch columns, reused from batch to batch
+    std::vector<size_t> batch_index;
+    std::vector<double> phi, S, K, r, T, value, result;
+
+    LatencyHistogram latency[NUM_PRICING_REQUEST_TYPES];
+    LatencyHistogram batch_sizes;
+    uint64_t num_invalid;
+
+    void accept_connections();
+    void read_requests(size_t c, uint64_t now);
+    void queue_request(const PricingRequest& request, size_t c, uint64_t now);
+    void respond(const PendingRequest& p, uint8_t status, double value);
+    void price_batch();
+    void price_type(int type);
+    bool flush(Connection& conn);
+    void close_connection(Connection& conn);
+    void compact_connections();
+
+public:
+    PricingServer(const PricingServerOptions& _options);
+    ~PricingServer();
+
+    PricingServer(const PricingServer&) = delete;
+    PricingServer& operator=(const PricingServer&) = delete;
+
+    // Binds and listens on the socket, replacing a stale socket file.
+    // Returns false, with the reason on cerr, if that fails
+    bool start();
+
+    // Serves until stop() is called
+    void run();
+
+    // Safe to call from a signal handler or another thread
+    void stop() { stopping.store(true, std::memory_order_relaxed); }
+
+    // Request counts, batch sizes and latency percentiles per request type
+    void report(std::ostream& out) const;
+};
+
+#endif
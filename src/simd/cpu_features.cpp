@@ -0,0 +1,69 @@
+#ifndef __CPU_FEATURES_CPP
+#define __CPU_FEATURES_CPP
+
+#include "cpu_features.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+static const char* SIMD_ISA_NAMES[NUM_SIMD_ISAS] = {"scalar", "neon", "avx2", "avx512"};
+
+#if defined(__x86_64__) || defined(__i386__)
+// Extended control register 0, the register state enabled by the OS
+static unsigned long long read_xcr0() {
+    unsigned int lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<unsigned long long>(hi) << 32) | lo;
+}
+#endif
+
+static CpuFeatures detect_cpu_features() {
+    CpuFeatures f = {false, false, false, false, false};
+
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return f;
+    bool osxsave = ecx & (1u << 27);
+    bool avx = ecx & (1u << 28);
+    bool fma = ecx & (1u << 12);
+    if (!osxsave || !avx) return f;
+
+    unsigned long long xcr0 = read_xcr0();
+    bool ymm_state = (xcr0 & 0x6) == 0x6;     // SSE and AVX state
+    bool zmm_state = (xcr0 & 0xe6) == 0xe6;   // Plus opmask and both ZMM halves
+    if (!ymm_state) return f;
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return f;
+    f.fma = fma;
+    f.avx2 = ebx & (1u << 5);
+    f.avx512f = zmm_state && (ebx & (1u << 16));
+    f.avx512dq = zmm_state && (ebx & (1u << 17));
+#elif defined(__aarch64__)
+    f.neon = true;  // Advanced SIMD is part of the AArch64 baseline
+#endif
+
+    return f;
+}
+
+const CpuFeatures& cpu_features() {
+    static const CpuFeatures features = detect_cpu_features();
+    return features;
+}
+
+bool cpu_supports(SimdIsa isa) {
+    const CpuFeatures& f = cpu_features();
+    switch (isa) {
+        case SIMD_SCALAR: return true;
+        case SIMD_NEON: return f.neon;
+        case SIMD_AVX2: return f.avx2 && f.fma;
+        case SIMD_AVX512: return f.avx2 && f.fma && f.avx512f && f.avx512dq;
+        default: return false;
+    }
+}
+
+const char* simd_isa_name(SimdIsa isa) {
+    return (isa >= 0 && isa < NUM_SIMD_ISAS) ? SIMD_ISA_NAMES[isa] : "unknown";
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef __CPU_FEATURES_H
+#define __CPU_FEATURES_H
+
+// Instruction sets the batch kernels are built for, in order of preference
+// within each architecture
+enum SimdIsa {
+    SIMD_SCALAR,  // Baseline build of the target (SSE2 on x86-64), libm maths
+    SIMD_NEON,    // AArch64 Advanced SIMD
+    SIMD_AVX2,    // AVX2 + FMA
+    SIMD_AVX512,  // AVX-512 F + DQ
+    NUM_SIMD_ISAS
+};
+
+// Features of the running CPU. On x86 they come from cpuid, and the AVX
+// families also require the OS to save the wider registers (xgetbv)
+struct CpuFeatures {
+    bool avx2;
+    bool fma;
+    bool avx512f;
+    bool avx512dq;
+    bool neon;
+};
+
+// Detected once, on first use
+const CpuFeatures& cpu_features();
+
+bool cpu_supports(SimdIsa isa);
+const char* simd_isa_name(SimdIsa isa);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef __SIMD_KERNELS_CPP
+#define __SIMD_KERNELS_CPP
+
+#include "simd_kernels.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static const SimdKernels* SIMD_TABLES[NUM_SIMD_ISAS] = {
+    &SIMD_KERNELS_SCALAR, &SIMD_KERNELS_NEON, &SIMD_KERNELS_AVX2, &SIMD_KERNELS_AVX512
+};
+
+const SimdKernels* simd_kernels_for(SimdIsa isa) {
+    if (isa < 0 || isa >= NUM_SIMD_ISAS) return nullptr;
+    const SimdKernels* k = SIMD_TABLES[isa];
+    if (!k->black_scholes_prices || !cpu_supports(isa)) return nullptr;
+    return k;
+}
+
+static const SimdKernels* select_simd_kernels() {
+    const SimdKernels* best = &SIMD_KERNELS_SCALAR;
+    for (int isa = 0; isa < NUM_SIMD_ISAS; isa++) {
+        const SimdKernels* k = simd_kernels_for(SimdIsa(isa));
+        if (k) best = k;
+    }
+
+    const char* requested = getenv("QF_SIMD");
+    if (!requested || !*requested) return best;
+    for (int isa = 0; isa < NUM_SIMD_ISAS; isa++) {
+        if (strcmp(requested, simd_isa_name(SimdIsa(isa))) != 0) continue;
+        const SimdKernels* k = simd_kernels_for(SimdIsa(isa));
+        if (k) return k;
+        std::cerr << "QF_SIMD=" << requested << " is not available on this CPU, using "
+                  << simd_isa_name(best->isa) << "." << std::endl;
+        return best;
+    }
+    std::cerr << "Unknown QF_SIMD=" << requested << ", using " << simd_isa_name(best->isa) << "." << std::endl;
+    return best;
+}
+
+const SimdKernels& simd_kernels() {
+    static const SimdKernels* selected = select_simd_kernels();
+    return *selected;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef __SIMD_KERNELS_H
+#define __SIMD_KERNELS_H
+
+#include <cstddef>
+#include "cpu_features.h"
+
+// Batch kernels built once per instruction set. Each variant is the same
+// source (simd_kernels_impl.h) compiled with its own target flags, so one
+// binary carries all of them and simd_kernels() picks the best one the CPU
+// supports the first time it is called.
+//
+// The variants agree to a few ulps, not bit for bit: the scalar variant uses
+// libm, the vector variants use inline polynomial exp/log/sin/cos that the
+// compiler can vectorise.
+struct SimdKernels {
+    SimdIsa isa;
+
+    // Black-Scholes prices, as calc_black_scholes_prices()
+    void (*black_scholes_prices)(const double* phi, const double* S, const double* K,
+                                 const double* r, const double* T, const double* sigma,
+                                 double* price, size_t n);
+
+    // p[i] = N(x[i]) by Abramowitz & Stegun 26.2.17, as N()
+    void (*normal_cdf)(const double* x, double* p, size_t n);
+
+    // z[i] = inverse normal CDF of u[i] in (0,1)
+    void (*inv_cdf_acklam)(const double* u, double* z, size_t n);
+    void (*inv_cdf_as241)(const double* u, double* z, size_t n);
+
+    // One geometric Brownian motion step for n paths in lockstep:
+    // S_out[i] = S_in[i] * drift * exp(vol * z[i]). S_out may be S_in
+    void (*gbm_step)(const double* S_in, const double* z, double* S_out, size_t n,
+                     double drift, double vol);
+
+    // Box-Muller on pairs, n even: z[2i] = R sin(2 pi u[2i+1]) and
+    // z[2i+1] = R cos(2 pi u[2i+1]), with R = sqrt(-2 log u[2i])
+    void (*box_muller)(const double* u, double* z, size_t n);
+
+    // Single-precision instances of the Black-Scholes, normal CDF and GBM
+    // step kernels, for screening where float accuracy is enough. Twice the
+    // lanes of the double kernels per vector
+    void (*black_scholes_prices_f32)(const float* phi, const float* S, const float* K,
+                                     const float* r, const float* T, const float* sigma,
+                                     float* price, size_t n);
+    void (*normal_cdf_f32)(const float* x, float* p, size_t n);
+    void (*gbm_step_f32)(const float* S_in, const float* z, float* S_out, size_t n,
+                         float drift, float vol);
+};
+
+// One table per variant. A variant that is not built for the target
+// architecture has null kernels
+extern const SimdKernels SIMD_KERNELS_SCALAR;
+extern const SimdKernels SIMD_KERNELS_NEON;
+extern const SimdKernels SIMD_KERNELS_AVX2;
+extern const SimdKernels SIMD_KERNELS_AVX512;
+
+// The variant used by the library. The best one the CPU supports, unless the
+// QF_SIMD environment variable (scalar, neon, avx2 or avx512) names another
+// usable one
+const SimdKernels& simd_kernels();
+
+// The variant for isa, or nullptr if it was not built or this CPU lacks it
+const SimdKernels* simd_kernels_for(SimdIsa isa);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef __SIMD_KERNELS_AVX2_CPP
+#define __SIMD_KERNELS_AVX2_CPP
+
+// AVX2 + FMA variant (make passes -mavx2 -mfma for this file only).
+// Nothing in this file runs unless cpuid reports the instruction set
+#include "simd_kernels.h"
+
+#if defined(__x86_64__) && defined(__AVX2__)
+#include "simd_kernels_impl.h"
+const SimdKernels SIMD_KERNELS_AVX2 = SIMD_KERNELS_TABLE(SIMD_AVX2);
+#else
+const SimdKernels SIMD_KERNELS_AVX2 = { SIMD_AVX2, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                        nullptr, nullptr, nullptr };
+#endif
+
+#endif
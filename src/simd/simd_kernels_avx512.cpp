@@ -0,0 +1,16 @@
+#ifndef __SIMD_KERNELS_AVX512_CPP
+#define __SIMD_KERNELS_AVX512_CPP
+
+// AVX-512 variant (make passes -mavx512f -mavx512dq for this file only).
+// Nothing in this file runs unless cpuid reports the instruction set
+#include "simd_kernels.h"
+
+#if defined(__x86_64__) && defined(__AVX512F__)
+#include "simd_kernels_impl.h"
+const SimdKernels SIMD_KERNELS_AVX512 = SIMD_KERNELS_TABLE(SIMD_AVX512);
+#else
+const SimdKernels SIMD_KERNELS_AVX512 = { SIMD_AVX512, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                          nullptr, nullptr, nullptr };
+#endif
+
+#endif
@@ -0,0 +1,338 @@
+#ifndef __SIMD_KERNELS_IMPL_H
+#define __SIMD_KERNELS_IMPL_H
+
+// Kernel bodies shared by every variant. Each simd_kernels_<isa>.cpp includes
+// this once and is compiled with its own target flags; the loops are written
+// so the compiler can vectorise them for that target.
+//
+// Everything here is static. A non-static inline function (including any
+// std:: template such as std::min) would be emitted by several variants and
+// the linker would keep one of them, possibly the AVX-512 build, which would
+// then also run on CPUs without AVX-512.
+//
+// Defining SIMD_KERNELS_LIBM before the include gives the scalar variant,
+// which calls libm. Otherwise exp, log, sin and cos are the inline
+// polynomials below, valid for finite arguments (log and Box-Muller need
+// positive normal inputs) and accurate to a few ulps.
+//
+// The Black-Scholes, normal CDF and GBM step kernels are templates on the
+// floating-point type. The float instances have their own exp and log, with
+// shorter polynomials, and fill twice as many lanes per vector. The double
+// instances are the same expressions as before templating, operation for
+// operation, so their results have not changed.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+static const double SIMD_SHIFT = 6755399441055744.0;  // 1.5 * 2^52, rounds to integer when added
+static const float SIMD_SHIFT_F32 = 12582912.0f;      // 1.5 * 2^23
+
+static inline uint64_t simd_bits(double x) {
+    uint64_t b;
+    memcpy(&b, &x, sizeof(b));
+    return b;
+}
+
+static inline double simd_from_bits(uint64_t b) {
+    double x;
+    memcpy(&x, &b, sizeof(x));
+    return x;
+}
+
+static inline uint32_t simd_bits_f32(float x) {
+    uint32_t b;
+    memcpy(&b, &x, sizeof(b));
+    return b;
+}
+
+static inline float simd_from_bits_f32(uint32_t b) {
+    float x;
+    memcpy(&x, &b, sizeof(x));
+    return x;
+}
+
+static inline double simd_min(double a, double b) { return a < b ? a : b; }
+
+// Overloads, so the templates below pick the float or double operation
+static inline double simd_abs(double x) { return fabs(x); }
+static inline float simd_abs(float x) { return fabsf(x); }
+static inline double simd_sqrt(double x) { return sqrt(x); }
+static inline float simd_sqrt(float x) { return sqrtf(x); }
+
+#ifdef SIMD_KERNELS_LIBM
+
+static inline double kernel_exp(double x) { return exp(x); }
+static inline double kernel_log(double x) { return log(x); }
+static inline float kernel_exp(float x) { return expf(x); }
+static inline float kernel_log(float x) { return logf(x); }
+
+static inline void kernel_sincos_2pi(double u, double* s, double* c) {
+    *s = sin(2 * M_PI * u);
+    *c = cos(2 * M_PI * u);
+}
+
+#else
+
+// exp(x) = 2^k exp(r) with |r| <= ln(2)/2, exp(r) by its Taylor series to
+// r^13. x is clamped to [-708, 709] so 2^k stays a normal number; there are
+// no denormal or infinite results
+static inline double kernel_exp(double x) {
+    const double log2e = 1.4426950408889634074;
+    const double ln2_hi = 6.93147180369123816490e-01;  // Low bits zero, so k * ln2_hi is exact
+    const double ln2_lo = 1.90821492927058770002e-10;
+    x = x < -708.0 ? -708.0 : x;
+    x = x > 709.0 ? 709.0 : x;
+
+    double t = x * log2e + SIMD_SHIFT;
+    double k = t - SIMD_SHIFT;
+    double r = (x - k * ln2_hi) - k * ln2_lo;
+    double p = 1.0 + r*(1.0 + r*(1.0/2 + r*(1.0/6 + r*(1.0/24 + r*(1.0/120 + r*(1.0/720 + r*(1.0/5040
+             + r*(1.0/40320 + r*(1.0/362880 + r*(1.0/3628800 + r*(1.0/39916800 + r*(1.0/479001600
+             + r*(1.0/6227020800.0)))))))))))));
+
+    // The low bits of t hold k; add it to the exponent of p
+    uint64_t k_bits = simd_bits(t) - simd_bits(SIMD_SHIFT);
+    return simd_from_bits(simd_bits(p) + (k_bits << 52));
+}
+
+// log(x) = e ln(2) + log(m) with m in [sqrt(1/2), sqrt(2)), and
+// log(m) = 2 atanh(s), s = (m - 1)/(m + 1), by its series to s^21
+static inline double kernel_log(double x) {
+    const double ln2_hi = 6.93147180369123816490e-01;
+    const double ln2_lo = 1.90821492927058770002e-10;
+    uint64_t b = simd_bits(x);
+
+    // Exponent converted through the bit pattern of 2^52 + e, as there is no
+    // packed 64-bit integer to double conversion before AVX-512
+    double e = simd_from_bits(0x4330000000000000ULL | (b >> 52)) - 4503599627370496.0 - 1023.0;
+    double m = simd_from_bits((b & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL);
+    bool high = m > M_SQRT2;
+    m = high ? 0.5 * m : m;
+    e = high ? e + 1.0 : e;
+
+    double f = m - 1.0;
+    double s = f / (2.0 + f);
+    double s2 = s * s;
+    double series = s2*(2.0/3 + s2*(2.0/5 + s2*(2.0/7 + s2*(2.0/9 + s2*(2.0/11 + s2*(2.0/13
+                  + s2*(2.0/15 + s2*(2.0/17 + s2*(2.0/19 + s2*(2.0/21))))))))));
+    return e * ln2_hi + ((2.0 * s + s * series) + e * ln2_lo);
+}
+
+// Single precision: the same reductions, with Cephes' split of ln(2) and
+// polynomials cut to float accuracy (Taylor to r^7 for |r| <= ln(2)/2, the
+// atanh series to s^11). x is clamped to [-87, 88]
+static inline float kernel_exp(float x) {
+    const float log2e = 1.44269504f;
+    const float ln2_hi = 0.693359375f;  // 9 significant bits, so k * ln2_hi is exact
+    const float ln2_lo = -2.12194440e-4f;
+    x = x < -87.0f ? -87.0f : x;
+    x = x > 88.0f ? 88.0f : x;
+
+    float t = x * log2e + SIMD_SHIFT_F32;
+    float k = t - SIMD_SHIFT_F32;
+    float r = (x - k * ln2_hi) - k * ln2_lo;
+    float p = 1.0f + r*(1.0f + r*(1.0f/2 + r*(1.0f/6 + r*(1.0f/24 + r*(1.0f/120 + r*(1.0f/720
+            + r*(1.0f/5040)))))));
+
+    uint32_t k_bits = simd_bits_f32(t) - simd_bits_f32(SIMD_SHIFT_F32);
+    return simd_from_bits_f32(simd_bits_f32(p) + (k_bits << 23));
+}
+
+static inline float kernel_log(float x) {
+    const float ln2_hi = 0.693359375f;
+    const float ln2_lo = -2.12194440e-4f;
+    uint32_t b = simd_bits_f32(x);
+
+    // Packed 32-bit integer to float conversion exists on every target
+    float e = static_cast<float>(static_cast<int32_t>(b >> 23)) - 127.0f;
+    float m = simd_from_bits_f32((b & 0x007FFFFFu) | 0x3F800000u);
+    bool high = m > static_cast<float>(M_SQRT2);
+    m = high ? 0.5f * m : m;
+    e = high ? e + 1.0f : e;
+
+    float f = m - 1.0f;
+    float s = f / (2.0f + f);
+    float s2 = s * s;
+    float series = s2*(2.0f/3 + s2*(2.0f/5 + s2*(2.0f/7 + s2*(2.0f/9 + s2*(2.0f/11)))));
+    return e * ln2_hi + ((2.0f * s + s * series) + e * ln2_lo);
+}
+
+// sin and cos of 2 pi u. The reduction to |a| <= pi/4 is exact because it
+// works on u rather than on the angle; the polynomials are Cephes' sin/cos
+static inline void kernel_sincos_2pi(double u, double* s, double* c) {
+    double q = (u * 4.0 + SIMD_SHIFT) - SIMD_SHIFT;  // Nearest quarter turn
+    double a = (u - 0.25 * q) * (2.0 * M_PI);
+    double a2 = a * a;
+    double sin_a = a + a * a2 * (((((1.58962301576546568060e-10 * a2 - 2.50507477628578072866e-8) * a2
+                 + 2.75573136213857245213e-6) * a2 - 1.98412698295895385996e-4) * a2
+                 + 8.33333333332211858878e-3) * a2 - 1.66666666666666307295e-1);
+    double cos_a = 1.0 - 0.5 * a2 + a2 * a2 * (((((-1.13585365213876817300e-11 * a2 + 2.08757008419747316778e-9) * a2
+                 - 2.75573141792967388112e-7) * a2 + 2.48015872888517045348e-5) * a2
+                 - 1.38888888888730564116e-3) * a2 + 4.16666666666665929218e-2);
+
+    double quadrant = q - 4.0 * floor(q * 0.25);
+    bool swap = quadrant == 1.0 || quadrant == 3.0;
+    double sin_v = swap ? cos_a : sin_a;
+    double cos_v = swap ? sin_a : cos_a;
+    *s = quadrant >= 2.0 ? -sin_v : sin_v;
+    *c = (quadrant == 1.0 || quadrant == 2.0) ? -cos_v : cos_v;
+}
+
+#endif
+
+// The Abramowitz & Stegun approximation used by N(), with the reflection for
+// negative arguments done by a select rather than recursion
+template<typename Real>
+static inline Real kernel_normal_cdf(Real x) {
+    Real a = simd_abs(x);
+    Real k = Real(1.0)/(Real(1.0) + Real(0.2316419)*a);
+    Real k_sum = k*(Real(0.319381530) + k*(Real(-0.356563782) + k*(Real(1.781477937)
+               + k*(Real(-1.821255978) + Real(1.330274429)*k))));
+    Real tail = kernel_exp(Real(-0.5)*a*a) / simd_sqrt(Real(2.0 * M_PI)) * k_sum;
+    return (x >= Real(0.0)) ? Real(1.0) - tail : tail;
+}
+
+template<typename Real>
+static void black_scholes_prices_kernel(const Real* phi, const Real* S, const Real* K,
+                                        const Real* r, const Real* T, const Real* sigma,
+                                        Real* price, size_t n) {
+    for (size_t i=0; i<n; i++) {
+        Real sigma_sqrt_T = sigma[i] * simd_sqrt(T[i]);
+        Real d_1 = (kernel_log(S[i]/K[i]) + (r[i] + sigma[i] * sigma[i] * Real(0.5)) * T[i]) / sigma_sqrt_T;
+        Real d_2 = d_1 - sigma_sqrt_T;
+        Real df_K = K[i] * kernel_exp(-r[i] * T[i]);
+        price[i] = phi[i] * (S[i] * kernel_normal_cdf(phi[i] * d_1) - df_K * kernel_normal_cdf(phi[i] * d_2));
+    }
+}
+
+template<typename Real>
+static void normal_cdf_kernel(const Real* x, Real* p, size_t n) {
+    for (size_t i=0; i<n; i++) p[i] = kernel_normal_cdf(x[i]);
+}
+
+// Both inverse CDF kernels work through the input in cache-sized blocks. The
+// central rational approximation is evaluated for every element of a block
+// in a branch-free loop, then the comparatively rare tail elements are
+// patched up in a second pass. The lower and upper tails share one code path
+// via symmetry.
+static const size_t INV_CDF_BLOCK = 256;
+
+// Acklam's algorithm. The central region covers [0.02425, 0.97575]
+static void inv_cdf_acklam_kernel(const double* u, double* z, size_t n) {
+    const double a1 = -3.969683028665376e+01, a2 =  2.209460984245205e+02,
+                 a3 = -2.759285104469687e+02, a4 =  1.383577518672690e+02,
+                 a5 = -3.066479806614716e+01, a6 =  2.506628277459239e+00;
+    const double b1 = -5.447609879822406e+01, b2 =  1.615858368580409e+02,
+                 b3 = -1.556989798598866e+02, b4 =  6.680131188771972e+01,
+                 b5 = -1.328068155288572e+01;
+    const double c1 = -7.784894002430293e-03, c2 = -3.223964580411365e-01,
+                 c3 = -2.400758277161838e+00, c4 = -2.549732539343734e+00,
+                 c5 =  4.374664141464968e+00, c6 =  2.938163982698783e+00;
+    const double d1 =  7.784695709041462e-03, d2 =  3.224671290700398e-01,
+                 d3 =  2.445134137142996e+00, d4 =  3.754408661907416e+00;
+    const double p_low = 0.02425;
+
+    for (size_t start=0; start<n; start+=INV_CDF_BLOCK) {
+        size_t end = n < start + INV_CDF_BLOCK ? n : start + INV_CDF_BLOCK;
+
+        for (size_t i=start; i<end; i++) {
+            double q = u[i] - 0.5;
+            double r = q*q;
+            z[i] = (((((a1*r + a2)*r + a3)*r + a4)*r + a5)*r + a6)*q /
+                   (((((b1*r + b2)*r + b3)*r + b4)*r + b5)*r + 1.0);
+        }
+
+        for (size_t i=start; i<end; i++) {
+            double p = simd_min(u[i], 1.0 - u[i]);
+            if (p < p_low) {
+                double q = sqrt(-2.0*kernel_log(p));
+                double x = (((((c1*q + c2)*q + c3)*q + c4)*q + c5)*q + c6) /
+                           ((((d1*q + d2)*q + d3)*q + d4)*q + 1.0);
+                z[i] = copysign(x, u[i] - 0.5);
+            }
+        }
+    }
+}
+
+// Wichura's AS241 (PPND16). The central region covers |u - 0.5| <= 0.425
+static void inv_cdf_as241_kernel(const double* u, double* z, size_t n) {
+    const double a0 = 3.3871328727963666080e+00, a1 = 1.3314166789178437745e+02,
+                 a2 = 1.9715909503065514427e+03, a3 = 1.3731693765509461125e+04,
+                 a4 = 4.5921953931549871457e+04, a5 = 6.7265770927008700853e+04,
+                 a6 = 3.3430575583588128105e+04, a7 = 2.5090809287301226727e+03;
+    const double b1 = 4.2313330701600911252e+01, b2 = 6.8718700749205790830e+02,
+                 b3 = 5.3941960214247511077e+03, b4 = 2.1213794301586595867e+04,
+                 b5 = 3.9307895800092710610e+04, b6 = 2.8729085735721942674e+04,
+                 b7 = 5.2264952788528545610e+03;
+    const double c0 = 1.42343711074968357734e+00, c1 = 4.63033784615654529590e+00,
+                 c2 = 5.76949722146069140550e+00, c3 = 3.64784832476320460504e+00,
+                 c4 = 1.27045825245236838258e+00, c5 = 2.41780725177450611770e-01,
+                 c6 = 2.27238449892691845833e-02, c7 = 7.74545014278341407640e-04;
+    const double d1 = 2.05319162663775882187e+00, d2 = 1.67638483018380384940e+00,
+                 d3 = 6.89767334985100004550e-01, d4 = 1.48103976427480074590e-01,
+                 d5 = 1.51986665636164571966e-02, d6 = 5.47593808499534494600e-04,
+                 d7 = 1.05075007164441684324e-09;
+    const double e0 = 6.65790464350110377720e+00, e1 = 5.46378491116411436990e+00,
+                 e2 = 1.78482653991729133580e+00, e3 = 2.96560571828504891230e-01,
+                 e4 = 2.65321895265761230930e-02, e5 = 1.24266094738807843860e-03,
+                 e6 = 2.71155556874348757815e-05, e7 = 2.01033439929228813265e-07;
+    const double f1 = 5.99832206555887937690e-01, f2 = 1.36929880922735805310e-01,
+                 f3 = 1.48753612908506148525e-02, f4 = 7.86869131145613259100e-04,
+                 f5 = 1.84631831751005468180e-05, f6 = 1.42151175831644588870e-07,
+                 f7 = 2.04426310338993978564e-15;
+
+    for (size_t start=0; start<n; start+=INV_CDF_BLOCK) {
+        size_t end = n < start + INV_CDF_BLOCK ? n : start + INV_CDF_BLOCK;
+
+        for (size_t i=start; i<end; i++) {
+            double q = u[i] - 0.5;
+            double r = 0.180625 - q*q;
+            z[i] = q*(((((((a7*r + a6)*r + a5)*r + a4)*r + a3)*r + a2)*r + a1)*r + a0) /
+                     (((((((b7*r + b6)*r + b5)*r + b4)*r + b3)*r + b2)*r + b1)*r + 1.0);
+        }
+
+        for (size_t i=start; i<end; i++) {
+            double q = u[i] - 0.5;
+            if (fabs(q) > 0.425) {
+                double r = sqrt(-kernel_log(simd_min(u[i], 1.0 - u[i])));
+                double x;
+                if (r <= 5.0) {
+                    r -= 1.6;
+                    x = (((((((c7*r + c6)*r + c5)*r + c4)*r + c3)*r + c2)*r + c1)*r + c0) /
+                        (((((((d7*r + d6)*r + d5)*r + d4)*r + d3)*r + d2)*r + d1)*r + 1.0);
+                } else {
+                    // Only reached for u within ~1e-11 of 0 or 1
+                    r -= 5.0;
+                    x = (((((((e7*r + e6)*r + e5)*r + e4)*r + e3)*r + e2)*r + e1)*r + e0) /
+                        (((((((f7*r + f6)*r + f5)*r + f4)*r + f3)*r + f2)*r + f1)*r + 1.0);
+                }
+                z[i] = copysign(x, q);
+            }
+        }
+    }
+}
+
+template<typename Real>
+static void gbm_step_kernel(const Real* S_in, const Real* z, Real* S_out, size_t n,
+                            Real drift, Real vol) {
+    for (size_t i=0; i<n; i++) S_out[i] = S_in[i] * drift * kernel_exp(vol * z[i]);
+}
+
+static void box_muller_kernel(const double* u, double* z, size_t n) {
+    for (size_t i=0; i<n/2; i++) {
+        double radius = sqrt(-2.0 * kernel_log(u[2*i]));
+        double s, c;
+        kernel_sincos_2pi(u[2*i+1], &s, &c);
+        z[2*i] = radius * s;
+        z[2*i+1] = radius * c;
+    }
+}
+
+#define SIMD_KERNELS_TABLE(isa) { \
+    isa, &black_scholes_prices_kernel<double>, &normal_cdf_kernel<double>, &inv_cdf_acklam_kernel, \
+    &inv_cdf_as241_kernel, &gbm_step_kernel<double>, &box_muller_kernel, \
+    &black_scholes_prices_kernel<float>, &normal_cdf_kernel<float>, &gbm_step_kernel<float> }
+
+#endif
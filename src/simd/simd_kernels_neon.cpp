@@ -0,0 +1,17 @@
+#ifndef __SIMD_KERNELS_NEON_CPP
+#define __SIMD_KERNELS_NEON_CPP
+
+// AArch64 variant. Advanced SIMD is part of the baseline there, so no extra
+// flags are needed; what differs from the scalar variant is the inline maths,
+// which lets the loops vectorise
+#include "simd_kernels.h"
+
+#if defined(__aarch64__)
+#include "simd_kernels_impl.h"
+const SimdKernels SIMD_KERNELS_NEON = SIMD_KERNELS_TABLE(SIMD_NEON);
+#else
+const SimdKernels SIMD_KERNELS_NEON = { SIMD_NEON, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                        nullptr, nullptr, nullptr };
+#endif
+
+#endif
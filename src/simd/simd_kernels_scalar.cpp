@@ -0,0 +1,12 @@
+#ifndef __SIMD_KERNELS_SCALAR_CPP
+#define __SIMD_KERNELS_SCALAR_CPP
+
+// Baseline variant, built with the default flags and calling libm. It is the
+// reference the other variants are checked against
+#include "simd_kernels.h"
+#define SIMD_KERNELS_LIBM
+#include "simd_kernels_impl.h"
+
+const SimdKernels SIMD_KERNELS_SCALAR = SIMD_KERNELS_TABLE(SIMD_SCALAR);
+
+#endif
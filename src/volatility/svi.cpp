@@ -0,0 +1,196 @@
+#ifndef __SVI_CPP
+#define __SVI_CPP
+
+#include "svi.h"
+#include "../math/optimisation/levenberg_marquardt.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <thread>
+
+double svi_total_variance(const SviParams& p, double k) {
+    double x = k - p.m;
+    return p.a + p.b * (p.rho * x + sqrt(x * x + p.sigma * p.sigma));
+}
+
+double svi_butterfly_density(const SviParams& p, double k) {
+    double x = k - p.m;
+    double R = sqrt(x * x + p.sigma * p.sigma);
+    double w = p.a + p.b * (p.rho * x + R);
+    double w_1 = p.b * (p.rho + x / R);
+    double w_2 = p.b * p.sigma * p.sigma / (R * R * R);
+    double h = 1.0 - k * w_1 / (2.0 * w);
+    return h * h - 0.25 * w_1 * w_1 * (1.0 / w + 0.25) + 0.5 * w_2;
+}
+
+// Least-squares model of one expiry's total variance for levenberg_marquardt
+class SviSliceModel {
+private:
+    const std::vector<double>& k;
+    const std::vector<double>& w;
+
+public:
+    SviSliceModel(const std::vector<double>& _k, const std::vector<double>& _w) : k(_k), w(_w) {}
+
+    size_t num_residuals() const { return k.size(); }
+
+    // Residuals w_svi(k_i) - w_i and the analytic Jacobian wrt (a, b, rho, m, sigma)
+    void residuals(const double* p, double* r, double* J) const {
+        double a = p[0], b = p[1], rho = p[2], m = p[3], sigma = p[4];
+        for (size_t i=0; i<k.size(); i++) {
+            double x = k[i] - m;
+            double R = sqrt(x * x + sigma * sigma);
+            r[i] = a + b * (rho * x + R) - w[i];
+            if (J) {
+                double* row = J + 5 * i;
+                row[0] = 1.0;
+                row[1] = rho * x + R;
+                row[2] = b * x;
+                row[3] = -b * (rho + x / R);
+                row[4] = b * sigma / R;
+            }
+        }
+    }
+
+    // Keep the slice well defined and free of the simplest arbitrages:
+    // b >= 0, |rho| < 1, sigma > 0, non-negative minimum variance and the
+    // Rogers-Tehranchi bound on the wing slopes, b * (1 + |rho|) <= 4. Lee's
+    // moment formula would cap the wings at 2; that is not imposed
+    void project(double* p) const {
+        p[1] = std::max(p[1], 0.0);
+        p[2] = std::min(std::max(p[2], -0.999), 0.999);
+        p[4] = std::max(p[4], 1e-4);
+        p[1] = std::min(p[1], 4.0 / (1.0 + fabs(p[2])));
+        p[0] = std::max(p[0], -p[1] * p[4] * sqrt(1.0 - p[2] * p[2]));
+    }
+};
+
+// Heuristic starting point when there is no previous calibration
+static SviParams svi_initial_guess(const std::vector<double>& k, const std::vector<double>& w) {
+    size_t i_min = std::min_element(w.begin(), w.end()) - w.begin();
+    SviParams p;
+    p.m = k[i_min];
+    p.rho = 0.0;
+    p.sigma = 0.1;
+
+    // Average wing slope from the minimum out to each end of the strike range
+    double slope = 0.0;
+    int sides = 0;
+    if (k.front() < p.m) {
+        slope += (w.front() - w[i_min]) / (p.m - k.front());
+        sides++;
+    }
+    if (k.back() > p.m) {
+        slope += (w.back() - w[i_min]) / (k.back() - p.m);
+        sides++;
+    }
+    p.b = std::max(sides ? slope / sides : 0.0, 1e-3);
+    p.a = w[i_min] - p.b * p.sigma;
+    return p;
+}
+
+void svi_fit_slice(const OptionChain& chain, size_t e, const SviSlice* previous,
+                   const SviFitOptions& options, SviSlice& slice) {
+    slice.expiry_date = chain.expiry_date(e);
+    slice.T = chain.days_to_expiry(e) / 365.0;
+    slice.forward = chain.spot_price() / chain.discount_factor(e);
+    slice.rmse_vol = 0.0;
+    slice.min_density = 0.0;
+    slice.num_points = 0;
+    slice.iterations = 0;
+    slice.converged = false;
+    slice.warm_started = false;
+    slice.params = SviParams();
+    if (slice.T <= 0.0) return;
+
+    // Out-of-the-money quotes only: puts below the forward, calls above
+    std::vector<std::pair<double, double> > points;
+    for (size_t row=chain.begin(e, CHAIN_PUTS); row<chain.end(e, CHAIN_PUTS); row++) {
+        if (chain.strike(row) < slice.forward) points.push_back(std::make_pair(chain.strike(row), chain.implied_vol(row)));
+    }
+    for (size_t row=chain.begin(e, CHAIN_CALLS); row<chain.end(e, CHAIN_CALLS); row++) {
+        if (chain.strike(row) >= slice.forward) points.push_back(std::make_pair(chain.strike(row), chain.implied_vol(row)));
+    }
+    std::sort(points.begin(), points.end());
+
+    std::vector<double> k, w;
+    for (const auto& pt : points) {
+        if (!(pt.second > 0.0) || !std::isfinite(pt.second)) continue;
+        k.push_back(log(pt.first / slice.forward));
+        w.push_back(pt.second * pt.second * slice.T);
+    }
+    slice.num_points = static_cast<int>(k.size());
+    if (k.size() < 5) return; // Too few quotes to pin down five parameters
+
+    slice.warm_started = previous != nullptr;
+    SviParams guess = previous ? previous->params : svi_initial_guess(k, w);
+    double p[5] = {guess.a, guess.b, guess.rho, guess.m, guess.sigma};
+
+    SviSliceModel model(k, w);
+    LevenbergMarquardtResult fit = levenberg_marquardt<5>(model, p, options.max_iter, options.tolerance);
+
+    slice.params.a = p[0];
+    slice.params.b = p[1];
+    slice.params.rho = p[2];
+    slice.params.m = p[3];
+    slice.params.sigma = p[4];
+    slice.iterations = fit.iterations;
+    slice.converged = fit.converged;
+
+    double sq_err = 0.0;
+    slice.min_density = svi_butterfly_density(slice.params, k[0]);
+    for (size_t i=0; i<k.size(); i++) {
+        double vol_model = sqrt(std::max(svi_total_variance(slice.params, k[i]), 0.0) / slice.T);
+        double vol_market = sqrt(w[i] / slice.T);
+        sq_err += (vol_model - vol_market) * (vol_model - vol_market);
+        slice.min_density = std::min(slice.min_density, svi_butterfly_density(slice.params, k[i]));
+    }
+    slice.rmse_vol = sqrt(sq_err / k.size());
+}
+
+// ==========
+// SviSurface
+// ==========
+
+SviSurface::SviSurface() {}
+
+void SviSurface::calibrate(const OptionChain& chain, const SviFitOptions& options) {
+    // Previous parameters, keyed by expiry, for warm starts
+    std::map<std::string, SviSlice> previous;
+    for (const auto& s : slices) {
+        if (s.num_points >= 5) previous[s.expiry_date] = s;
+    }
+
+    size_t num_expiries = chain.num_expiries();
+    std::vector<SviSlice> fitted(num_expiries);
+
+    // Expiries are independent, so threads pull them off a shared counter
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t e = next++; e < num_expiries; e = next++) {
+            auto it = previous.find(chain.expiry_date(e));
+            const SviSlice* prev = (it != previous.end()) ? &it->second : nullptr;
+            svi_fit_slice(chain, e, prev, options, fitted[e]);
+        }
+    };
+
+    unsigned num_threads = options.num_threads ? options.num_threads : std::thread::hardware_concurrency();
+    num_threads = std::max(1u, std::min<unsigned>(num_threads, static_cast<unsigned>(num_expiries)));
+    std::vector<std::thread> threads;
+    for (unsigned i=1; i<num_threads; i++) threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads) t.join();
+
+    slices.swap(fitted);
+}
+
+double SviSurface::implied_vol(size_t i, double K) const {
+    const SviSlice& s = slices[i];
+    if (!(s.T > 0.0)) return std::numeric_limits<double>::quiet_NaN();
+    double w = svi_total_variance(s.params, log(K / s.forward));
+    return sqrt(std::max(w, 0.0) / s.T);
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef __SVI_H
+#define __SVI_H
+
+#include <string>
+#include <vector>
+#include "../market_data/option_chain.h"
+
+// Gatheral's raw SVI parametrisation of one expiry's total implied variance
+//   w(k) = a + b * (rho * (k - m) + sqrt((k - m)^2 + sigma^2))
+// as a function of log-moneyness k = log(K / F)
+struct SviParams {
+    double a;
+    double b;
+    double rho;
+    double m;
+    double sigma;
+};
+
+double svi_total_variance(const SviParams& p, double k);
+
+// Gatheral-Jacquier density function g(k). The slice is free of butterfly
+// arbitrage where g(k) >= 0
+double svi_butterfly_density(const SviParams& p, double k);
+
+struct SviSlice {
+    std::string expiry_date;
+    double T;
+    double forward;
+    SviParams params;
+    double rmse_vol;        // Root mean square implied vol error of the fit
+    double min_density;     // Smallest g(k) over the fitted strikes
+    int num_points;
+    int iterations;
+    bool converged;
+    bool warm_started;
+};
+
+struct SviFitOptions {
+    unsigned num_threads;   // 0 means one per hardware thread
+    int max_iter;
+    double tolerance;       // Relative cost improvement at which LM stops
+
+    SviFitOptions() : num_threads(0), max_iter(100), tolerance(1e-5) {}
+};
+
+// Fits expiry e of the chain (see SviSurface::calibrate), starting from the
+// parameters of previous if it is given
+void svi_fit_slice(const OptionChain& chain, size_t e, const SviSlice* previous,
+                   const SviFitOptions& options, SviSlice& slice);
+
+// A volatility surface made of independently calibrated raw SVI slices,
+// one per expiry of an OptionChain
+class SviSurface {
+private:
+    std::vector<SviSlice> slices;
+
+public:
+    SviSurface();
+
+    // Fits every expiry of the chain to its out-of-the-money implied vols by
+    // Levenberg-Marquardt with analytic gradients, spreading expiries over
+    // threads. Expiries that were present in the previous calibration start
+    // from their previous parameters, which normally cuts the iteration
+    // count sharply from one snapshot to the next
+    void calibrate(const OptionChain& chain, const SviFitOptions& options = SviFitOptions());
+
+    // Slices fitted elsewhere, e.g. one by one with svi_fit_slice
+    void set_slices(const std::vector<SviSlice>& _slices) { slices = _slices; }
+
+    size_t num_slices() const { return slices.size(); }
+    const SviSlice& slice(size_t i) const { return slices[i]; }
+
+    // Model implied vol of slice i at strike K; NaN for an expired slice
+    double implied_vol(size_t i, double K) const;
+};
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef __VOL_SURFACE_CPP
+#define __VOL_SURFACE_CPP
+
+#include "vol_surface.h"
+#include <algorithm>
+#include <cmath>
+
+// Fritsch-Carlson monotone cubic through (x_i, y_i), evaluated at the points
+// xs (which must be increasing). Flat outside [x_0, x_n-1]
+static void monotone_cubic_resample(const std::vector<double>& x, const std::vector<double>& y,
+                                    const std::vector<double>& xs, std::vector<double>& ys) {
+    size_t n = x.size();
+    ys.resize(xs.size());
+    if (n == 1) {
+        std::fill(ys.begin(), ys.end(), y[0]);
+        return;
+    }
+
+    // Secant slopes, then tangents limited so that no interval overshoots
+    std::vector<double> delta(n - 1), m(n);
+    for (size_t i=0; i+1<n; i++) delta[i] = (y[i+1] - y[i]) / (x[i+1] - x[i]);
+    m[0] = delta[0];
+    m[n-1] = delta[n-2];
+    for (size_t i=1; i+1<n; i++) {
+        m[i] = (delta[i-1] * delta[i] <= 0.0) ? 0.0 : 0.5 * (delta[i-1] + delta[i]);
+    }
+    for (size_t i=0; i+1<n; i++) {
+        if (delta[i] == 0.0) {
+            m[i] = 0.0;
+            m[i+1] = 0.0;
+            continue;
+        }
+        double alpha = m[i] / delta[i];
+        double beta = m[i+1] / delta[i];
+        double s = alpha * alpha + beta * beta;
+        if (s > 9.0) {
+            double tau = 3.0 / sqrt(s);
+            m[i] = tau * alpha * delta[i];
+            m[i+1] = tau * beta * delta[i];
+        }
+    }
+
+    size_t i = 0;
+    for (size_t j=0; j<xs.size(); j++) {
+        double xv = xs[j];
+        if (xv <= x[0]) {
+            ys[j] = y[0];
+            continue;
+        }
+        if (xv >= x[n-1]) {
+            ys[j] = y[n-1];
+            continue;
+        }
+        while (x[i+1] < xv) i++;
+        double h = x[i+1] - x[i];
+        double t = (xv - x[i]) / h;
+        double t2 = t * t;
+        double t3 = t2 * t;
+        ys[j] = (2*t3 - 3*t2 + 1) * y[i] + (t3 - 2*t2 + t) * h * m[i]
+              + (-2*t3 + 3*t2) * y[i+1] + (t3 - t2) * h * m[i+1];
+    }
+}
+
+VolSurface::VolSurface() : spot(0.0), k_min(0.0), dk(1.0), num_k(0) {}
+
+// Resample a slice onto the grid and store its per-interval cubic
+// coefficients in local coordinate t in [0,1]: w = c0 + t*(c1 + t*(c2 + t*c3))
+void VolSurface::add_slice(double T, const std::vector<double>& k_nodes, const std::vector<double>& w_nodes) {
+    std::vector<double> grid(num_k), w_grid;
+    for (size_t j=0; j<num_k; j++) grid[j] = k_min + j * dk;
+    monotone_cubic_resample(k_nodes, w_nodes, grid, w_grid);
+
+    // Harmonic-mean (Fritsch-Butland) tangents keep the grid cubic monotone
+    // wherever the resampled data is, without a separate limiter pass
+    std::vector<double> tangents(num_k);
+    std::vector<double> delta(num_k - 1);
+    for (size_t j=0; j+1<num_k; j++) delta[j] = w_grid[j+1] - w_grid[j];
+    tangents[0] = delta[0];
+    tangents[num_k-1] = delta[num_k-2];
+    for (size_t j=1; j+1<num_k; j++) {
+        tangents[j] = (delta[j-1] * delta[j] <= 0.0) ? 0.0 : 2.0 * delta[j-1] * delta[j] / (delta[j-1] + delta[j]);
+    }
+
+    expiries.push_back(T);
+    for (size_t j=0; j+1<num_k; j++) {
+        double y_0 = w_grid[j];
+        double y_1 = w_grid[j+1];
+        double m_0 = tangents[j];
+        double m_1 = tangents[j+1];
+        coeffs.push_back(y_0);
+        coeffs.push_back(m_0);
+        coeffs.push_back(3.0 * (y_1 - y_0) - 2.0 * m_0 - m_1);
+        coeffs.push_back(2.0 * (y_0 - y_1) + m_0 + m_1);
+    }
+}
+
+void VolSurface::build(const SviSurface& svi, double S, const YieldCurve& _curve,
+                       double _k_min, double _k_max, size_t _num_k) {
+    spot = S;
+    curve = _curve;
+    k_min = _k_min;
+    num_k = std::max<size_t>(_num_k, 2);
+    dk = (_k_max - _k_min) / (num_k - 1);
+    expiries.clear();
+    coeffs.clear();
+
+    std::vector<double> k(num_k), w(num_k);
+    for (size_t j=0; j<num_k; j++) k[j] = k_min + j * dk;
+
+    for (size_t i=0; i<svi.num_slices(); i++) {
+        const SviSlice& s = svi.slice(i);
+        if (s.num_points < 5 || s.T <= 0.0) continue;
+        for (size_t j=0; j<num_k; j++) w[j] = std::max(svi_total_variance(s.params, k[j]), 0.0);
+        add_slice(s.T, k, w);
+    }
+}
+
+void VolSurface::build(const OptionChain& chain, double _k_min, double _k_max, size_t _num_k) {
+    spot = chain.spot_price();
+    curve = chain.yield_curve();
+    k_min = _k_min;
+    num_k = std::max<size_t>(_num_k, 2);
+    dk = (_k_max - _k_min) / (num_k - 1);
+    expiries.clear();
+    coeffs.clear();
+
+    for (size_t e=0; e<chain.num_expiries(); e++) {
+        double T = chain.days_to_expiry(e) / 365.0;
+        if (T <= 0.0) continue;
+        double F = spot / chain.discount_factor(e);
+
+        // Out-of-the-money quotes: puts below the forward, calls above.
+        // Both segments are strike-sorted, so k comes out increasing
+        std::vector<double> k, w;
+        for (size_t row=chain.begin(e, CHAIN_PUTS); row<chain.end(e, CHAIN_PUTS); row++) {
+            double iv = chain.implied_vol(row);
+            if (chain.strike(row) < F && iv > 0.0 && std::isfinite(iv)) {
+                k.push_back(log(chain.strike(row) / F));
+                w.push_back(iv * iv * T);
+            }
+        }
+        for (size_t row=chain.begin(e, CHAIN_CALLS); row<chain.end(e, CHAIN_CALLS); row++) {
+            double iv = chain.implied_vol(row);
+            if (chain.strike(row) >= F && iv > 0.0 && std::isfinite(iv)) {
+                k.push_back(log(chain.strike(row) / F));
+                w.push_back(iv * iv * T);
+            }
+        }
+        if (!k.empty()) add_slice(T, k, w);
+    }
+}
+
+double VolSurface::forward(double T) const {
+    return spot / curve.discount(T);
+}
+
+// Find the slices bracketing T. The result is
+//   w(k, T) = scale * ((1 - weight_1) * w_e0(k) + weight_1 * w_e1(k))
+// where scale is only different from one when extrapolating in T at
+// constant implied vol
+void VolSurface::locate_time(double T, size_t& e_0, size_t& e_1, double& weight_1, double& scale) const {
+    size_t n = expiries.size();
+    scale = 1.0;
+    weight_1 = 0.0;
+    if (T <= expiries[0]) {
+        e_0 = e_1 = 0;
+        scale = std::max(T, 0.0) / expiries[0];
+        return;
+    }
+    if (T >= expiries[n-1]) {
+        e_0 = e_1 = n - 1;
+        scale = T / expiries[n-1];
+        return;
+    }
+    e_1 = std::upper_bound(expiries.begin(), expiries.end(), T) - expiries.begin();
+    e_0 = e_1 - 1;
+    weight_1 = (T - expiries[e_0]) / (expiries[e_1] - expiries[e_0]);
+}
+
+double VolSurface::slice_variance(size_t e, double k) const {
+    double x = std::min(std::max((k - k_min) / dk, 0.0), static_cast<double>(num_k - 1));
+    size_t j = std::min(static_cast<size_t>(x), num_k - 2);
+    double t = x - j;
+    const double* c = &coeffs[(e * (num_k - 1) + j) * 4];
+    return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+}
+
+double VolSurface::total_variance(double k, double T) const {
+    if (expiries.empty()) return 0.0;
+    size_t e_0, e_1;
+    double weight_1, scale;
+    locate_time(T, e_0, e_1, weight_1, scale);
+    double w = slice_variance(e_0, k);
+    if (weight_1 > 0.0) w += weight_1 * (slice_variance(e_1, k) - w);
+    return scale * w;
+}
+
+double VolSurface::vol_moneyness(double k, double T) const {
+    if (expiries.empty()) return 0.0;
+    // Vol is flat in T before the first expiry, so T <= 0 takes the first
+    // node's vol rather than 0 / 0
+    if (!(T > 0.0)) T = expiries[0];
+    return sqrt(std::max(total_variance(k, T), 0.0) / T);
+}
+
+double VolSurface::vol(double K, double T) const {
+    return vol_moneyness(log(K / spot) + curve.log_discount(T), T);
+}
+
+void VolSurface::vols(const double* K, const double* T, double* out, size_t n) const {
+    for (size_t i=0; i<n; i++) {
+        out[i] = vol(K[i], T[i]);
+    }
+}
+
+void VolSurface::vols(const double* K, double T, double* out, size_t n) const {
+    if (expiries.empty()) {
+        std::fill(out, out + n, 0.0);
+        return;
+    }
+
+    // As in vol(), moneyness uses the forward to T, and T <= 0 then takes
+    // the first expiry's vols
+    double log_F = log(spot) - curve.log_discount(T);
+    if (!(T > 0.0)) T = expiries[0];
+    size_t e_0, e_1;
+    double weight_1, scale;
+    locate_time(T, e_0, e_1, weight_1, scale);
+
+    // Everything that depends only on T is hoisted out of the loop, leaving
+    // a branch-free body the compiler can vectorise
+    const double* c_0 = &coeffs[e_0 * (num_k - 1) * 4];
+    const double* c_1 = &coeffs[e_1 * (num_k - 1) * 4];
+    double inv_dk = 1.0 / dk;
+    double x_max = static_cast<double>(num_k - 1);
+    double j_max = static_cast<double>(num_k - 2);
+    double w_0 = scale * (1.0 - weight_1) / T;
+    double w_1 = scale * weight_1 / T;
+
+    for (size_t i=0; i<n; i++) {
+        double x = (log(K[i]) - log_F - k_min) * inv_dk;
+        x = std::min(std::max(x, 0.0), x_max);
+        double jf = std::min(floor(x), j_max);
+        double t = x - jf;
+        size_t idx = static_cast<size_t>(jf) * 4;
+        double v_0 = c_0[idx] + t * (c_0[idx+1] + t * (c_0[idx+2] + t * c_0[idx+3]));
+        double v_1 = c_1[idx] + t * (c_1[idx+1] + t * (c_1[idx+2] + t * c_1[idx+3]));
+        out[i] = sqrt(std::max(w_0 * v_0 + w_1 * v_1, 0.0));
+    }
+}
+
+#endif
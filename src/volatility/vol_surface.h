@@ -0,0 +1,65 @@
+#ifndef __VOL_SURFACE_H
+#define __VOL_SURFACE_H
+
+#include <cstddef>
+#include <vector>
+#include "svi.h"
+#include "../market_data/option_chain.h"
+#include "../market_data/yield_curve.h"
+
+// Implied volatility surface for pricers to query by (strike, expiry) or
+// (log-moneyness k = log(K/F), expiry).
+//
+// Every expiry slice is held as total variance w(k) = sigma^2 * T on a
+// uniform log-moneyness grid shared by all slices, with the coefficients of
+// a shape-preserving monotone cubic precomputed on each grid interval. A
+// lookup is then an index computation plus a cubic per neighbouring slice,
+// with no search in the strike direction. Between expiries total variance is
+// interpolated linearly in T at fixed k; outside the grid, before the first
+// expiry (including T <= 0) and beyond the last the surface extrapolates
+// flat in k and in implied vol.
+class VolSurface {
+private:
+    double spot;
+    YieldCurve curve;
+    double k_min;
+    double dk;
+    size_t num_k;
+    std::vector<double> expiries;  // Times to expiry, increasing
+    std::vector<double> coeffs;    // [expiry][interval][4] cubic coefficients
+
+    void add_slice(double T, const std::vector<double>& k_nodes, const std::vector<double>& w_nodes);
+    void locate_time(double T, size_t& e_0, size_t& e_1, double& weight_1, double& scale) const;
+    double slice_variance(size_t e, double k) const;
+
+public:
+    VolSurface();
+
+    // Build from calibrated SVI slices. Slices that failed to calibrate are skipped
+    void build(const SviSurface& svi, double S, const YieldCurve& _curve,
+               double _k_min = -1.5, double _k_max = 1.5, size_t _num_k = 301);
+
+    // Build directly from the out-of-the-money market implied vols of a
+    // chain, discounting with the chain's curve
+    void build(const OptionChain& chain,
+               double _k_min = -1.5, double _k_max = 1.5, size_t _num_k = 301);
+
+    size_t num_expiries() const { return expiries.size(); }
+    double forward(double T) const;
+
+    // Single lookups
+    double total_variance(double k, double T) const;
+    double vol_moneyness(double k, double T) const;
+    double vol(double K, double T) const;
+
+    // Batch lookups over structure-of-arrays inputs: out[i] = vol(K[i], T[i]).
+    // Not vectorised: each pair locates its own expiries, so this is a plain
+    // loop over vol(). Group lookups by expiry and use the overload below
+    void vols(const double* K, const double* T, double* out, size_t n) const;
+
+    // Batch lookups sharing one expiry, e.g. a whole chain slice or one step
+    // of a Monte Carlo grid. The time interpolation is resolved once
+    void vols(const double* K, double T, double* out, size_t n) const;
+};
+
+#endif